@@ -0,0 +1,496 @@
+#pragma once
+
+// steps many ai vs ai matches (see Game_setup_match) at once,
+// every lane gives bit identical results to Game_step_match
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BATCH_HAS_SIMD
+#define BATCH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// lane counts are rounded up to this so every kernel can work on full vectors
+#define GAME_BATCH_WIDTH (16)
+
+typedef enum GameBatchIsa
+{
+    GAME_BATCH_ISA_SCALAR,
+    GAME_BATCH_ISA_AVX2,
+    GAME_BATCH_ISA_AVX512,
+} GameBatchIsa;
+
+typedef struct GameBatch
+{
+    size_t count;
+
+    float *restrict ball_x;
+    float *restrict ball_y;
+    float *restrict velocity_x;
+    float *restrict velocity_y;
+    float *restrict player1_y;
+    float *restrict player2_y;
+    int unsigned *restrict player1_score;
+    int unsigned *restrict player2_score;
+    int *restrict player_mode;
+
+    // shared by every lane
+    float aspect_ratio;
+    float player1_x;
+    float player1_ai_gain;
+    float player2_ai_gain;
+} GameBatch;
+
+#define GAME_BATCH_ARRAY_COUNT (9)
+
+static inline size_t GameBatch_padded_count(size_t const count)
+{
+    return (count + GAME_BATCH_WIDTH - 1) / GAME_BATCH_WIDTH * GAME_BATCH_WIDTH;
+}
+
+// memory passed to GameBatch_init must be this big and aligned to 64 bytes
+static inline size_t GameBatch_memory_size(size_t const count)
+{
+    return GameBatch_padded_count(count) * GAME_BATCH_ARRAY_COUNT * sizeof(float);
+}
+
+static void GameBatch_init(GameBatch *const this, size_t const count,
+                           float const aspect_ratio, void *const memory)
+{
+    size_t const padded_count = GameBatch_padded_count(count);
+    float *const arrays = memory;
+
+    this->count = padded_count;
+    this->ball_x = arrays + padded_count * 0;
+    this->ball_y = arrays + padded_count * 1;
+    this->velocity_x = arrays + padded_count * 2;
+    this->velocity_y = arrays + padded_count * 3;
+    this->player1_y = arrays + padded_count * 4;
+    this->player2_y = arrays + padded_count * 5;
+    this->player1_score = (int unsigned *) (arrays + padded_count * 6);
+    this->player2_score = (int unsigned *) (arrays + padded_count * 7);
+    this->player_mode = (int *) (arrays + padded_count * 8);
+
+    this->aspect_ratio = aspect_ratio;
+    this->player1_x = 0.1f;
+    this->player1_ai_gain = AI_GAIN;
+    this->player2_ai_gain = AI_GAIN;
+
+    // fill every lane (including the padding) with a valid match
+    Game game;
+    Game_setup_match(&game, 1, aspect_ratio);
+    for (size_t i = 0; i < padded_count; ++i)
+    {
+        this->ball_x[i] = game.ball_position.x;
+        this->ball_y[i] = game.ball_position.y;
+        this->velocity_x[i] = game.ball_velocity.x;
+        this->velocity_y[i] = game.ball_velocity.y;
+        this->player1_y[i] = game.player1.pos.y;
+        this->player2_y[i] = game.player2.pos.y;
+        this->player1_score[i] = game.player1.score;
+        this->player2_score[i] = game.player2.score;
+        this->player_mode[i] = (int) game.player_mode;
+    }
+}
+
+// the match must have been set up with Game_setup_match and the same aspect ratio and ai gains
+static void GameBatch_set(GameBatch *const this, size_t const index, Game const *const game)
+{
+    this->ball_x[index] = game->ball_position.x;
+    this->ball_y[index] = game->ball_position.y;
+    this->velocity_x[index] = game->ball_velocity.x;
+    this->velocity_y[index] = game->ball_velocity.y;
+    this->player1_y[index] = game->player1.pos.y;
+    this->player2_y[index] = game->player2.pos.y;
+    this->player1_score[index] = game->player1.score;
+    this->player2_score[index] = game->player2.score;
+    this->player_mode[index] = (int) game->player_mode;
+}
+
+static void GameBatch_get(GameBatch const *const this, size_t const index, Game *const game)
+{
+    game->ball_position = (float2) {this->ball_x[index], this->ball_y[index]};
+    game->ball_velocity = (float2) {this->velocity_x[index], this->velocity_y[index]};
+    game->player1.pos = (float2) {this->player1_x, this->player1_y[index]};
+    game->player2.pos = (float2) {this->aspect_ratio - this->player1_x, this->player2_y[index]};
+    game->player1.score = this->player1_score[index];
+    game->player2.score = this->player2_score[index];
+    game->player_mode = (PlayerMode) this->player_mode[index];
+    game->aspect_ratio = this->aspect_ratio;
+    game->player1_ai_gain = this->player1_ai_gain;
+    game->player2_ai_gain = this->player2_ai_gain;
+
+    // serves happen in the same step they start in so the game is always running after one step
+    game->game_mode = GAME_MODE_GAME;
+}
+
+// every constant the kernels need, computed with the same float expressions as Game_update
+typedef struct GameBatchConstants
+{
+    float half_width;
+    float player1_x;
+    float player2_x;
+    float player1_face;
+    float player2_face;
+    float serve1_x;
+    float serve2_x;
+    float reach;
+    float half_height;
+    float ai_min;
+    float ai_max;
+    float ai_gain1;
+    float ai_gain2;
+} GameBatchConstants;
+
+static inline GameBatchConstants GameBatch_constants(GameBatch const *const this, float const dt)
+{
+    float const player2_x = this->aspect_ratio - this->player1_x;
+    return (GameBatchConstants) {
+        .half_width = this->aspect_ratio / 2,
+        .player1_x = this->player1_x,
+        .player2_x = player2_x,
+        .player1_face = this->player1_x + PLAYER_SIZE.x / 2,
+        .player2_face = player2_x - PLAYER_SIZE.x / 2,
+        .serve1_x = this->player1_x + PLAYER_SIZE.x,
+        .serve2_x = player2_x - PLAYER_SIZE.x,
+        .reach = PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f,
+        .half_height = PLAYER_SIZE.y / 2.0f,
+        .ai_min = PLAYER_SIZE.y / 2.0f,
+        .ai_max = 1.0f - PLAYER_SIZE.y / 2.0f,
+        .ai_gain1 = this->player1_ai_gain * dt,
+        .ai_gain2 = this->player2_ai_gain * dt,
+    };
+}
+
+static void GameBatch_step_scalar(GameBatch *const this, float const dt, size_t const step_count)
+{
+    Game game;
+    Game_setup_match(&game, 1, this->aspect_ratio);
+
+    for (size_t i = 0; i < this->count; ++i)
+    {
+        GameBatch_get(this, i, &game);
+        for (size_t step = 0; step < step_count; ++step)
+        {
+            Game_step_match(&game, dt);
+        }
+        GameBatch_set(this, i, &game);
+    }
+}
+
+#ifdef BATCH_HAS_SIMD
+
+BATCH_TARGET("avx2")
+static void GameBatch_step_avx2(GameBatch *const this, float const dt, size_t const step_count)
+{
+    GameBatchConstants const c = GameBatch_constants(this, dt);
+
+    __m256 const dt_wide = _mm256_set1_ps(dt);
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const sign_mask = _mm256_set1_ps(-0.0f);
+    __m256 const radius = _mm256_set1_ps(BALL_RADIUS);
+    __m256 const half_width = _mm256_set1_ps(c.half_width);
+    __m256 const aspect_ratio = _mm256_set1_ps(this->aspect_ratio);
+    __m256 const player1_face = _mm256_set1_ps(c.player1_face);
+    __m256 const player2_face = _mm256_set1_ps(c.player2_face);
+    __m256 const serve1_x = _mm256_set1_ps(c.serve1_x);
+    __m256 const serve2_x = _mm256_set1_ps(c.serve2_x);
+    __m256 const reach = _mm256_set1_ps(c.reach);
+    __m256 const half_height = _mm256_set1_ps(c.half_height);
+    __m256 const ai_min = _mm256_set1_ps(c.ai_min);
+    __m256 const ai_max = _mm256_set1_ps(c.ai_max);
+    __m256 const ai_gain1 = _mm256_set1_ps(c.ai_gain1);
+    __m256 const ai_gain2 = _mm256_set1_ps(c.ai_gain2);
+    __m256 const ai_rest = _mm256_set1_ps(0.5f);
+    __m256 const initial_velocity = _mm256_set1_ps(INITIAL_BALL_VELOCITY.x);
+    __m256 const bounce_strength = _mm256_set1_ps(1.75f);
+    __m256 const ball_min = _mm256_set1_ps(BALL_RADIUS);
+    __m256 const ball_max = _mm256_set1_ps(1.0f - BALL_RADIUS);
+    __m256i const mode_player1_serve = _mm256_set1_epi32(PLAYER1_SERVE);
+    __m256i const mode_player2_serve = _mm256_set1_epi32(PLAYER2_SERVE);
+    __m256i const mode_player1_face = _mm256_set1_epi32(PLAYER1_FACE);
+    __m256i const mode_player2_face = _mm256_set1_epi32(PLAYER2_FACE);
+    __m256i const score_one = _mm256_set1_epi32(1);
+
+    for (size_t i = 0; i < this->count; i += 8)
+    {
+        __m256 ball_x = _mm256_load_ps(this->ball_x + i);
+        __m256 ball_y = _mm256_load_ps(this->ball_y + i);
+        __m256 velocity_x = _mm256_load_ps(this->velocity_x + i);
+        __m256 velocity_y = _mm256_load_ps(this->velocity_y + i);
+        __m256 player1_y = _mm256_load_ps(this->player1_y + i);
+        __m256 player2_y = _mm256_load_ps(this->player2_y + i);
+        __m256i player1_score = _mm256_load_si256((__m256i const *) (this->player1_score + i));
+        __m256i player2_score = _mm256_load_si256((__m256i const *) (this->player2_score + i));
+        __m256i mode = _mm256_load_si256((__m256i const *) (this->player_mode + i));
+
+        for (size_t step = 0; step < step_count; ++step)
+        {
+            // player1 ai, see Game_update_ai
+            __m256 incoming = _mm256_and_ps(_mm256_cmp_ps(ball_x, half_width, _CMP_LT_OQ),
+                                            _mm256_cmp_ps(velocity_x, zero, _CMP_LT_OQ));
+            __m256 target = _mm256_blendv_ps(ai_rest, ball_y, incoming);
+            player1_y = _mm256_add_ps(player1_y, _mm256_mul_ps(ai_gain1, _mm256_sub_ps(target, player1_y)));
+            player1_y = _mm256_min_ps(_mm256_max_ps(player1_y, ai_min), ai_max);
+
+            ball_x = _mm256_add_ps(ball_x, _mm256_mul_ps(velocity_x, dt_wide));
+            ball_y = _mm256_add_ps(ball_y, _mm256_mul_ps(velocity_y, dt_wide));
+
+            // player2 ai
+            incoming = _mm256_and_ps(_mm256_cmp_ps(ball_x, half_width, _CMP_GT_OQ),
+                                     _mm256_cmp_ps(velocity_x, zero, _CMP_GT_OQ));
+            target = _mm256_blendv_ps(ai_rest, ball_y, incoming);
+            player2_y = _mm256_add_ps(player2_y, _mm256_mul_ps(ai_gain2, _mm256_sub_ps(target, player2_y)));
+            player2_y = _mm256_min_ps(_mm256_max_ps(player2_y, ai_min), ai_max);
+
+            // the face checks use the mode from before the serves change it
+            __m256 const is_player1_face = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, mode_player1_face));
+            __m256 const is_player2_face = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, mode_player2_face));
+
+            // serves, the ball starts moving in the same step
+            __m256 const is_player1_serve = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, mode_player1_serve));
+            ball_x = _mm256_blendv_ps(ball_x, serve1_x, is_player1_serve);
+            ball_y = _mm256_blendv_ps(ball_y, player1_y, is_player1_serve);
+            velocity_x = _mm256_blendv_ps(velocity_x, initial_velocity, is_player1_serve);
+            velocity_y = _mm256_andnot_ps(is_player1_serve, velocity_y);
+            mode = _mm256_blendv_epi8(mode, mode_player2_face, _mm256_castps_si256(is_player1_serve));
+
+            __m256 const is_player2_serve = _mm256_castsi256_ps(_mm256_cmpeq_epi32(mode, mode_player2_serve));
+            ball_x = _mm256_blendv_ps(ball_x, serve2_x, is_player2_serve);
+            ball_y = _mm256_blendv_ps(ball_y, player2_y, is_player2_serve);
+            velocity_x = _mm256_blendv_ps(velocity_x, _mm256_xor_ps(initial_velocity, sign_mask), is_player2_serve);
+            velocity_y = _mm256_andnot_ps(is_player2_serve, velocity_y);
+            mode = _mm256_blendv_epi8(mode, mode_player1_face, _mm256_castps_si256(is_player2_serve));
+
+            // paddle hits
+            __m256 const offset1 = _mm256_sub_ps(ball_y, player1_y);
+            __m256 const hit1 = _mm256_and_ps(
+                is_player1_face,
+                _mm256_and_ps(_mm256_cmp_ps(_mm256_sub_ps(ball_x, radius), player1_face, _CMP_LE_OQ),
+                              _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, offset1), reach, _CMP_LE_OQ)));
+
+            __m256 const offset2 = _mm256_sub_ps(ball_y, player2_y);
+            __m256 const hit2 = _mm256_and_ps(
+                is_player2_face,
+                _mm256_and_ps(_mm256_cmp_ps(_mm256_add_ps(ball_x, radius), player2_face, _CMP_GE_OQ),
+                              _mm256_cmp_ps(_mm256_andnot_ps(sign_mask, offset2), reach, _CMP_LE_OQ)));
+
+            __m256 const hit = _mm256_or_ps(hit1, hit2);
+            __m256 const percentage = _mm256_div_ps(_mm256_blendv_ps(offset2, offset1, hit1), half_height);
+            velocity_y = _mm256_blendv_ps(velocity_y,
+                                          _mm256_mul_ps(_mm256_mul_ps(initial_velocity, percentage), bounce_strength),
+                                          hit);
+            velocity_x = _mm256_xor_ps(velocity_x, _mm256_and_ps(hit, sign_mask));
+            mode = _mm256_blendv_epi8(mode, mode_player2_face, _mm256_castps_si256(hit1));
+            mode = _mm256_blendv_epi8(mode, mode_player1_face, _mm256_castps_si256(hit2));
+
+            // walls
+            __m256 const wall = _mm256_or_ps(_mm256_cmp_ps(_mm256_sub_ps(ball_y, radius), zero, _CMP_LT_OQ),
+                                             _mm256_cmp_ps(_mm256_add_ps(ball_y, radius), one, _CMP_GE_OQ));
+            velocity_y = _mm256_xor_ps(velocity_y, _mm256_and_ps(wall, sign_mask));
+
+            // goals
+            __m256 const goal2 = _mm256_cmp_ps(_mm256_sub_ps(ball_x, radius), zero, _CMP_LT_OQ);
+            __m256 const goal1 = _mm256_andnot_ps(goal2, _mm256_cmp_ps(_mm256_add_ps(ball_x, radius),
+                                                                       aspect_ratio, _CMP_GE_OQ));
+            player2_score = _mm256_add_epi32(player2_score, _mm256_and_si256(_mm256_castps_si256(goal2), score_one));
+            player1_score = _mm256_add_epi32(player1_score, _mm256_and_si256(_mm256_castps_si256(goal1), score_one));
+            mode = _mm256_blendv_epi8(mode, mode_player2_serve, _mm256_castps_si256(goal2));
+            mode = _mm256_blendv_epi8(mode, mode_player1_serve, _mm256_castps_si256(goal1));
+
+            ball_y = _mm256_min_ps(_mm256_max_ps(ball_y, ball_min), ball_max);
+        }
+
+        _mm256_store_ps(this->ball_x + i, ball_x);
+        _mm256_store_ps(this->ball_y + i, ball_y);
+        _mm256_store_ps(this->velocity_x + i, velocity_x);
+        _mm256_store_ps(this->velocity_y + i, velocity_y);
+        _mm256_store_ps(this->player1_y + i, player1_y);
+        _mm256_store_ps(this->player2_y + i, player2_y);
+        _mm256_store_si256((__m256i *) (this->player1_score + i), player1_score);
+        _mm256_store_si256((__m256i *) (this->player2_score + i), player2_score);
+        _mm256_store_si256((__m256i *) (this->player_mode + i), mode);
+    }
+}
+
+BATCH_TARGET("avx512f")
+static void GameBatch_step_avx512(GameBatch *const this, float const dt, size_t const step_count)
+{
+    GameBatchConstants const c = GameBatch_constants(this, dt);
+
+    __m512 const dt_wide = _mm512_set1_ps(dt);
+    __m512 const zero = _mm512_setzero_ps();
+    __m512 const one = _mm512_set1_ps(1.0f);
+    __m512i const sign_mask = _mm512_set1_epi32((int) 0x80000000u);
+    __m512 const radius = _mm512_set1_ps(BALL_RADIUS);
+    __m512 const half_width = _mm512_set1_ps(c.half_width);
+    __m512 const aspect_ratio = _mm512_set1_ps(this->aspect_ratio);
+    __m512 const player1_face = _mm512_set1_ps(c.player1_face);
+    __m512 const player2_face = _mm512_set1_ps(c.player2_face);
+    __m512 const serve1_x = _mm512_set1_ps(c.serve1_x);
+    __m512 const serve2_x = _mm512_set1_ps(c.serve2_x);
+    __m512 const reach = _mm512_set1_ps(c.reach);
+    __m512 const half_height = _mm512_set1_ps(c.half_height);
+    __m512 const ai_min = _mm512_set1_ps(c.ai_min);
+    __m512 const ai_max = _mm512_set1_ps(c.ai_max);
+    __m512 const ai_gain1 = _mm512_set1_ps(c.ai_gain1);
+    __m512 const ai_gain2 = _mm512_set1_ps(c.ai_gain2);
+    __m512 const ai_rest = _mm512_set1_ps(0.5f);
+    __m512 const initial_velocity = _mm512_set1_ps(INITIAL_BALL_VELOCITY.x);
+    __m512 const bounce_strength = _mm512_set1_ps(1.75f);
+    __m512 const ball_min = _mm512_set1_ps(BALL_RADIUS);
+    __m512 const ball_max = _mm512_set1_ps(1.0f - BALL_RADIUS);
+    __m512i const mode_player1_serve = _mm512_set1_epi32(PLAYER1_SERVE);
+    __m512i const mode_player2_serve = _mm512_set1_epi32(PLAYER2_SERVE);
+    __m512i const mode_player1_face = _mm512_set1_epi32(PLAYER1_FACE);
+    __m512i const mode_player2_face = _mm512_set1_epi32(PLAYER2_FACE);
+    __m512i const score_one = _mm512_set1_epi32(1);
+
+    for (size_t i = 0; i < this->count; i += 16)
+    {
+        __m512 ball_x = _mm512_load_ps(this->ball_x + i);
+        __m512 ball_y = _mm512_load_ps(this->ball_y + i);
+        __m512 velocity_x = _mm512_load_ps(this->velocity_x + i);
+        __m512 velocity_y = _mm512_load_ps(this->velocity_y + i);
+        __m512 player1_y = _mm512_load_ps(this->player1_y + i);
+        __m512 player2_y = _mm512_load_ps(this->player2_y + i);
+        __m512i player1_score = _mm512_load_si512(this->player1_score + i);
+        __m512i player2_score = _mm512_load_si512(this->player2_score + i);
+        __m512i mode = _mm512_load_si512(this->player_mode + i);
+
+        for (size_t step = 0; step < step_count; ++step)
+        {
+            // player1 ai, see Game_update_ai
+            __mmask16 incoming = _mm512_cmp_ps_mask(ball_x, half_width, _CMP_LT_OQ) &
+                                 _mm512_cmp_ps_mask(velocity_x, zero, _CMP_LT_OQ);
+            __m512 target = _mm512_mask_blend_ps(incoming, ai_rest, ball_y);
+            player1_y = _mm512_add_ps(player1_y, _mm512_mul_ps(ai_gain1, _mm512_sub_ps(target, player1_y)));
+            player1_y = _mm512_min_ps(_mm512_max_ps(player1_y, ai_min), ai_max);
+
+            ball_x = _mm512_add_ps(ball_x, _mm512_mul_ps(velocity_x, dt_wide));
+            ball_y = _mm512_add_ps(ball_y, _mm512_mul_ps(velocity_y, dt_wide));
+
+            // player2 ai
+            incoming = _mm512_cmp_ps_mask(ball_x, half_width, _CMP_GT_OQ) &
+                       _mm512_cmp_ps_mask(velocity_x, zero, _CMP_GT_OQ);
+            target = _mm512_mask_blend_ps(incoming, ai_rest, ball_y);
+            player2_y = _mm512_add_ps(player2_y, _mm512_mul_ps(ai_gain2, _mm512_sub_ps(target, player2_y)));
+            player2_y = _mm512_min_ps(_mm512_max_ps(player2_y, ai_min), ai_max);
+
+            // the face checks use the mode from before the serves change it
+            __mmask16 const is_player1_face = _mm512_cmpeq_epi32_mask(mode, mode_player1_face);
+            __mmask16 const is_player2_face = _mm512_cmpeq_epi32_mask(mode, mode_player2_face);
+
+            // serves, the ball starts moving in the same step
+            __mmask16 const is_player1_serve = _mm512_cmpeq_epi32_mask(mode, mode_player1_serve);
+            __mmask16 const is_player2_serve = _mm512_cmpeq_epi32_mask(mode, mode_player2_serve);
+            ball_x = _mm512_mask_blend_ps(is_player1_serve, ball_x, serve1_x);
+            ball_y = _mm512_mask_blend_ps(is_player1_serve, ball_y, player1_y);
+            velocity_x = _mm512_mask_blend_ps(is_player1_serve, velocity_x, initial_velocity);
+            ball_x = _mm512_mask_blend_ps(is_player2_serve, ball_x, serve2_x);
+            ball_y = _mm512_mask_blend_ps(is_player2_serve, ball_y, player2_y);
+            velocity_x = _mm512_mask_blend_ps(is_player2_serve, velocity_x,
+                                              _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(initial_velocity),
+                                                                                   sign_mask)));
+            velocity_y = _mm512_mask_blend_ps(is_player1_serve | is_player2_serve, velocity_y, zero);
+            mode = _mm512_mask_blend_epi32(is_player1_serve, mode, mode_player2_face);
+            mode = _mm512_mask_blend_epi32(is_player2_serve, mode, mode_player1_face);
+
+            // paddle hits
+            __m512 const offset1 = _mm512_sub_ps(ball_y, player1_y);
+            __mmask16 const hit1 = is_player1_face &
+                _mm512_cmp_ps_mask(_mm512_sub_ps(ball_x, radius), player1_face, _CMP_LE_OQ) &
+                _mm512_cmp_ps_mask(_mm512_abs_ps(offset1), reach, _CMP_LE_OQ);
+
+            __m512 const offset2 = _mm512_sub_ps(ball_y, player2_y);
+            __mmask16 const hit2 = is_player2_face &
+                _mm512_cmp_ps_mask(_mm512_add_ps(ball_x, radius), player2_face, _CMP_GE_OQ) &
+                _mm512_cmp_ps_mask(_mm512_abs_ps(offset2), reach, _CMP_LE_OQ);
+
+            __mmask16 const hit = hit1 | hit2;
+            __m512 const percentage = _mm512_div_ps(_mm512_mask_blend_ps(hit1, offset2, offset1), half_height);
+            velocity_y = _mm512_mask_blend_ps(hit, velocity_y,
+                                              _mm512_mul_ps(_mm512_mul_ps(initial_velocity, percentage), bounce_strength));
+            velocity_x = _mm512_castsi512_ps(_mm512_mask_xor_epi32(_mm512_castps_si512(velocity_x), hit,
+                                                                   _mm512_castps_si512(velocity_x), sign_mask));
+            mode = _mm512_mask_blend_epi32(hit1, mode, mode_player2_face);
+            mode = _mm512_mask_blend_epi32(hit2, mode, mode_player1_face);
+
+            // walls
+            __mmask16 const wall = _mm512_cmp_ps_mask(_mm512_sub_ps(ball_y, radius), zero, _CMP_LT_OQ) |
+                                   _mm512_cmp_ps_mask(_mm512_add_ps(ball_y, radius), one, _CMP_GE_OQ);
+            velocity_y = _mm512_castsi512_ps(_mm512_mask_xor_epi32(_mm512_castps_si512(velocity_y), wall,
+                                                                   _mm512_castps_si512(velocity_y), sign_mask));
+
+            // goals
+            __mmask16 const goal2 = _mm512_cmp_ps_mask(_mm512_sub_ps(ball_x, radius), zero, _CMP_LT_OQ);
+            __mmask16 const goal1 = (__mmask16) ~goal2 &
+                _mm512_cmp_ps_mask(_mm512_add_ps(ball_x, radius), aspect_ratio, _CMP_GE_OQ);
+            player2_score = _mm512_mask_add_epi32(player2_score, goal2, player2_score, score_one);
+            player1_score = _mm512_mask_add_epi32(player1_score, goal1, player1_score, score_one);
+            mode = _mm512_mask_blend_epi32(goal2, mode, mode_player2_serve);
+            mode = _mm512_mask_blend_epi32(goal1, mode, mode_player1_serve);
+
+            ball_y = _mm512_min_ps(_mm512_max_ps(ball_y, ball_min), ball_max);
+        }
+
+        _mm512_store_ps(this->ball_x + i, ball_x);
+        _mm512_store_ps(this->ball_y + i, ball_y);
+        _mm512_store_ps(this->velocity_x + i, velocity_x);
+        _mm512_store_ps(this->velocity_y + i, velocity_y);
+        _mm512_store_ps(this->player1_y + i, player1_y);
+        _mm512_store_ps(this->player2_y + i, player2_y);
+        _mm512_store_si512(this->player1_score + i, player1_score);
+        _mm512_store_si512(this->player2_score + i, player2_score);
+        _mm512_store_si512(this->player_mode + i, mode);
+    }
+}
+
+#endif
+
+static inline GameBatchIsa GameBatch_best_isa(void)
+{
+#ifdef BATCH_HAS_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return GAME_BATCH_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return GAME_BATCH_ISA_AVX2;
+#endif
+    return GAME_BATCH_ISA_SCALAR;
+}
+
+static inline char const *GameBatchIsa_name(GameBatchIsa const isa)
+{
+    switch (isa)
+    {
+        case GAME_BATCH_ISA_AVX512: return "avx512";
+        case GAME_BATCH_ISA_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+// advances every lane by step_count steps of dt
+static void GameBatch_step(GameBatch *const this, GameBatchIsa const isa,
+                           float const dt, size_t const step_count)
+{
+    switch (isa)
+    {
+#ifdef BATCH_HAS_SIMD
+        case GAME_BATCH_ISA_AVX512:
+        {
+            GameBatch_step_avx512(this, dt, step_count);
+            break;
+        }
+
+        case GAME_BATCH_ISA_AVX2:
+        {
+            GameBatch_step_avx2(this, dt, step_count);
+            break;
+        }
+#endif
+
+        default:
+        {
+            GameBatch_step_scalar(this, dt, step_count);
+            break;
+        }
+    }
+}
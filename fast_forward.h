@@ -0,0 +1,178 @@
+#pragma once
+
+// event driven stepping for ai vs ai matches (see Game_setup_match).
+// between events the ball moves in a straight line and both paddles lerp towards a target that is
+// either constant or moves linearly with the ball, so whole stretches of ticks can be skipped in
+// closed form. the ticks that contain an event (wall bounce, paddle plane, the ball crossing the
+// middle, the ai target leaving the range a paddle can reach) are run with Game_step_match.
+// the ball lands on exactly the same floats as Game_step_match, the paddles differ by a few ulps
+// per skipped stretch since their lerp is solved in closed form.
+
+#define FAST_FORWARD_NEVER (UINT64_MAX)
+
+// events are never skipped closer than this so rounding cannot move one into a skipped stretch
+#define FAST_FORWARD_MARGIN (2)
+
+// first tick n >= 1 at which position + n * velocity is past threshold,
+// FAST_FORWARD_NEVER if it is moving away from threshold or is already past it
+static inline uint64_t fast_forward_ticks_until(float const position, float const velocity, float const threshold)
+{
+    double const ticks = ((double) threshold - (double) position) / (double) velocity;
+    if (!(ticks >= 0.0) || ticks > 1e18) return FAST_FORWARD_NEVER;
+    return (uint64_t) ticks + 1;
+}
+
+// the float result of adding step to value count times one addition after another.
+// inside one binade every addition rounds step to the same multiple of the ulp, so whole runs of
+// additions collapse into one multiply, only the additions close to a binade edge or that would
+// round a tie are done one at a time
+static float fast_forward_accumulate(float value, float const step, uint64_t count)
+{
+    while (count != 0)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        int const exponent = (int) (bits >> 23 & 0xFF) - 127;
+
+        // only positive normal values far enough from the denormals are collapsed
+        if (value <= 0.0f || exponent < -100)
+        {
+            value += step;
+            --count;
+            continue;
+        }
+
+        uint64_t const ulp_bits = (uint64_t) (exponent - 23 + 1023) << 52;
+        uint64_t const low_bits = (uint64_t) (exponent + 1023) << 52;
+        double ulp;
+        double low;
+        memcpy(&ulp, &ulp_bits, sizeof(ulp));
+        memcpy(&low, &low_bits, sizeof(low));
+        double const high = low * 2.0;
+
+        double const ulps = (double) step / ulp;
+        double const rounded_ulps = (double) (int64_t) (ulps + (ulps < 0.0 ? -0.5 : 0.5));
+        double const delta = rounded_ulps * ulp;
+        bool const is_tie = ulps - (double) (int64_t) ulps == 0.5 || ulps - (double) (int64_t) ulps == -0.5;
+
+        // how many additions stay at least one step and one ulp away from the edges of the binade
+        double const room = delta > 0.0 ? high - (double) value : (double) value - low;
+        double const magnitude = delta > 0.0 ? delta : -delta;
+        double const run = magnitude != 0.0 ? (room - magnitude - ulp) / magnitude : 1e18;
+        uint64_t const run_count = run < 1.0 || is_tie ? 0 : run > (double) count ? count : (uint64_t) run;
+
+        if (run_count == 0)
+        {
+            value += step;
+            --count;
+        }
+        else
+        {
+            value = (float) ((double) value + (double) run_count * delta);
+            count -= run_count;
+        }
+    }
+
+    return value;
+}
+
+static inline double fast_forward_pow(double base, uint64_t exponent)
+{
+    double result = 1.0;
+    while (exponent != 0)
+    {
+        if ((exponent & 1) != 0) result *= base;
+        base *= base;
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// position of a paddle after ticks steps of Game_update_ai with gain,
+// the target at step j is target + j * target_velocity
+static inline float fast_forward_ai(float const position, float const target, float const target_velocity,
+                                    float const gain, uint64_t const ticks)
+{
+    // the error settles at a constant lag behind a linearly moving target
+    double const keep = 1.0 - (double) gain;
+    double const lag = keep * (double) target_velocity / (double) gain;
+    double const decay = fast_forward_pow(keep, ticks);
+    double const result = (double) target + (double) ticks * (double) target_velocity - lag +
+                          ((double) position - (double) target + lag) * decay;
+
+    // while the target does not cross a clamp bound the lerp moves monotonically towards it,
+    // so clamping the end point is the same as clamping every step
+    return fclamp((float) result, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+}
+
+// advances the match by at most tick_limit ticks and returns how many ticks were advanced,
+// either a stretch up to just before the next event or a single exact tick
+static uint64_t Game_fast_forward(Game *const this, float const dt, uint64_t const tick_limit)
+{
+    if (tick_limit == 0) return 0;
+
+    float const gain1 = this->player1_ai_gain * dt;
+    float const gain2 = this->player2_ai_gain * dt;
+
+    bool const is_serving = this->player_mode == PLAYER1_SERVE || this->player_mode == PLAYER2_SERVE;
+    bool const is_stable = gain1 > 0.0f && gain1 < 1.0f && gain2 > 0.0f && gain2 < 1.0f;
+    if (is_serving || !is_stable)
+    {
+        Game_step_match(this, dt);
+        return 1;
+    }
+
+    float const velocity_x = this->ball_velocity.x * dt;
+    float const velocity_y = this->ball_velocity.y * dt;
+    float const half_width = this->aspect_ratio / 2;
+    float const player2_x = this->aspect_ratio - this->player1.pos.x;
+    float const ai_min = PLAYER_SIZE.y / 2.0f;
+    float const ai_max = 1.0f - PLAYER_SIZE.y / 2.0f;
+
+    // the plane the ball has to reach before it can hit the paddle it is moving towards
+    float const face_x = this->player_mode == PLAYER1_FACE ?
+        this->player1.pos.x + PLAYER_SIZE.x / 2 + BALL_RADIUS :
+        player2_x - PLAYER_SIZE.x / 2 - BALL_RADIUS;
+
+    bool const is_past_face = this->player_mode == PLAYER1_FACE ?
+        this->ball_position.x <= face_x : this->ball_position.x >= face_x;
+
+    uint64_t event = tick_limit < FAST_FORWARD_NEVER - FAST_FORWARD_MARGIN ?
+        tick_limit + FAST_FORWARD_MARGIN : FAST_FORWARD_NEVER;
+    uint64_t ticks;
+
+#define FAST_FORWARD_EVENT(expression) ticks = (expression); event = ticks < event ? ticks : event
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.x, velocity_x, face_x));
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.x, velocity_x, half_width));
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.y, velocity_y, BALL_RADIUS));
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.y, velocity_y, 1.0f - BALL_RADIUS));
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.y, velocity_y, ai_min));
+    FAST_FORWARD_EVENT(fast_forward_ticks_until(this->ball_position.y, velocity_y, ai_max));
+#undef FAST_FORWARD_EVENT
+
+    if (is_past_face || event <= FAST_FORWARD_MARGIN)
+    {
+        Game_step_match(this, dt);
+        return 1;
+    }
+
+    uint64_t const skip = event - FAST_FORWARD_MARGIN;
+
+    // player1 is updated before the ball moves and player2 after it, see Game_step_match
+    bool const is_incoming1 = this->ball_position.x < half_width && this->ball_velocity.x < 0;
+    bool const is_incoming2 = this->ball_position.x > half_width && this->ball_velocity.x > 0;
+
+    this->player1.pos.y = is_incoming1 ?
+        fast_forward_ai(this->player1.pos.y, this->ball_position.y - velocity_y, velocity_y, gain1, skip) :
+        fast_forward_ai(this->player1.pos.y, 0.5f, 0.0f, gain1, skip);
+
+    this->player2.pos.y = is_incoming2 ?
+        fast_forward_ai(this->player2.pos.y, this->ball_position.y, velocity_y, gain2, skip) :
+        fast_forward_ai(this->player2.pos.y, 0.5f, 0.0f, gain2, skip);
+
+    this->ball_position.x = fast_forward_accumulate(this->ball_position.x, velocity_x, skip);
+    this->ball_position.y = fast_forward_accumulate(this->ball_position.y, velocity_y, skip);
+    this->player2.pos.x = player2_x;
+
+    return skip;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// fixed timestep clock, see https://gafferongames.com/post/fix_your_timestep/
+// the game is stepped at a fixed rate however long a frame takes and the renderer draws the state
+// interpolated between the last two steps, so the cost and the result of the simulation do not depend
+// on the frame rate
+
+// game time runs at this many units per second, everything in game.h moves per unit
+#define GAME_UNITS_PER_SECOND (120)
+
+// default step rate, one step per game unit
+#define FIXED_STEP_HZ (120)
+
+// after a long hitch (a breakpoint, dragging the window) the clock drops the time it is behind
+// beyond this instead of running hundreds of steps in one frame
+#define FIXED_STEP_MAX_CATCH_UP_NS (100000000u)
+
+typedef struct FixedStep
+{
+    uint64_t step_ns;
+
+    // time that has passed but has not been simulated yet, always less than step_ns between frames
+    uint64_t accumulator_ns;
+
+    // game units per step
+    float dt;
+
+    uint64_t step_count;
+    uint64_t dropped_ns;
+} FixedStep;
+
+static inline void FixedStep_init(FixedStep *const this, uint32_t const hz)
+{
+    *this = (FixedStep) {
+        .step_ns = 1000000000u / hz,
+        .dt = (float) GAME_UNITS_PER_SECOND / (float) hz,
+    };
+}
+
+// adds the time that passed since the last frame and returns how many steps to run for it
+static inline uint32_t FixedStep_advance(FixedStep *const this, uint64_t const elapsed_ns)
+{
+    this->accumulator_ns += elapsed_ns;
+
+    if (this->accumulator_ns > FIXED_STEP_MAX_CATCH_UP_NS)
+    {
+        this->dropped_ns += this->accumulator_ns - FIXED_STEP_MAX_CATCH_UP_NS;
+        this->accumulator_ns = FIXED_STEP_MAX_CATCH_UP_NS;
+    }
+
+    uint64_t const step_count = this->accumulator_ns / this->step_ns;
+    this->accumulator_ns -= step_count * this->step_ns;
+    this->step_count += step_count;
+    return (uint32_t) step_count;
+}
+
+// how far the current time is between the last step and the next one, from 0 to 1
+static inline float FixedStep_alpha(FixedStep const *const this)
+{
+    return (float) this->accumulator_ns / (float) this->step_ns;
+}
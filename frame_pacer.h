@@ -0,0 +1,210 @@
+#pragma once
+
+// paces frames at any rate without vsync. a sleep alone wakes up whenever the os gets to it, often a millisecond
+// or more late, and spinning alone burns a core, so the pacer sleeps until spin_margin_ns before the deadline and
+// spins the rest. the margin covers how late FRAME_PACER_MARGIN_PERCENT of the last FRAME_PACER_HISTORY sleeps
+// woke up, a histogram of them says how late that is. the odd sleep that wakes up later than that makes its frame
+// late, widening the margin for it would have every frame spin for as long. it keeps a histogram of how far each
+// frame interval was off the period, which is the jitter. the clock and the sleep are passed in so tests can pace
+// against a clock of their own, frame_pacer_os_now and frame_pacer_os_sleep are the real ones, the context of
+// frame_pacer_os_sleep is the ThreadTimer of the thread that paces.
+// needs timing.h, thread.h and latency.h
+
+// the rate main.c paces at with vsync off, build with -DFRAME_PACER_HZ=... for another one
+#ifndef FRAME_PACER_HZ
+#define FRAME_PACER_HZ (120)
+#endif
+
+// 1 us buckets up to 4 ms, everything further off lands in the last one
+#define FRAME_PACER_BUCKET_NS (1000u)
+#define FRAME_PACER_BUCKET_COUNT (4096)
+
+#define FRAME_PACER_MIN_MARGIN_NS (200000u)
+#define FRAME_PACER_START_MARGIN_NS (1000000u)
+
+// the margin covers this many percent of the last FRAME_PACER_HISTORY sleeps, in buckets of
+// FRAME_PACER_LATE_BUCKET_NS, everything later lands in the last one
+#define FRAME_PACER_MARGIN_PERCENT (90)
+#define FRAME_PACER_HISTORY (64)
+#define FRAME_PACER_LATE_BUCKET_NS (50000u)
+#define FRAME_PACER_LATE_BUCKET_COUNT (64)
+
+typedef uint64_t (*FramePacerNow)(void *context);
+typedef void (*FramePacerSleep)(void *context, uint64_t ns);
+
+typedef struct FramePacerStats
+{
+    uint32_t buckets[FRAME_PACER_BUCKET_COUNT];
+    uint64_t count;
+    uint64_t max_ns;
+
+    // frames that started more than a bucket after they were due, because the sleep overshot the margin or
+    // the frame before took longer than a period
+    uint64_t late_count;
+    uint64_t spin_ns;
+} FramePacerStats;
+
+typedef struct FramePacer
+{
+    uint64_t period_ns;
+    uint64_t deadline_ns;
+    uint64_t last_ns;
+    uint64_t spin_margin_ns;
+
+    // the bucket of how late each of the last sleeps woke up, and how many of them are in each bucket
+    uint8_t late_buckets[FRAME_PACER_HISTORY];
+    uint8_t late_counts[FRAME_PACER_LATE_BUCKET_COUNT];
+    uint32_t sleep_count;
+
+    FramePacerNow now;
+    FramePacerSleep sleep;
+    void *context;
+
+    FramePacerStats stats;
+} FramePacer;
+
+static uint64_t frame_pacer_os_now(void *const context)
+{
+    (void) context;
+    return time_now_ns();
+}
+
+static void frame_pacer_os_sleep(void *const context, uint64_t const ns)
+{
+    ThreadTimer_sleep_ns(context, ns);
+}
+
+static void FramePacer_init(FramePacer *const this, uint32_t const hz, FramePacerNow const now,
+                            FramePacerSleep const sleep, void *const context)
+{
+    *this = (FramePacer) {
+        .period_ns = 1000000000u / hz,
+        .spin_margin_ns = FRAME_PACER_START_MARGIN_NS,
+        .now = now,
+        .sleep = sleep,
+        .context = context,
+    };
+}
+
+// the next frame starts a new run, for after the loop blocked for something else, see idle.h
+static inline void FramePacer_reset(FramePacer *const this)
+{
+    this->deadline_ns = 0;
+    this->last_ns = 0;
+}
+
+// adds how late a sleep woke up and returns the margin that covers FRAME_PACER_MARGIN_PERCENT of the last ones
+static uint64_t FramePacer_add_late(FramePacer *const this, uint64_t const late_ns)
+{
+    uint64_t const bucket = late_ns / FRAME_PACER_LATE_BUCKET_NS;
+    uint8_t const late_bucket = (uint8_t) (bucket < FRAME_PACER_LATE_BUCKET_COUNT ?
+                                           bucket : FRAME_PACER_LATE_BUCKET_COUNT - 1);
+
+    uint32_t const slot = this->sleep_count % FRAME_PACER_HISTORY;
+    if (this->sleep_count >= FRAME_PACER_HISTORY) --this->late_counts[this->late_buckets[slot]];
+    this->late_buckets[slot] = late_bucket;
+    ++this->late_counts[late_bucket];
+    ++this->sleep_count;
+
+    // the upper edge of the bucket the percentile is in
+    uint32_t const count = this->sleep_count < FRAME_PACER_HISTORY ? this->sleep_count : FRAME_PACER_HISTORY;
+    uint32_t const wanted = (count * FRAME_PACER_MARGIN_PERCENT + 99) / 100;
+    uint32_t seen = 0;
+    uint32_t i = 0;
+    while ((seen += this->late_counts[i]) < wanted) ++i;
+    return (uint64_t) (i + 1) * FRAME_PACER_LATE_BUCKET_NS;
+}
+
+// adds the interval from the last frame to now to the jitter, for frames paced by something else like vsync
+static void FramePacer_mark(FramePacer *const this, uint64_t const now_ns)
+{
+    if (this->last_ns != 0)
+    {
+        uint64_t const interval_ns = now_ns - this->last_ns;
+        uint64_t const jitter_ns = interval_ns > this->period_ns ?
+            interval_ns - this->period_ns : this->period_ns - interval_ns;
+
+        FramePacerStats *const stats = &this->stats;
+        uint64_t const bucket = jitter_ns / FRAME_PACER_BUCKET_NS;
+        ++stats->buckets[bucket < FRAME_PACER_BUCKET_COUNT ? bucket : FRAME_PACER_BUCKET_COUNT - 1];
+        ++stats->count;
+        stats->max_ns = jitter_ns > stats->max_ns ? jitter_ns : stats->max_ns;
+    }
+    this->last_ns = now_ns;
+}
+
+// adds a frame that was due at deadline_ns and started at now_ns, it is late from a bucket after it on.
+// returns the deadline of the next frame, a frame more than a period late does not make the ones after it
+// early to catch up
+static uint64_t FramePacer_mark_due(FramePacer *const this, uint64_t const now_ns, uint64_t const deadline_ns)
+{
+    if (this->last_ns != 0 && now_ns >= deadline_ns + FRAME_PACER_BUCKET_NS) ++this->stats.late_count;
+    FramePacer_mark(this, now_ns);
+
+    uint64_t const next_ns = deadline_ns + this->period_ns;
+    return next_ns > now_ns ? next_ns : now_ns + this->period_ns;
+}
+
+// waits until the next frame is due and returns the time it woke up at
+static uint64_t FramePacer_wait(FramePacer *const this)
+{
+    uint64_t now_ns = this->now(this->context);
+    if (this->deadline_ns == 0) this->deadline_ns = now_ns;
+
+    if (now_ns < this->deadline_ns)
+    {
+        if (this->deadline_ns - now_ns > this->spin_margin_ns)
+        {
+            uint64_t const wake_ns = this->deadline_ns - this->spin_margin_ns;
+            this->sleep(this->context, wake_ns - now_ns);
+            now_ns = this->now(this->context);
+
+            uint64_t const margin_ns = FramePacer_add_late(this, now_ns > wake_ns ? now_ns - wake_ns : 0);
+
+            // never so wide that a frame is mostly spinning
+            uint64_t const max_margin_ns = this->period_ns / 2;
+            this->spin_margin_ns = margin_ns > max_margin_ns ? max_margin_ns :
+                margin_ns < FRAME_PACER_MIN_MARGIN_NS ? FRAME_PACER_MIN_MARGIN_NS : margin_ns;
+        }
+
+        uint64_t const spin_start_ns = now_ns;
+        while (now_ns < this->deadline_ns)
+        {
+            thread_pause();
+            now_ns = this->now(this->context);
+        }
+        this->stats.spin_ns += now_ns - spin_start_ns;
+    }
+
+    this->deadline_ns = FramePacer_mark_due(this, now_ns, this->deadline_ns);
+    return now_ns;
+}
+
+static inline uint64_t FramePacerStats_percentile_ns(FramePacerStats const *const this, uint32_t const percent)
+{
+    return latency_histogram_percentile_ns(this->buckets, FRAME_PACER_BUCKET_COUNT, FRAME_PACER_BUCKET_NS,
+                                           this->count, this->max_ns, percent);
+}
+
+// one line like "pacer 120 hz: jitter p50 2 p99 35 max 210 us, 3 of 1200 frames late\n" into buffer,
+// which needs 128 bytes, returns its length
+static size_t FramePacer_format(FramePacer const *const this, char const *const name, char *const buffer)
+{
+    FramePacerStats const *const stats = &this->stats;
+    char *out = latency_write_string(buffer, name);
+    out = latency_write_string(out, " ");
+    out = latency_write_uint(out, (1000000000u + this->period_ns / 2) / this->period_ns);
+    out = latency_write_string(out, " hz: jitter p50 ");
+    out = latency_write_uint(out, FramePacerStats_percentile_ns(stats, 50) / 1000u);
+    out = latency_write_string(out, " p99 ");
+    out = latency_write_uint(out, FramePacerStats_percentile_ns(stats, 99) / 1000u);
+    out = latency_write_string(out, " max ");
+    out = latency_write_uint(out, stats->max_ns / 1000u);
+    out = latency_write_string(out, " us, ");
+    out = latency_write_uint(out, stats->late_count);
+    out = latency_write_string(out, " of ");
+    out = latency_write_uint(out, stats->count);
+    out = latency_write_string(out, " frames late\n");
+    *out = '\0';
+    return (size_t) (out - buffer);
+}
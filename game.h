@@ -0,0 +1,615 @@
+#pragma once
+
+// the platform independent part of the game, everything in here only depends on vec.h
+// so it can be stepped without a window or a d3d device
+
+typedef enum PlayerMode
+{
+    PLAYER1_SERVE,
+    PLAYER2_SERVE,
+    PLAYER1_FACE,
+    PLAYER2_FACE,
+} PlayerMode;
+
+typedef struct Player
+{
+    float2 pos;
+    int unsigned score;
+} Player;
+
+#define KEY_BITMAP_BIT_SIZE (64)
+typedef struct KeyBitmap
+{
+    uint64_t data[4];
+} KeyBitmap;
+
+static inline bool KeyBitmap_get(KeyBitmap const self, int const index)
+{
+    return ((self.data[index / KEY_BITMAP_BIT_SIZE] >> (index % KEY_BITMAP_BIT_SIZE)) & 1) != 0;
+}
+
+static inline void KeyBitmap_flip(KeyBitmap *const this, int const index)
+{
+    this->data[index / KEY_BITMAP_BIT_SIZE] ^= ((uint64_t)1 << (index % KEY_BITMAP_BIT_SIZE));
+}
+
+static inline void KeyBitmap_change(KeyBitmap *const this, int const index, bool const new_bit)
+{
+    this->data[index / KEY_BITMAP_BIT_SIZE] ^=
+        (-((uint64_t) new_bit) ^ this->data[index / KEY_BITMAP_BIT_SIZE]) &
+        ((uint64_t) 1 << (index % KEY_BITMAP_BIT_SIZE));
+}
+
+// same values as VK_UP and VK_DOWN so win32 key codes can be used directly
+#define KEY_UP (0x26)
+#define KEY_DOWN (0x28)
+
+typedef enum GameMode
+{
+    GAME_MODE_START,
+    GAME_MODE_GAME,
+} GameMode;
+
+typedef struct Game
+{
+    float2 ball_position;
+    float2 ball_velocity;
+
+    Player player1;
+    Player player2;
+    PlayerMode player_mode;
+
+    KeyBitmap keys;
+
+    GameMode game_mode;
+
+    // width / height of the playing field, the height is always 1
+    float aspect_ratio;
+
+    // how fast Game_update_ai moves each paddle towards its target per unit of time,
+    // player1 only uses it in ai vs ai matches and 0 means player1 is moved by the player
+    float player1_ai_gain;
+    float player2_ai_gain;
+
+    // xorshift state used to pick who serves, must not be 0
+    uint32_t seed;
+} Game;
+
+#define BALL_RADIUS (0.025f)
+#define PLAYER_SIZE ((float2){0.05f, 0.24f})
+#define INITIAL_BALL_VELOCITY ((float2){.x = 0.01f, .y = 0.0f})
+#define AI_GAIN (0.0925f)
+
+static inline uint32_t Game_random(Game *const this)
+{
+    // see https://en.wikipedia.org/wiki/Xorshift
+    uint32_t x = this->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return this->seed = x;
+}
+
+static void Game_update_ai(Game *const this, Player *const player, float const dt)
+{
+    // only chase the ball while it is moving towards the half of the player
+    bool const is_left = player->pos.x < this->aspect_ratio / 2;
+    bool const is_incoming = is_left ?
+        this->ball_position.x < this->aspect_ratio / 2 && this->ball_velocity.x < 0 :
+        this->ball_position.x > this->aspect_ratio / 2 && this->ball_velocity.x > 0;
+
+    if (is_incoming)
+    {
+        player->pos.y = flerp(player->pos.y, this->ball_position.y, dt);
+    }
+    else
+    {
+        player->pos.y = flerp(player->pos.y, 0.5f, dt);
+    }
+
+    player->pos.y = fclamp(player->pos.y, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+}
+
+static inline void Game_reset(Game *const this)
+{
+    this->player1.pos.x = 0.1f;
+    this->player1.pos.y = 0.5f;
+    this->player2.pos.y = 0.5f;
+
+    this->player1.score = 0;
+    this->player2.score = 0;
+    this->player_mode = Game_random(this) % 2 != 0 ? PLAYER1_SERVE : PLAYER2_SERVE;
+
+    this->game_mode = GAME_MODE_START;
+}
+
+static void Game_update(Game *const this, float const frame_delta)
+{
+    if (this->game_mode != GAME_MODE_START && KeyBitmap_get(this->keys, 'R'))
+    {
+        Game_reset(this);
+    }
+
+    if (KeyBitmap_get(this->keys, KEY_UP))
+    {
+        this->player1.pos.y += 0.025f * frame_delta;
+    }
+
+    if (KeyBitmap_get(this->keys, KEY_DOWN))
+    {
+        this->player1.pos.y -= 0.025f * frame_delta;
+    }
+
+    float const correct_width = this->aspect_ratio;
+
+    this->ball_position.x += this->ball_velocity.x * frame_delta;
+    this->ball_position.y += this->ball_velocity.y * frame_delta;
+
+    this->player2.pos.x = correct_width - this->player1.pos.x;
+
+    Game_update_ai(this, &this->player2, this->player2_ai_gain * frame_delta);
+
+#define BOUNCE_STRENGTH (1.75f)
+    switch (this->player_mode)
+    {
+        case PLAYER1_SERVE:
+        {
+            this->ball_velocity = (float2) {0};
+            this->ball_position = (float2) {this->player1.pos.x + PLAYER_SIZE.x, this->player1.pos.y};
+            if (KeyBitmap_get(this->keys, ' '))
+            {
+                this->player_mode = PLAYER2_FACE;
+                this->ball_velocity = INITIAL_BALL_VELOCITY;
+
+                this->game_mode = GAME_MODE_GAME;
+            }
+
+            break;
+        }
+
+        case PLAYER2_SERVE:
+        {
+            this->ball_velocity = (float2) {0};
+            this->ball_position = (float2) {this->player2.pos.x - PLAYER_SIZE.x, this->player2.pos.y};
+
+            if (this->game_mode == GAME_MODE_GAME || KeyBitmap_get(this->keys, ' '))
+            {
+                this->player_mode = PLAYER1_FACE;
+                this->ball_velocity = (float2) {-INITIAL_BALL_VELOCITY.x, INITIAL_BALL_VELOCITY.y};
+
+                this->game_mode = GAME_MODE_GAME;
+            }
+
+            break;
+        }
+
+        case PLAYER1_FACE:
+        {
+            if (this->ball_position.x - BALL_RADIUS <= this->player1.pos.x + PLAYER_SIZE.x / 2 &&
+                fabsf(this->ball_position.y - this->player1.pos.y) <= PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f)
+            {
+                float const percentage = (this->ball_position.y - this->player1.pos.y) / (PLAYER_SIZE.y / 2.0f);
+                this->ball_velocity.y = INITIAL_BALL_VELOCITY.x * percentage * BOUNCE_STRENGTH;
+                this->ball_velocity.x *= -1.0f;
+
+                this->player_mode = PLAYER2_FACE;
+            }
+
+            break;
+        }
+
+        case PLAYER2_FACE:
+        {
+            if (this->ball_position.x + BALL_RADIUS >= this->player2.pos.x - PLAYER_SIZE.x / 2 &&
+                fabsf(this->ball_position.y - this->player2.pos.y) <= PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f)
+            {
+                float const percentage = (this->ball_position.y - this->player2.pos.y) / (PLAYER_SIZE.y / 2.0f);
+                this->ball_velocity.y = INITIAL_BALL_VELOCITY.x * percentage * BOUNCE_STRENGTH;
+                this->ball_velocity.x *= -1.0f;
+
+                this->player_mode = PLAYER1_FACE;
+            }
+
+            break;
+        }
+    }
+#undef BOUNCE_STRENGTH
+
+    if (this->ball_position.y - BALL_RADIUS < 0 || this->ball_position.y + BALL_RADIUS >= 1)
+    {
+        this->ball_velocity.y *= -1.0f;
+    }
+
+    if (this->ball_position.x - BALL_RADIUS < 0)
+    {
+        ++this->player2.score;
+        this->player_mode = PLAYER2_SERVE;
+    }
+    else if(this->ball_position.x + BALL_RADIUS >= correct_width)
+    {
+        ++this->player1.score;
+        this->player_mode = PLAYER1_SERVE;
+    }
+
+    this->ball_position.y = fclamp(this->ball_position.y, BALL_RADIUS, 1.0f - BALL_RADIUS);
+}
+
+// how many events Game_update_swept handles in one step before it drops the rest of the step,
+// only a ball that is stuck bouncing between the walls with a huge step gets there
+#define SWEPT_MAX_EVENTS (32)
+
+typedef enum SweptEvent
+{
+    SWEPT_EVENT_NONE,
+    SWEPT_EVENT_WALL,
+    SWEPT_EVENT_HIT,
+    SWEPT_EVENT_GOAL,
+    SWEPT_EVENT_AI_TARGET,
+} SweptEvent;
+
+// Game_update_ai in continuous time, the paddle closes the gap to its target at gain per unit of time.
+// the target is target + target_velocity * t, the result is the gap between target and paddle at time
+static inline float swept_ai_gap(float const gap, float const target_velocity, float const gain, float const time)
+{
+    if (gain == 0.0f) return gap + target_velocity * time;
+
+    // the gap settles at a constant lag behind a linearly moving target
+    float const lag = target_velocity / gain;
+    return lag + (gap - lag) * fexp(-gain * time);
+}
+
+// first time at which the gap reaches bound, or a negative time if it never does
+static inline float swept_ai_gap_time(float const gap, float const target_velocity, float const gain,
+                                      float const bound)
+{
+    if (gain == 0.0f)
+    {
+        return target_velocity != 0.0f ? (bound - gap) / target_velocity : -1.0f;
+    }
+
+    float const lag = target_velocity / gain;
+    float const ratio = (bound - lag) / (gap - lag);
+    return ratio > 0.0f && ratio <= 1.0f ? -flog(ratio) / gain : -1.0f;
+}
+
+// like Game_update but the ball moves along its path and collides at the exact time it touches a
+// wall, a paddle or a goal line and then carries on with the rest of the step, so no frame_delta
+// makes it tunnel. the ai paddles (player1 only when player1_ai_gain is not 0) move in continuous
+// time alongside it, so large steps neither overshoot nor change how fast they chase the ball.
+// a paddle catches the ball from the moment the ball reaches its face until the ball reaches the
+// goal line, the same rule Game_update applies once per tick.
+static void Game_update_swept(Game *const this, float const frame_delta)
+{
+    if (this->game_mode != GAME_MODE_START && KeyBitmap_get(this->keys, 'R'))
+    {
+        Game_reset(this);
+    }
+
+    if (KeyBitmap_get(this->keys, KEY_UP))
+    {
+        this->player1.pos.y += 0.025f * frame_delta;
+    }
+
+    if (KeyBitmap_get(this->keys, KEY_DOWN))
+    {
+        this->player1.pos.y -= 0.025f * frame_delta;
+    }
+
+    float const correct_width = this->aspect_ratio;
+    float const half_width = correct_width / 2;
+    float const ai_min = PLAYER_SIZE.y / 2.0f;
+    float const ai_max = 1.0f - PLAYER_SIZE.y / 2.0f;
+    float const reach = PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f;
+
+    this->player2.pos.x = correct_width - this->player1.pos.x;
+
+    switch (this->player_mode)
+    {
+        case PLAYER1_SERVE:
+        {
+            this->ball_velocity = (float2) {0};
+            this->ball_position = (float2) {this->player1.pos.x + PLAYER_SIZE.x, this->player1.pos.y};
+            if (KeyBitmap_get(this->keys, ' '))
+            {
+                this->player_mode = PLAYER2_FACE;
+                this->ball_velocity = INITIAL_BALL_VELOCITY;
+
+                this->game_mode = GAME_MODE_GAME;
+            }
+
+            break;
+        }
+
+        case PLAYER2_SERVE:
+        {
+            this->ball_velocity = (float2) {0};
+            this->ball_position = (float2) {this->player2.pos.x - PLAYER_SIZE.x, this->player2.pos.y};
+
+            if (this->game_mode == GAME_MODE_GAME || KeyBitmap_get(this->keys, ' '))
+            {
+                this->player_mode = PLAYER1_FACE;
+                this->ball_velocity = (float2) {-INITIAL_BALL_VELOCITY.x, INITIAL_BALL_VELOCITY.y};
+
+                this->game_mode = GAME_MODE_GAME;
+            }
+
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    Player *const players[2] = {&this->player1, &this->player2};
+    float const gains[2] = {this->player1_ai_gain, this->player2_ai_gain};
+
+    float remaining = frame_delta;
+    for (int i = 0; i < SWEPT_MAX_EVENTS && remaining > 0.0f; ++i)
+    {
+        float2 const position = this->ball_position;
+        float2 const velocity = this->ball_velocity;
+
+        // what every ai paddle chases until the next event, see Game_update_ai
+        bool is_incoming[2];
+        float targets[2];
+        float target_velocities[2];
+        bool is_any_incoming = false;
+        for (int player = 0; player < 2; ++player)
+        {
+            // a ball on the middle line counts for the side it is moving into
+            is_incoming[player] = player == 0 ?
+                position.x <= half_width && velocity.x < 0 :
+                position.x >= half_width && velocity.x > 0;
+
+            targets[player] = is_incoming[player] ? position.y : 0.5f;
+            target_velocities[player] = is_incoming[player] ? velocity.y : 0.0f;
+            is_any_incoming |= is_incoming[player] && gains[player] != 0.0f;
+        }
+
+        float time = remaining;
+        SweptEvent event = SWEPT_EVENT_NONE;
+
+#define SWEPT_EVENT(event_time, new_event) \
+        if ((event_time) >= 0.0f && (event_time) < time) { time = (event_time); event = (new_event); }
+
+        // an ai target change only splits the step when it is ahead, one right now is already in effect
+#define SWEPT_AI_EVENT(event_time) \
+        if ((event_time) > 0.0f && (event_time) < time) { time = (event_time); event = SWEPT_EVENT_AI_TARGET; }
+
+        // walls
+        float const wall_y = velocity.y < 0.0f ? BALL_RADIUS : 1.0f - BALL_RADIUS;
+        if (velocity.y != 0.0f)
+        {
+            SWEPT_EVENT(fmaxf((wall_y - position.y) / velocity.y, 0.0f), SWEPT_EVENT_WALL);
+        }
+
+        // goal lines
+        if (velocity.x != 0.0f)
+        {
+            float const goal_x = velocity.x < 0.0f ? BALL_RADIUS : correct_width - BALL_RADIUS;
+            SWEPT_EVENT(fmaxf((goal_x - position.x) / velocity.x, 0.0f), SWEPT_EVENT_GOAL);
+        }
+
+        // the ai changes target when the ball crosses the middle and the paddle can only keep up with
+        // the ball while it is between ai_min and ai_max, both split the step so the closed forms hold
+        if (velocity.x != 0.0f && gains[0] + gains[1] != 0.0f)
+        {
+            SWEPT_AI_EVENT((half_width - position.x) / velocity.x);
+        }
+
+        if (velocity.y != 0.0f && is_any_incoming)
+        {
+            SWEPT_AI_EVENT((ai_min - position.y) / velocity.y);
+            SWEPT_AI_EVENT((ai_max - position.y) / velocity.y);
+        }
+
+        // the paddle the ball is moving towards
+        bool const is_player1 = this->player_mode == PLAYER1_FACE;
+        bool const is_facing = this->player_mode == PLAYER1_FACE || this->player_mode == PLAYER2_FACE;
+        int const facing = is_player1 ? 0 : 1;
+        Player const *const player = players[facing];
+        float const face_x = is_player1 ?
+            player->pos.x + PLAYER_SIZE.x / 2 + BALL_RADIUS :
+            player->pos.x - PLAYER_SIZE.x / 2 - BALL_RADIUS;
+
+        if (is_facing && (is_player1 ? velocity.x < 0.0f : velocity.x > 0.0f))
+        {
+            float const face_time = fmaxf((face_x - position.x) / velocity.x, 0.0f);
+            if (face_time < time)
+            {
+                // the gap between ball and paddle moves monotonically while the target is the ball,
+                // the clamp only matters for the side of the field the ball is on and the ball is always
+                // within reach of a paddle clamped to that side, so only one bound of the gap matters then
+                float const gap = position.y - player->pos.y;
+                bool const is_ai = gains[facing] != 0.0f;
+                float const low = is_ai && targets[facing] > ai_max ? -1e30f : -reach;
+                float const high = is_ai && targets[facing] < ai_min ? 1e30f : reach;
+
+                float hit_time = -1.0f;
+                if (is_incoming[facing] || !is_ai)
+                {
+                    float const face_gap = swept_ai_gap(gap, velocity.y, gains[facing], face_time);
+                    if (face_gap >= low && face_gap <= high)
+                    {
+                        hit_time = face_time;
+                    }
+                    else
+                    {
+                        float const bound_time = swept_ai_gap_time(gap, velocity.y, gains[facing],
+                                                                   face_gap > high ? high : low);
+                        hit_time = bound_time >= face_time ? bound_time : -1.0f;
+                    }
+                }
+                else
+                {
+                    // a paddle resting towards the middle is only checked when the ball reaches it
+                    float const ball_y = position.y + velocity.y * face_time;
+                    float const paddle_y = targets[facing] + (player->pos.y - targets[facing]) *
+                                                             fexp(-gains[facing] * face_time);
+                    hit_time = fabsf(ball_y - fclamp(paddle_y, ai_min, ai_max)) <= reach ? face_time : -1.0f;
+                }
+
+                // a hit at the same time as another event goes first
+                if (hit_time >= 0.0f && hit_time <= time)
+                {
+                    time = hit_time;
+                    event = SWEPT_EVENT_HIT;
+                }
+            }
+        }
+#undef SWEPT_AI_EVENT
+#undef SWEPT_EVENT
+
+        // move everything to the event
+        for (int player_index = 0; player_index < 2; ++player_index)
+        {
+            if (gains[player_index] == 0.0f) continue;
+
+            Player *const ai_player = players[player_index];
+            float const gap = targets[player_index] - ai_player->pos.y;
+            float const new_gap = swept_ai_gap(gap, target_velocities[player_index], gains[player_index], time);
+            float const new_target = targets[player_index] + target_velocities[player_index] * time;
+            ai_player->pos.y = fclamp(new_target - new_gap, ai_min, ai_max);
+        }
+
+        this->ball_position.x += velocity.x * time;
+        this->ball_position.y += velocity.y * time;
+        remaining -= time;
+
+#define BOUNCE_STRENGTH (1.75f)
+        switch (event)
+        {
+            case SWEPT_EVENT_WALL:
+            {
+                this->ball_position.y = wall_y;
+                this->ball_velocity.y *= -1.0f;
+                break;
+            }
+
+            case SWEPT_EVENT_HIT:
+            {
+                float const percentage = (this->ball_position.y - player->pos.y) / (PLAYER_SIZE.y / 2.0f);
+                this->ball_velocity.y = INITIAL_BALL_VELOCITY.x * percentage * BOUNCE_STRENGTH;
+                this->ball_velocity.x *= -1.0f;
+
+                this->player_mode = is_player1 ? PLAYER2_FACE : PLAYER1_FACE;
+                break;
+            }
+
+            case SWEPT_EVENT_GOAL:
+            {
+                if (velocity.x < 0.0f)
+                {
+                    ++this->player2.score;
+                    this->player_mode = PLAYER2_SERVE;
+                }
+                else
+                {
+                    ++this->player1.score;
+                    this->player_mode = PLAYER1_SERVE;
+                }
+
+                // the ball waits for the serve in the next step
+                this->ball_velocity = (float2) {0};
+                break;
+            }
+
+            case SWEPT_EVENT_AI_TARGET:
+            case SWEPT_EVENT_NONE:
+            {
+                break;
+            }
+        }
+#undef BOUNCE_STRENGTH
+    }
+
+    // a ball waiting to be served sits in front of the paddle
+    if (this->player_mode == PLAYER1_SERVE)
+    {
+        this->ball_position = (float2) {this->player1.pos.x + PLAYER_SIZE.x, this->player1.pos.y};
+    }
+    else if (this->player_mode == PLAYER2_SERVE)
+    {
+        this->ball_position = (float2) {this->player2.pos.x - PLAYER_SIZE.x, this->player2.pos.y};
+    }
+
+    this->ball_position.y = fclamp(this->ball_position.y, BALL_RADIUS, 1.0f - BALL_RADIUS);
+}
+
+// sets up a match where both paddles are driven by the ai and serves happen immediately
+static void Game_setup_match(Game *const this, uint32_t const seed, float const aspect_ratio)
+{
+    *this = (Game) {
+        .aspect_ratio = aspect_ratio,
+        .player1_ai_gain = AI_GAIN,
+        .player2_ai_gain = AI_GAIN,
+        .seed = seed | 1,
+    };
+
+    Game_reset(this);
+
+    // hold down space so player1 serves as well
+    KeyBitmap_flip(&this->keys, ' ');
+}
+
+static inline void Game_step_match(Game *const this, float const dt)
+{
+    Game_update_ai(this, &this->player1, this->player1_ai_gain * dt);
+    Game_update(this, dt);
+}
+
+// Game_update_swept moves player1 with the ai by itself
+static inline void Game_step_match_swept(Game *const this, float const dt)
+{
+    Game_update_swept(this, dt);
+}
+
+// what the renderer needs from a game
+typedef struct GameSnapshot
+{
+    float2 ball_position;
+    float2 player1_position;
+    float2 player2_position;
+
+    int unsigned player1_score;
+    int unsigned player2_score;
+
+    PlayerMode player_mode;
+
+    // which step of the clock that drives the game made it and how many mouse moves it has seen,
+    // both filled in by the caller
+    uint64_t step;
+    uint32_t input_count;
+} GameSnapshot;
+
+static inline GameSnapshot Game_snapshot(Game const *const this)
+{
+    return (GameSnapshot) {
+        .ball_position = this->ball_position,
+        .player1_position = this->player1.pos,
+        .player2_position = this->player2.pos,
+        .player1_score = this->player1.score,
+        .player2_score = this->player2.score,
+        .player_mode = this->player_mode,
+    };
+}
+
+// the state at alpha between two consecutive steps
+static inline GameSnapshot GameSnapshot_lerp(GameSnapshot const *const previous, GameSnapshot const *const current,
+                                             float const alpha)
+{
+    GameSnapshot result = *current;
+
+    // the ball jumps back to a paddle when a point is scored, it should not fly across the field
+    bool const is_serve = current->player_mode == PLAYER1_SERVE || current->player_mode == PLAYER2_SERVE;
+    if (!is_serve || previous->player_mode == current->player_mode)
+    {
+        result.ball_position = flerp2(previous->ball_position, current->ball_position, alpha);
+    }
+
+    result.player1_position = flerp2(previous->player1_position, current->player1_position, alpha);
+    result.player2_position = flerp2(previous->player2_position, current->player2_position, alpha);
+    return result;
+}
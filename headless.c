@@ -0,0 +1,2633 @@
+// headless driver for the platform independent parts of the game,
+// build with `make headless` on linux
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include "vec.h"
+#include "font.h"
+#include "shader.h"
+#include "game.h"
+#include "batch.h"
+#include "timing.h"
+#include "thread.h"
+#include "tournament.h"
+#include "fast_forward.h"
+#include "fixed_step.h"
+#include "triple_buffer.h"
+#include "latency.h"
+#include "input.h"
+#include "simulation.h"
+#include "render.h"
+#include "render_simd.h"
+#include "render_tiles.h"
+#include "render_dirty.h"
+#include "render_score.h"
+#include "render_background.h"
+#include "render_sprites.h"
+#include "render_hierarchy.h"
+#include "resolution.h"
+#include "present.h"
+#include "idle.h"
+#include "frame_pacer.h"
+#include "shader_cache.h"
+
+static int bench_sim(int const argc, char **const argv)
+{
+    uint64_t const tick_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 100000000u;
+    float const dt = argc > 1 ? strtof(argv[1], NULL) : 1.0f;
+
+    Game game;
+    Game_setup_match(&game, 1, 900.0f / 600.0f);
+
+    uint64_t const time_start = time_now_ns();
+    for (uint64_t i = 0; i < tick_count; ++i)
+    {
+        Game_step_match(&game, dt);
+    }
+    uint64_t const time_elapsed = time_now_ns() - time_start;
+
+    printf("sim: %llu ticks in %.3f s, %.1f Mticks/s, %.2f ns/tick, score %u:%u\n",
+           (unsigned long long) tick_count, (double) time_elapsed / 1e9,
+           (double) tick_count / ((double) time_elapsed / 1e3),
+           (double) time_elapsed / (double) tick_count,
+           game.player1.score, game.player2.score);
+
+    return 0;
+}
+
+// a match with both paddles moved away from the center so the rallies differ between seeds
+static void Game_setup_random_match(Game *const this, uint32_t const seed, float const aspect_ratio)
+{
+    Game_setup_match(this, seed, aspect_ratio);
+
+    float const range = 1.0f - PLAYER_SIZE.y;
+    this->player1.pos.y = PLAYER_SIZE.y / 2.0f + (float) (Game_random(this) % 1024) / 1024.0f * range;
+    this->player2.pos.y = PLAYER_SIZE.y / 2.0f + (float) (Game_random(this) % 1024) / 1024.0f * range;
+}
+
+static bool Game_equal(Game const *const a, Game const *const b)
+{
+    return memcmp(&a->ball_position, &b->ball_position, sizeof(a->ball_position)) == 0 &&
+           memcmp(&a->ball_velocity, &b->ball_velocity, sizeof(a->ball_velocity)) == 0 &&
+           memcmp(&a->player1, &b->player1, sizeof(a->player1)) == 0 &&
+           memcmp(&a->player2, &b->player2, sizeof(a->player2)) == 0 &&
+           a->player_mode == b->player_mode;
+}
+
+static int bench_batch(int const argc, char **const argv)
+{
+    size_t const match_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 4096u;
+    size_t const tick_count = argc > 1 ? strtoull(argv[1], NULL, 10) : 10000u;
+    float const dt = argc > 2 ? strtof(argv[2], NULL) : 1.0f;
+    float const aspect_ratio = 900.0f / 600.0f;
+
+    Game *const reference = malloc(match_count * sizeof(Game));
+    for (size_t i = 0; i < match_count; ++i)
+    {
+        Game_setup_random_match(&reference[i], (uint32_t) i + 1, aspect_ratio);
+    }
+
+    void *const memory = aligned_alloc(64, GameBatch_memory_size(match_count));
+    GameBatch batch;
+    GameBatch_init(&batch, match_count, aspect_ratio, memory);
+
+    // the scalar reference steps one Game at a time exactly like bench_sim
+    uint64_t time_start = time_now_ns();
+    for (size_t i = 0; i < match_count; ++i)
+    {
+        Game *const game = &reference[i];
+        for (size_t step = 0; step < tick_count; ++step)
+        {
+            Game_step_match(game, dt);
+        }
+    }
+    double const scalar_seconds = (double) (time_now_ns() - time_start) / 1e9;
+    double const total_ticks = (double) match_count * (double) tick_count;
+
+    uint64_t point_count = 0;
+    for (size_t i = 0; i < match_count; ++i)
+    {
+        point_count += reference[i].player1.score + reference[i].player2.score;
+    }
+
+    printf("batch: %zu matches x %zu ticks, %llu points\n", match_count, tick_count,
+           (unsigned long long) point_count);
+    printf("    %-8s %8.1f Mmatch-ticks/s\n", "game", total_ticks / scalar_seconds / 1e6);
+
+    GameBatchIsa const best_isa = GameBatch_best_isa();
+    int result = 0;
+    for (GameBatchIsa isa = GAME_BATCH_ISA_SCALAR; isa <= best_isa; ++isa)
+    {
+        for (size_t i = 0; i < match_count; ++i)
+        {
+            Game game;
+            Game_setup_random_match(&game, (uint32_t) i + 1, aspect_ratio);
+            GameBatch_set(&batch, i, &game);
+        }
+
+        time_start = time_now_ns();
+        GameBatch_step(&batch, isa, dt, tick_count);
+        double const seconds = (double) (time_now_ns() - time_start) / 1e9;
+
+        size_t mismatch_count = 0;
+        for (size_t i = 0; i < match_count; ++i)
+        {
+            Game game;
+            GameBatch_get(&batch, i, &game);
+            mismatch_count += !Game_equal(&game, &reference[i]);
+        }
+
+        printf("    %-8s %8.1f Mmatch-ticks/s, %.2fx, %zu mismatches\n", GameBatchIsa_name(isa),
+               total_ticks / seconds / 1e6, scalar_seconds / seconds, mismatch_count);
+
+        if (mismatch_count != 0) result = 1;
+    }
+
+    free(memory);
+    free(reference);
+    return result;
+}
+
+static double run_tournament(Tournament *const tournament, MatchConfig const *const configs,
+                             MatchResult *const results, _Atomic size_t *const completed,
+                             size_t const match_count, int const thread_count,
+                             uint64_t const time_limit_ns, bool const is_verbose)
+{
+    Tournament_start(tournament, configs, results, completed, match_count, thread_count, time_limit_ns);
+
+    // stream the results while the workers are still running
+    size_t status_counts[3] = {0};
+    uint64_t tick_count = 0;
+    size_t index;
+    while (Tournament_next(tournament, &index))
+    {
+        MatchResult const *const result = &results[index];
+        ++status_counts[result->status];
+        tick_count += result->tick_count;
+    }
+
+    Tournament_finish(tournament);
+
+    double const seconds = (double) (tournament->end_ns - tournament->start_ns) / 1e9;
+    printf("    %3d threads: %7.3f s, %8.1f Mticks/s, %zu finished, %zu timed out, %zu skipped\n",
+           tournament->worker_count, seconds, (double) tick_count / seconds / 1e6,
+           status_counts[MATCH_FINISHED], status_counts[MATCH_TIMED_OUT], status_counts[MATCH_SKIPPED]);
+
+    if (is_verbose)
+    {
+        for (int i = 0; i < tournament->worker_count; ++i)
+        {
+            TournamentWorker const *const worker = &tournament->workers[i];
+            printf("        worker %3d: %5.1f%% busy, %llu matches, %llu steals\n", i,
+                   TournamentWorker_utilization(worker) * 100.0,
+                   (unsigned long long) worker->match_count, (unsigned long long) worker->steal_count);
+        }
+    }
+
+    return seconds;
+}
+
+static int bench_tournament(int const argc, char **const argv)
+{
+    size_t const match_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 2048u;
+    int const thread_count = argc > 1 ? atoi(argv[1]) : thread_hardware_count();
+    uint64_t const tick_limit = argc > 2 ? strtoull(argv[2], NULL, 10) : 100000u;
+    uint64_t const time_limit_ms = argc > 3 ? strtoull(argv[3], NULL, 10) : 0u;
+
+    MatchConfig *const configs = malloc(match_count * sizeof(MatchConfig));
+    MatchResult *const results = malloc(match_count * sizeof(MatchResult));
+    _Atomic size_t *const completed = malloc(match_count * sizeof(*completed));
+    Tournament *const tournament = aligned_alloc(64, sizeof(Tournament));
+
+    // sweep the gain of player1 against the default ai, slow paddles lose points
+    for (size_t i = 0; i < match_count; ++i)
+    {
+        configs[i] = (MatchConfig) {
+            .seed = (uint32_t) i + 1,
+            .player1_ai_gain = 0.01f + 0.1f * (float) (i % 64) / 64.0f,
+            .player2_ai_gain = AI_GAIN,
+            .aspect_ratio = 900.0f / 600.0f,
+            .dt = 1.0f,
+            .tick_limit = tick_limit,
+            .score_limit = 11,
+        };
+    }
+
+    printf("tournament: %zu matches, at most %llu ticks each\n", match_count, (unsigned long long) tick_limit);
+
+    if (thread_count > 0)
+    {
+        run_tournament(tournament, configs, results, completed, match_count, thread_count,
+                       time_limit_ms * 1000000u, true);
+    }
+    else
+    {
+        // a thread count of 0 measures the scaling up to the number of hardware threads
+        double const base_seconds = run_tournament(tournament, configs, results, completed, match_count, 1,
+                                                   time_limit_ms * 1000000u, false);
+        for (int threads = 2; threads <= thread_hardware_count(); threads *= 2)
+        {
+            double const seconds = run_tournament(tournament, configs, results, completed, match_count, threads,
+                                                  time_limit_ms * 1000000u, false);
+            printf("        speedup %.2fx, efficiency %.0f%%\n", base_seconds / seconds,
+                   base_seconds / seconds / threads * 100.0);
+        }
+    }
+
+    free(tournament);
+    free(completed);
+    free(results);
+    free(configs);
+    return 0;
+}
+
+static inline bool Game_is_rally_over(PlayerMode const before, PlayerMode const after)
+{
+    return before != after && (after == PLAYER1_FACE || after == PLAYER2_FACE);
+}
+
+static int bench_fast_forward(int const argc, char **const argv)
+{
+    uint64_t const rally_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 1000000u;
+    float const gain1 = argc > 1 ? strtof(argv[1], NULL) : AI_GAIN;
+    float const dt = argc > 2 ? strtof(argv[2], NULL) : 1.0f;
+    float const aspect_ratio = 900.0f / 600.0f;
+
+    // agreement with the per tick path, starting from the same state both paths run to the next event
+    // (hit, goal or serve) which has to be the same event on the same tick with the ball and paddle heights
+    // within the tolerance, then the event driven path continues from the state of the per tick one
+    size_t const check_count = 1000;
+    int const check_event_count = 16;
+    float const tolerance = 1e-3f;
+    int64_t max_tick_error = 0;
+    float max_height_error = 0.0f;
+    size_t mismatch_count = 0;
+    for (size_t i = 0; i < check_count; ++i)
+    {
+        Game reference;
+        Game_setup_random_match(&reference, (uint32_t) i + 1, aspect_ratio);
+        reference.player1_ai_gain = gain1;
+        Game game = reference;
+
+        for (int event = 0; event < check_event_count; ++event)
+        {
+            game = reference;
+            uint64_t reference_tick = 0;
+            uint64_t tick = 0;
+
+            PlayerMode const reference_mode = reference.player_mode;
+            do
+            {
+                Game_step_match(&reference, dt);
+                ++reference_tick;
+            } while (reference.player_mode == reference_mode && reference_tick < 100000);
+
+            PlayerMode const mode = game.player_mode;
+            do
+            {
+                tick += Game_fast_forward(&game, dt, 100000 - tick);
+            } while (game.player_mode == mode && tick < 100000);
+
+            int64_t const tick_error = (int64_t) tick - (int64_t) reference_tick;
+            float const height_error = fmaxf(fabsf(game.ball_position.y - reference.ball_position.y),
+                                             fmaxf(fabsf(game.player1.pos.y - reference.player1.pos.y),
+                                                   fabsf(game.player2.pos.y - reference.player2.pos.y)));
+
+            max_tick_error = tick_error < 0 ? (-tick_error > max_tick_error ? -tick_error : max_tick_error) :
+                             (tick_error > max_tick_error ? tick_error : max_tick_error);
+            max_height_error = fmaxf(max_height_error, height_error);
+
+            if (game.player_mode != reference.player_mode ||
+                game.player1.score != reference.player1.score || game.player2.score != reference.player2.score)
+            {
+                ++mismatch_count;
+                break;
+            }
+        }
+    }
+
+    bool const is_within_tolerance = max_tick_error == 0 && max_height_error <= tolerance && mismatch_count == 0;
+    printf("fast forward: %zu matches x %d events, max tick error %lld, max height error %g, "
+           "%zu mismatched events, tolerance %g: %s\n",
+           check_count, check_event_count, (long long) max_tick_error, (double) max_height_error,
+           mismatch_count, (double) tolerance, is_within_tolerance ? "ok" : "FAILED");
+
+    // a long soak run, one rally ends each time the ball is hit or served
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    game.player1_ai_gain = gain1;
+
+    uint64_t tick_count = 0;
+    uint64_t rallies = 0;
+    uint64_t time_start = time_now_ns();
+    while (rallies < rally_count)
+    {
+        PlayerMode const mode = game.player_mode;
+        Game_step_match(&game, dt);
+        ++tick_count;
+        rallies += Game_is_rally_over(mode, game.player_mode);
+    }
+    double const tick_seconds = (double) (time_now_ns() - time_start) / 1e9;
+    printf("    per tick:     %llu rallies in %.3f s, %llu ticks, score %u:%u\n",
+           (unsigned long long) rallies, tick_seconds, (unsigned long long) tick_count,
+           game.player1.score, game.player2.score);
+
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    game.player1_ai_gain = gain1;
+
+    uint64_t call_count = 0;
+    tick_count = 0;
+    rallies = 0;
+    time_start = time_now_ns();
+    while (rallies < rally_count)
+    {
+        PlayerMode const mode = game.player_mode;
+        tick_count += Game_fast_forward(&game, dt, UINT64_MAX);
+        ++call_count;
+        rallies += Game_is_rally_over(mode, game.player_mode);
+    }
+    double const event_seconds = (double) (time_now_ns() - time_start) / 1e9;
+    printf("    event driven: %llu rallies in %.3f s, %llu ticks in %llu steps, score %u:%u, %.2fx\n",
+           (unsigned long long) rallies, event_seconds, (unsigned long long) tick_count,
+           (unsigned long long) call_count, game.player1.score, game.player2.score,
+           tick_seconds / event_seconds);
+
+    return is_within_tolerance ? 0 : 1;
+}
+
+typedef void (*GameStep)(Game *game, float dt);
+
+static int compare_uint64(void const *const a, void const *const b)
+{
+    uint64_t const x = *(uint64_t const *) a;
+    uint64_t const y = *(uint64_t const *) b;
+    return (x > y) - (x < y);
+}
+
+static int compare_float(void const *const a, void const *const b)
+{
+    float const x = *(float const *) a;
+    float const y = *(float const *) b;
+    return (x > y) - (x < y);
+}
+
+// steps until the player mode changes, which happens on every hit, goal and serve
+static uint64_t Game_run_to_event(Game *const this, GameStep const step, float const dt, uint64_t const step_limit)
+{
+    PlayerMode const mode = this->player_mode;
+    uint64_t step_count = 0;
+    do
+    {
+        step(this, dt);
+        ++step_count;
+    } while (this->player_mode == mode && step_count < step_limit);
+
+    return step_count;
+}
+
+static int bench_swept(int const argc, char **const argv)
+{
+    float const fine_dt = argc > 0 ? strtof(argv[0], NULL) : 1.0f / 16.0f;
+    float const aspect_ratio = 900.0f / 600.0f;
+    float const dts[] = {1.0f, 2.0f, 4.0f, 8.0f, 10.0f};
+
+    // every event (hit, goal or serve) of many matches is played from the same state by the fine stepped
+    // reference and by the step under test, they have to agree on what happened and on the bounce it gave
+    size_t const check_count = 500;
+    int const check_event_count = 16;
+    // the reference only knows where the ball is every fine_dt, which alone is worth about 0.04
+    float const tolerance = 0.05f;
+
+    float *const bounce_errors = malloc(check_count * (size_t) check_event_count * sizeof(*bounce_errors));
+    if (bounce_errors == NULL) return 1;
+
+    printf("swept: reference is Game_update stepped at dt %g, %zu matches x %d events\n",
+           (double) fine_dt, check_count, check_event_count);
+
+    bool is_ok = true;
+    for (int swept = 0; swept < 2; ++swept)
+    {
+        GameStep const step = swept ? &Game_step_match_swept : &Game_step_match;
+
+        for (size_t dt_index = 0; dt_index < sizeof(dts) / sizeof(*dts); ++dt_index)
+        {
+            float const dt = dts[dt_index];
+            size_t mismatch_count = 0;
+            size_t event_count = 0;
+            size_t bounce_count = 0;
+
+            for (size_t i = 0; i < check_count; ++i)
+            {
+                Game reference;
+                Game_setup_random_match(&reference, (uint32_t) i + 1, aspect_ratio);
+
+                for (int event = 0; event < check_event_count; ++event)
+                {
+                    Game game = reference;
+                    PlayerMode const start_mode = reference.player_mode;
+                    Game_run_to_event(&reference, &Game_step_match, fine_dt, (uint64_t) (100000.0f / fine_dt));
+                    Game_run_to_event(&game, step, dt, (uint64_t) (100000.0f / dt));
+
+                    ++event_count;
+                    if (game.player_mode != reference.player_mode ||
+                        game.player1.score != reference.player1.score ||
+                        game.player2.score != reference.player2.score)
+                    {
+                        ++mismatch_count;
+                        continue;
+                    }
+
+                    // serves and goals have no bounce to compare
+                    bool const is_hit = (start_mode == PLAYER1_FACE || start_mode == PLAYER2_FACE) &&
+                                        (reference.player_mode == PLAYER1_FACE || reference.player_mode == PLAYER2_FACE);
+                    if (!is_hit) continue;
+
+                    // the vertical speed after a hit says where on the paddle the ball landed,
+                    // a wall bounce later in the same step can have flipped it already
+                    float const bounce_error = fabsf(fabsf(game.ball_velocity.y) - fabsf(reference.ball_velocity.y)) /
+                                               INITIAL_BALL_VELOCITY.x;
+                    bounce_errors[bounce_count++] = bounce_error;
+                }
+            }
+
+            // simulated time per second of a long run
+            Game game;
+            Game_setup_random_match(&game, 1, aspect_ratio);
+            uint64_t const step_count = (uint64_t) (1e7f / dt);
+            uint64_t const time_start = time_now_ns();
+            for (uint64_t j = 0; j < step_count; ++j)
+            {
+                step(&game, dt);
+            }
+            double const seconds = (double) (time_now_ns() - time_start) / 1e9;
+
+            // a few late saves land on a different tick of the reference, so the tail is reported apart
+            qsort(bounce_errors, bounce_count, sizeof(*bounce_errors), &compare_float);
+            float const median_bounce_error = bounce_errors[bounce_count / 2];
+            float const p99_bounce_error = bounce_errors[bounce_count * 99 / 100];
+
+            printf("    %-8s dt %4.1f: %5.2f%% events differ, bounce error median %.4f p99 %.4f, "
+                   "%7.1f M time units/s, %5.1f ns/step\n",
+                   swept ? "swept" : "per tick", (double) dt,
+                   100.0 * (double) mismatch_count / (double) event_count,
+                   (double) median_bounce_error, (double) p99_bounce_error,
+                   (double) step_count * (double) dt / seconds / 1e6, seconds * 1e9 / (double) step_count);
+
+            if (swept && (mismatch_count * 100 > event_count || p99_bounce_error > tolerance)) is_ok = false;
+        }
+    }
+
+    free(bounce_errors);
+
+    printf("    swept within 1%% differing events and a p99 bounce error of %g: %s\n",
+           (double) tolerance, is_ok ? "ok" : "FAILED");
+    return is_ok ? 0 : 1;
+}
+
+// drives a match through FixedStep with the frame times of a jittery renderer that hitches now and then,
+// the simulation has to end up exactly where stepping it directly the same number of times does
+static int bench_fixed_step(int const argc, char **const argv)
+{
+    uint32_t const hz = argc > 0 ? (uint32_t) strtoul(argv[0], NULL, 10) : FIXED_STEP_HZ;
+    size_t const frame_count = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000u;
+    float const aspect_ratio = 900.0f / 600.0f;
+
+    FixedStep clock;
+    FixedStep_init(&clock, hz);
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    GameSnapshot previous = Game_snapshot(&game);
+    GameSnapshot current = previous;
+
+    srand(1);
+    uint64_t frame_time_total_ns = 0;
+    uint64_t sim_time_total_ns = 0;
+    uint64_t sim_time_max_ns = 0;
+    uint32_t steps_min = UINT32_MAX;
+    uint32_t steps_max = 0;
+    float ball_x_total = 0.0f;
+
+    for (size_t i = 0; i < frame_count; ++i)
+    {
+        // mostly 60 and 144 hz frames with some jitter, a few slow frames and a rare long hitch
+        int const kind = rand() % 100;
+        uint64_t const frame_ns =
+            kind < 60 ? 16666667u + (uint64_t) (rand() % 4000000) - 2000000u :
+            kind < 90 ? 6944444u + (uint64_t) (rand() % 1000000) - 500000u :
+            kind < 99 ? 33333333u :
+            250000000u;
+        frame_time_total_ns += frame_ns;
+
+        uint64_t const time_start = time_now_ns();
+        uint32_t const step_count = FixedStep_advance(&clock, frame_ns);
+        for (uint32_t step = 0; step < step_count; ++step)
+        {
+            previous = current;
+            Game_step_match_swept(&game, clock.dt);
+            current = Game_snapshot(&game);
+        }
+
+        GameSnapshot const snapshot = GameSnapshot_lerp(&previous, &current, FixedStep_alpha(&clock));
+        uint64_t const time_elapsed = time_now_ns() - time_start;
+
+        // keeps the interpolation from being optimized away
+        ball_x_total += snapshot.ball_position.x;
+
+        sim_time_total_ns += time_elapsed;
+        sim_time_max_ns = time_elapsed > sim_time_max_ns ? time_elapsed : sim_time_max_ns;
+        steps_min = step_count < steps_min ? step_count : steps_min;
+        steps_max = step_count > steps_max ? step_count : steps_max;
+    }
+
+    Game direct;
+    Game_setup_random_match(&direct, 1, aspect_ratio);
+    for (uint64_t i = 0; i < clock.step_count; ++i)
+    {
+        Game_step_match_swept(&direct, clock.dt);
+    }
+
+    bool const is_identical = Game_equal(&game, &direct) && game.player1.score == direct.player1.score &&
+                              game.player2.score == direct.player2.score;
+
+    printf("fixed step: %u hz (dt %g), %zu frames over %.1f s, %llu steps, score %u:%u\n",
+           hz, (double) clock.dt, frame_count, (double) frame_time_total_ns / 1e9,
+           (unsigned long long) clock.step_count, game.player1.score, game.player2.score);
+    printf("    steps per frame min %u avg %.2f max %u, %.1f s dropped by hitches\n",
+           steps_min, (double) clock.step_count / (double) frame_count, steps_max,
+           (double) clock.dropped_ns / 1e9);
+    printf("    simulation per frame avg %.0f ns max %llu ns, mean interpolated ball x %.3f\n",
+           (double) sim_time_total_ns / (double) frame_count, (unsigned long long) sim_time_max_ns,
+           (double) (ball_x_total / (float) frame_count));
+    printf("    identical to %llu direct steps: %s\n",
+           (unsigned long long) clock.step_count, is_identical ? "ok" : "FAILED");
+
+    return is_identical ? 0 : 1;
+}
+
+// what a clock read costs and how far the calibrated tsc clock ends up from the os clock
+static int bench_timing(int const argc, char **const argv)
+{
+    double const drift_seconds = argc > 0 ? strtod(argv[0], NULL) : 3.0;
+    uint64_t const read_count = 10000000u;
+
+    printf("timing: invariant tsc %s, %s clock, tsc %.3f MHz\n",
+           time_has_invariant_tsc() ? "yes" : "no", time_clock.is_tsc ? "tsc" : "os",
+           time_clock.tsc_frequency / 1e6);
+
+    // the sum keeps the reads from being optimized away
+    uint64_t sum = 0;
+    uint64_t time_start = time_os_ns();
+    for (uint64_t i = 0; i < read_count; ++i) sum += time_now_ns();
+    double const now_ns = (double) (time_os_ns() - time_start) / (double) read_count;
+
+    time_start = time_os_ns();
+    for (uint64_t i = 0; i < read_count; ++i) sum += time_os_ns();
+    double const os_ns = (double) (time_os_ns() - time_start) / (double) read_count;
+
+    time_start = time_os_ns();
+    for (uint64_t i = 0; i < read_count; ++i) sum += __rdtsc();
+    double const rdtsc_ns = (double) (time_os_ns() - time_start) / (double) read_count;
+
+    printf("    read cost: time_now_ns %.1f ns, time_os_ns %.1f ns, rdtsc %.1f ns (%llu)\n",
+           now_ns, os_ns, rdtsc_ns, (unsigned long long) (sum & 1));
+
+    if (!time_clock.is_tsc) return 0;
+
+    // compare against the os clock every 100 ms while FrameClock style calibration runs once a second
+    int64_t max_error = 0;
+    int64_t last_error = 0;
+    uint64_t previous = time_now_ns();
+    bool is_monotonic = true;
+    uint64_t const drift_end = time_os_ns() + (uint64_t) (drift_seconds * 1e9);
+    uint64_t next_calibration = time_os_ns() + FRAME_CLOCK_CALIBRATE_NS;
+    while (time_os_ns() < drift_end)
+    {
+        uint64_t const sample_end = time_os_ns() + 100000000u;
+        while (time_os_ns() < sample_end)
+        {
+            uint64_t const now = time_now_ns();
+            is_monotonic &= now >= previous;
+            previous = now;
+        }
+
+        uint64_t tsc = 0;
+        uint64_t os_ns_now = 0;
+        time_sample(&tsc, &os_ns_now);
+        last_error = (int64_t) (os_ns_now - TimeCalibration_ns(&time_clock.calibrations[time_clock.current], tsc));
+        max_error = llabs(last_error) > max_error ? llabs(last_error) : max_error;
+
+        if (os_ns_now >= next_calibration)
+        {
+            time_calibrate();
+            next_calibration = os_ns_now + FRAME_CLOCK_CALIBRATE_NS;
+        }
+    }
+
+    printf("    over %.1f s: max error %lld ns, last error %lld ns, tsc %.3f MHz, monotonic %s\n",
+           drift_seconds, (long long) max_error, (long long) last_error, time_clock.tsc_frequency / 1e6,
+           is_monotonic ? "ok" : "FAILED");
+
+    // a correction of a millisecond, then nothing calibrates again like while main.c waits minimized. the
+    // slew has to end after TIME_SLEW_NS instead of running the clock fast until the next calibration
+    uint32_t const current = atomic_load(&time_clock.current);
+    TimeCalibration const saved = time_clock.calibrations[current];
+    time_clock.calibrations[current].ns -= 1000000u;
+    time_clock.calibrations[current].slew_end_ns -= 1000000u;
+    time_calibrate();
+
+    uint64_t tsc = 0;
+    uint64_t os_ns_now = 0;
+    thread_sleep_ns(2 * (uint64_t) TIME_SLEW_NS);
+    time_sample(&tsc, &os_ns_now);
+    int64_t const slewed_error = (int64_t) (os_ns_now - TimeCalibration_ns(&time_clock.calibrations[time_clock.current], tsc));
+    bool const is_slew_bounded = llabs(slewed_error) < 100000;
+    printf("    1 ms off, then %.1f s without calibrating: error %lld ns, slew ended %s\n",
+           2.0 * TIME_SLEW_NS / 1e9, (long long) slewed_error, is_slew_bounded ? "ok" : "FAILED");
+    time_clock.calibrations[current] = saved;
+    atomic_store(&time_clock.current, current);
+
+    return is_monotonic && is_slew_bounded ? 0 : 1;
+}
+
+// runs the simulation thread while this thread plays a renderer that presents at 60 hz and now and then
+// stalls, the simulation has to keep its rate through the stalls and end up where direct stepping does
+static int bench_simulation_thread(int const argc, char **const argv)
+{
+    uint32_t const hz = argc > 0 ? (uint32_t) strtoul(argv[0], NULL, 10) : SIMULATION_HZ;
+    double const seconds = argc > 1 ? strtod(argv[1], NULL) : 3.0;
+    float const aspect_ratio = 900.0f / 600.0f;
+
+    static Simulation simulation;
+    Game_setup_random_match(&simulation.game, 1, aspect_ratio);
+    if (!Simulation_start(&simulation, hz))
+    {
+        fprintf(stderr, "could not start the simulation thread\n");
+        return 1;
+    }
+
+    uint64_t const time_start = time_now_ns();
+    uint64_t const time_end = time_start + (uint64_t) (seconds * 1e9);
+    uint64_t frame_count = 0;
+    uint64_t new_count = 0;
+    uint64_t last_step = 0;
+    uint64_t max_step_gap = 0;
+    bool is_in_order = true;
+
+    while (time_now_ns() < time_end)
+    {
+        if (TripleBuffer_acquire(&simulation.snapshots))
+        {
+            uint64_t const step = TripleBuffer_front(&simulation.snapshots)->step;
+            is_in_order &= step > last_step;
+            max_step_gap = step - last_step > max_step_gap ? step - last_step : max_step_gap;
+            last_step = step;
+            ++new_count;
+        }
+
+        // every 30th frame the present takes 100 ms instead of a 60 hz frame
+        ++frame_count;
+        thread_sleep_ns(frame_count % 30 == 0 ? 100000000u : 16666667u);
+    }
+
+    Simulation_stop(&simulation);
+    double const elapsed = (double) (time_now_ns() - time_start) / 1e9;
+
+    Game direct;
+    Game_setup_random_match(&direct, 1, aspect_ratio);
+    for (uint64_t i = 0; i < simulation.clock.step_count; ++i)
+    {
+        Game_step_match_swept(&direct, simulation.clock.dt);
+    }
+    bool const is_identical = Game_equal(&simulation.game, &direct);
+
+    printf("simulation thread: %u hz for %.2f s, %llu steps (%.0f per second), %.1f ms dropped\n",
+           hz, elapsed, (unsigned long long) simulation.clock.step_count,
+           (double) simulation.clock.step_count / elapsed, (double) simulation.clock.dropped_ns / 1e6);
+    printf("    renderer: %llu frames, %llu new snapshots, up to %llu steps between them, in order %s\n",
+           (unsigned long long) frame_count, (unsigned long long) new_count, (unsigned long long) max_step_gap,
+           is_in_order ? "ok" : "FAILED");
+    printf("    steps ran up to %.3f ms late, identical to direct stepping: %s\n",
+           (double) simulation.max_late_ns / 1e6, is_identical ? "ok" : "FAILED");
+
+    return is_in_order && is_identical ? 0 : 1;
+}
+
+// how old the newest mouse move a presented frame shows is, see Input_presented. this thread plays the window
+// thread of main.c: while it blocks in the present a few mouse moves arrive at random times and wait in the
+// platform queue, then it pumps them into the ring, stamped with the time they arrived, and draws right away.
+// the simulation has not stepped with them yet then, so a frame drawn from the snapshot shows the moves of the
+// frame before, and late latching shows the newest
+static int bench_latency(int const argc, char **const argv)
+{
+    uint64_t const frame_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 300u;
+    uint32_t const hz = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : SIMULATION_HZ;
+    uint64_t const frame_ns = 16666667u;
+    int const moves_per_frame = 4;
+
+    static Simulation simulation;
+    Game_setup_random_match(&simulation.game, 1, 900.0f / 600.0f);
+    simulation.game.player1_ai_gain = 0.0f;
+    if (!Simulation_start(&simulation, hz))
+    {
+        fprintf(stderr, "could not start the simulation thread\n");
+        return 1;
+    }
+
+    // the newest mouse move each way of drawing showed
+    static LatencyStats stats[2];
+    uint32_t presented_count[2] = {0};
+
+    srand(1);
+    uint64_t frame_start = time_now_ns();
+    for (uint64_t frame = 0; frame < frame_count; ++frame)
+    {
+        uint64_t const frame_end = frame_start + frame_ns;
+
+        uint64_t move_times[4];
+        for (int i = 0; i < moves_per_frame; ++i)
+        {
+            move_times[i] = frame_start + (uint64_t) rand() % frame_ns;
+        }
+        qsort(move_times, (size_t) moves_per_frame, sizeof(*move_times), &compare_uint64);
+
+        // the present blocks until the end of the frame
+        uint64_t const now = time_now_ns();
+        if (frame_end > now) thread_sleep_ns(frame_end - now);
+
+        for (int i = 0; i < moves_per_frame; ++i)
+        {
+            Input_mouse(&simulation.input, (float) (rand() % 1000) / 1000.0f, move_times[i]);
+        }
+        Simulation_wake(&simulation);
+
+        // what a frame would draw
+        TripleBuffer_acquire(&simulation.snapshots);
+        GameSnapshot snapshot = *TripleBuffer_front(&simulation.snapshots);
+        uint32_t const shown_count[2] = {snapshot.input_count, Simulation_latch_mouse(&simulation, &snapshot)};
+
+        uint64_t const present_ns = time_now_ns();
+        for (int way = 0; way < 2; ++way)
+        {
+            if (shown_count[way] == presented_count[way]) continue;
+            presented_count[way] = shown_count[way];
+
+            uint64_t const time_ns = Input_mouse_time_ns(&simulation.input, shown_count[way]);
+            if (time_ns != 0) LatencyStats_add(&stats[way], present_ns - time_ns);
+        }
+
+        frame_start = frame_end;
+    }
+
+    Simulation_stop(&simulation);
+
+    char line[128];
+    printf("latency: %llu frames at 60 hz, simulation at %u hz, %d mouse moves per frame\n",
+           (unsigned long long) frame_count, hz, moves_per_frame);
+    LatencyStats_format(&stats[0], "    from snapshot", line);
+    fputs(line, stdout);
+    LatencyStats_format(&stats[1], "    late latched ", line);
+    fputs(line, stdout);
+
+    return 0;
+}
+
+// a scripted stream of platform events, the ones that arrived by now can be pumped
+typedef struct InputScript
+{
+    InputEvent *events;
+    size_t count;
+    size_t next;
+    Input *input;
+} InputScript;
+
+static bool InputScript_pump(void *const context)
+{
+    InputScript *const this = context;
+    if (this->next == this->count || this->events[this->next].time_ns > time_now_ns()) return false;
+
+    // the event keeps the time it arrived in the platform queue, so waiting there counts as latency
+    Input_push(this->input, this->events[this->next++]);
+    return true;
+}
+
+// plays a synthetic event stream through Input at 60 hz, once pumping a single event per frame like
+// the loop did before and once draining everything within the budget
+static int bench_input(int const argc, char **const argv)
+{
+    size_t const frame_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 120u;
+    size_t const burst_size = argc > 1 ? strtoull(argv[1], NULL, 10) : 200u;
+    uint64_t const frame_ns = 16666667u;
+
+    // a 1 khz mouse, a burst of moves every 10th frame and the up arrow going down and up now and then
+    size_t const capacity = frame_count * (17 + burst_size + 2);
+    InputEvent *const events = malloc(capacity * sizeof(*events));
+    if (events == NULL) return 1;
+
+    printf("input: %zu frames at 60 hz, 1 khz mouse, a burst of %zu moves every 10th frame\n",
+           frame_count, burst_size);
+
+    bool is_ok = true;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        uint64_t const time_start = time_now_ns() + frame_ns;
+        size_t count = 0;
+        bool is_key_down = false;
+        float last_height = 0.0f;
+        srand(1);
+        for (size_t frame = 0; frame < frame_count; ++frame)
+        {
+            uint64_t const frame_start = time_start + frame * frame_ns;
+            for (uint64_t ms = 0; ms < 16; ++ms)
+            {
+                last_height = (float) (rand() % 1000) / 1000.0f;
+                events[count++] = (InputEvent) {
+                    .time_ns = frame_start + ms * 1000000u, .type = INPUT_EVENT_MOUSE_MOVE, .mouse_height = last_height,
+                };
+            }
+
+            if (frame % 10 == 5)
+            {
+                for (size_t i = 0; i < burst_size; ++i)
+                {
+                    last_height = (float) (rand() % 1000) / 1000.0f;
+                    events[count++] = (InputEvent) {
+                        .time_ns = frame_start + 16000000u + i, .type = INPUT_EVENT_MOUSE_MOVE,
+                        .mouse_height = last_height,
+                    };
+                }
+            }
+
+            if (frame % 7 == 3)
+            {
+                is_key_down ^= 1;
+                events[count++] = (InputEvent) {
+                    .time_ns = frame_start + 16500000u, .type = is_key_down ? INPUT_EVENT_KEY_DOWN : INPUT_EVENT_KEY_UP,
+                    .key = KEY_UP,
+                };
+            }
+        }
+
+        static Simulation simulation;
+        simulation = (Simulation) {0};
+        Input *const input = &simulation.input;
+        InputScript script = {.events = events, .count = count, .input = input};
+        uint64_t const budget_ns = mode == 0 ? 0 : INPUT_PUMP_BUDGET_NS;
+
+        for (size_t frame = 0; frame < frame_count; ++frame)
+        {
+            uint64_t const frame_end = time_start + (frame + 1) * frame_ns;
+            uint64_t const now = time_now_ns();
+            if (frame_end > now) thread_sleep_ns(frame_end - now);
+
+            // the simulation is not running, this thread plays both sides of the ring
+            Input_pump(input, &InputScript_pump, &script, budget_ns);
+            Simulation_consume_input(&simulation, UINT64_MAX);
+        }
+
+        char line[128];
+        LatencyStats_format(&input->queue_latency, mode == 0 ? "    one per frame" : "    drain all    ", line);
+        fputs(line, stdout);
+        printf("        queue depth avg %.1f max %u, %llu merged, %llu dropped, longest pump %.3f ms, "
+               "%zu events still waiting\n",
+               (double) input->depth_total / (double) input->consume_count, input->max_depth,
+               (unsigned long long) input->merged_count, (unsigned long long) input->dropped_count,
+               (double) input->max_pump_ns / 1e6, script.count - script.next);
+
+        if (mode == 1)
+        {
+            // everything arrived, so the simulation has to hold the last of it
+            bool const is_key_right = KeyBitmap_get(simulation.game.keys, KEY_UP) == is_key_down;
+            bool const is_mouse_right =
+                simulation.game.player1.pos.y == fclamp(last_height, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+            bool const is_complete = script.next == script.count && is_key_right && is_mouse_right;
+            printf("        final key and mouse state delivered: %s\n", is_complete ? "ok" : "FAILED");
+            is_ok &= is_complete;
+        }
+    }
+
+    // events handled outside of Input_pump, like in a modal loop, with the ring full and nobody popping.
+    // the moves are merged but both key events have to come through, in order
+    static Input full;
+    full = (Input) {0};
+    int const pushed[] = {INPUT_EVENT_KEY_DOWN, INPUT_EVENT_MOUSE_MOVE, INPUT_EVENT_MOUSE_MOVE, INPUT_EVENT_KEY_UP,
+                          INPUT_EVENT_MOUSE_MOVE};
+    for (uint32_t i = 0; i < INPUT_QUEUE_SIZE; ++i) Input_mouse(&full, 0.5f, i);
+    for (size_t i = 0; i < sizeof(pushed) / sizeof(*pushed); ++i)
+    {
+        if (pushed[i] == INPUT_EVENT_MOUSE_MOVE) Input_mouse(&full, 0.25f, INPUT_QUEUE_SIZE + i);
+        else Input_key(&full, KEY_UP, pushed[i] == INPUT_EVENT_KEY_DOWN, INPUT_QUEUE_SIZE + i);
+    }
+
+    InputEvent event;
+    int popped[8];
+    size_t popped_count = 0;
+    for (uint32_t i = 0; i < INPUT_QUEUE_SIZE; ++i) Input_try_pop(&full, &event);
+    Input_push_pending(&full);
+    while (Input_try_pop(&full, &event) && popped_count < 8) popped[popped_count++] = (int) event.type;
+
+    bool const is_key_kept = popped_count == 4 && popped[0] == INPUT_EVENT_KEY_DOWN &&
+                             popped[1] == INPUT_EVENT_MOUSE_MOVE && popped[2] == INPUT_EVENT_KEY_UP &&
+                             popped[3] == INPUT_EVENT_MOUSE_MOVE && full.dropped_count == 0;
+    printf("    full ring: %llu merged, %llu dropped, key down and up kept in order: %s\n",
+           (unsigned long long) full.merged_count, (unsigned long long) full.dropped_count,
+           is_key_kept ? "ok" : "FAILED");
+    is_ok &= is_key_kept;
+
+    free(events);
+    return is_ok ? 0 : 1;
+}
+
+typedef struct InputRingProducer
+{
+    Input *input;
+    uint64_t count;
+    uint64_t full_count;
+} InputRingProducer;
+
+// pushes count numbered events as fast as the ring takes them, waiting whenever it is full
+static void InputRingProducer_run(void *const argument)
+{
+    InputRingProducer *const this = argument;
+    for (uint64_t i = 0; i < this->count; ++i)
+    {
+        InputEvent const event = {
+            .time_ns = time_now_ns(),
+            .type = (i & 1) != 0 ? INPUT_EVENT_KEY_UP : INPUT_EVENT_KEY_DOWN,
+            .key = (int) (i & INT_MAX),
+        };
+
+        while (!Input_try_push(this->input, event))
+        {
+            ++this->full_count;
+            thread_yield();
+        }
+    }
+}
+
+// first floods the ring from a producer thread while this thread pops and checks that every event
+// arrives once and in order, then feeds a running simulation a fast mouse and a key the way the window
+// thread does and checks the simulation ends up with the last of it
+static int bench_input_ring(int const argc, char **const argv)
+{
+    uint64_t const event_count = argc > 0 ? strtoull(argv[0], NULL, 10) : 10000000u;
+    uint32_t const mouse_hz = argc > 1 ? (uint32_t) strtoul(argv[1], NULL, 10) : 8000u;
+    double const seconds = argc > 2 ? atof(argv[2]) : 2.0;
+
+    static Input input;
+    InputRingProducer producer = {.input = &input, .count = event_count};
+    static LatencyStats flood_latency;
+    uint64_t empty_count = 0;
+    uint64_t out_of_order_count = 0;
+    uint64_t latency_total_ns = 0;
+
+    uint64_t const time_start = time_now_ns();
+    Thread thread;
+    if (!Thread_create(&thread, &InputRingProducer_run, &producer))
+    {
+        fprintf(stderr, "could not start the producer thread\n");
+        return 1;
+    }
+
+    for (uint64_t i = 0; i < event_count;)
+    {
+        InputEvent event;
+        if (!Input_try_pop(&input, &event))
+        {
+            ++empty_count;
+            thread_yield();
+            continue;
+        }
+
+        uint64_t const latency_ns = time_now_ns() - event.time_ns;
+        LatencyStats_add(&flood_latency, latency_ns);
+        latency_total_ns += latency_ns;
+
+        InputEventType const type = (i & 1) != 0 ? INPUT_EVENT_KEY_UP : INPUT_EVENT_KEY_DOWN;
+        out_of_order_count += event.key != (int) (i & INT_MAX) || event.type != type;
+        ++i;
+    }
+
+    uint64_t const time_end = time_now_ns();
+    Thread_join(&thread);
+
+    bool const is_flood_ok = out_of_order_count == 0 && Input_depth(&input) == 0;
+    double const elapsed = (double) (time_end - time_start) / 1e9;
+    printf("inputring: %u slots, %d hardware threads\n", INPUT_QUEUE_SIZE, thread_hardware_count());
+    printf("    flood: %llu events in %.3f s, %.1f million events/s, %llu out of order or missing: %s\n",
+           (unsigned long long) event_count, elapsed, (double) event_count / elapsed / 1e6,
+           (unsigned long long) out_of_order_count, is_flood_ok ? "ok" : "FAILED");
+    printf("        push to pop avg %.0f ns, producer found it full %llu times, consumer found it empty %llu times\n",
+           (double) latency_total_ns / (double) event_count,
+           (unsigned long long) producer.full_count, (unsigned long long) empty_count);
+    char line[128];
+    LatencyStats_format(&flood_latency, "        push to pop", line);
+    fputs(line, stdout);
+
+    // the simulation pops at its own rate while this thread pushes a paced mouse and now and then a key
+    static Simulation simulation;
+    Game_setup_random_match(&simulation.game, 1, 900.0f / 600.0f);
+    simulation.game.player1_ai_gain = 0.0f;
+    if (!Simulation_start(&simulation, SIMULATION_HZ))
+    {
+        fprintf(stderr, "could not start the simulation thread\n");
+        return 1;
+    }
+
+    uint64_t const move_count = (uint64_t) (seconds * (double) mouse_hz);
+    uint64_t const move_ns = 1000000000u / mouse_hz;
+    bool is_key_down = false;
+    float last_height = 0.0f;
+    srand(1);
+    uint64_t const paced_start = time_now_ns();
+    for (uint64_t i = 0; i < move_count; ++i)
+    {
+        uint64_t const due = paced_start + i * move_ns;
+        uint64_t const now = time_now_ns();
+        if (due > now) thread_sleep_ns(due - now);
+
+        last_height = (float) (rand() % 1000) / 1000.0f;
+        Input_mouse(&simulation.input, last_height, time_now_ns());
+        if (i % 100 == 50)
+        {
+            is_key_down ^= 1;
+            Input_key(&simulation.input, 'K', is_key_down, time_now_ns());
+        }
+    }
+
+    // give the simulation a few steps to catch up with the last events
+    thread_sleep_ns(20000000u);
+    Simulation_stop(&simulation);
+
+    Input const *const ring = &simulation.input;
+    bool const is_paced_ok =
+        simulation.mouse_count_seen == atomic_load(&ring->mouse_count) &&
+        ring->dropped_count == 0 && ring->pending_count == 0 &&
+        KeyBitmap_get(simulation.game.keys, 'K') == is_key_down &&
+        simulation.game.player1.pos.y == fclamp(last_height, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+
+    printf("    %u hz mouse into a %u hz simulation for %.1f s: %llu events, every one applied in order: %s\n",
+           mouse_hz, SIMULATION_HZ, seconds, (unsigned long long) ring->event_count, is_paced_ok ? "ok" : "FAILED");
+    printf("        queue depth avg %.1f max %u per step, %llu merged, %llu dropped\n",
+           (double) ring->depth_total / (double) ring->consume_count, ring->max_depth,
+           (unsigned long long) ring->merged_count, (unsigned long long) ring->dropped_count);
+    LatencyStats_format(&ring->queue_latency, "        push to step", line);
+    fputs(line, stdout);
+
+    return is_flood_ok && is_paced_ok ? 0 : 1;
+}
+
+// a frame in the middle of a rally, the ball just left player1 so smin blends the two, and scores with
+// one and two digits
+static ShaderConstants render_bench_constants(float const aspect_ratio)
+{
+    return (ShaderConstants) {
+        .player_size = PLAYER_SIZE,
+        .player1_position = {0.1f, 0.4f},
+        .player2_position = {aspect_ratio - 0.1f, 0.65f},
+        .ball_position = {0.1f + PLAYER_SIZE.x / 2.0f + BALL_RADIUS + 0.02f, 0.45f},
+        .ball_radius = BALL_RADIUS,
+        .aspect_ratio = aspect_ratio,
+        .player1_score = 7,
+        .player2_score = 12,
+    };
+}
+
+// fnv-1a over the pixels, to see at a glance whether two renderers or two builds draw the same frame
+static uint64_t render_hash(RenderTarget const *const target)
+{
+    uint64_t hash = 14695981039346656037u;
+    for (int y = 0; y < target->height; ++y)
+    {
+        for (int x = 0; x < target->width; ++x)
+        {
+            hash = (hash ^ target->pixels[(size_t) y * (size_t) target->pitch + (size_t) x]) * 1099511628211u;
+        }
+    }
+    return hash;
+}
+
+// writes target as a binary ppm, which most image viewers open
+static bool render_write_ppm(RenderTarget const *const target, char const *const path)
+{
+    FILE *const file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    fprintf(file, "P6\n%d %d\n255\n", target->width, target->height);
+    for (int y = 0; y < target->height; ++y)
+    {
+        for (int x = 0; x < target->width; ++x)
+        {
+            uint32_t const pixel = target->pixels[(size_t) y * (size_t) target->pitch + (size_t) x];
+            unsigned char const rgb[3] = {pixel & 0xFF, pixel >> 8 & 0xFF, pixel >> 16 & 0xFF};
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+static int const render_sizes[][2] = {{900, 600}, {1920, 1080}, {3840, 2160}};
+
+// draws the bench frame with the cpu version of ps_main at the window size, 1080p and 4k
+static int bench_render(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 3;
+    char const *const ppm_path = argc > 1 ? argv[1] : NULL;
+
+    printf("render: %d frames per size with render.h\n", frame_count);
+    for (size_t i = 0; i < sizeof(render_sizes) / sizeof(*render_sizes); ++i)
+    {
+        int const width = render_sizes[i][0];
+        int const height = render_sizes[i][1];
+        RenderTarget const target = {
+            .pixels = malloc((size_t) width * (size_t) height * sizeof(uint32_t)),
+            .width = width,
+            .height = height,
+            .pitch = width,
+        };
+        if (target.pixels == NULL) return 1;
+
+        ShaderConstants const constants = render_bench_constants((float) width / (float) height);
+        uint64_t const time_start = time_now_ns();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            render_frame(&target, &constants);
+        }
+        double const frame_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+
+        printf("    %4dx%-4d %8.2f ms per frame, %6.1f ns per pixel, hash %016llx\n",
+               width, height, frame_ms, frame_ms * 1e6 / ((double) width * (double) height),
+               (unsigned long long) render_hash(&target));
+
+        if (i == 0 && ppm_path != NULL && !render_write_ppm(&target, ppm_path))
+        {
+            fprintf(stderr, "could not write %s\n", ppm_path);
+            return 1;
+        }
+
+        free(target.pixels);
+    }
+
+    return 0;
+}
+
+// the largest difference of any color channel between two frames of the same size
+static int render_max_error(RenderTarget const *const a, RenderTarget const *const b)
+{
+    int max_error = 0;
+    for (int y = 0; y < a->height; ++y)
+    {
+        for (int x = 0; x < a->width; ++x)
+        {
+            uint32_t const pixel_a = a->pixels[(size_t) y * (size_t) a->pitch + (size_t) x];
+            uint32_t const pixel_b = b->pixels[(size_t) y * (size_t) b->pitch + (size_t) x];
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                int const error = abs((int) (pixel_a >> shift & 0xFF) - (int) (pixel_b >> shift & 0xFF));
+                max_error = error > max_error ? error : max_error;
+            }
+        }
+    }
+    return max_error;
+}
+
+// the simd kernels have to stay within this many steps of a color channel of the scalar renderer
+#define RENDER_SIMD_MAX_ERROR (1)
+
+// draws the bench frame with every kernel the cpu supports and checks them against the scalar one
+static int bench_render_simd(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 3;
+    int const width = argc > 1 ? atoi(argv[1]) : 1920;
+    int const height = argc > 2 ? atoi(argv[2]) : 1080;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    if (reference.pixels == NULL || target.pixels == NULL) return 1;
+
+    ShaderConstants const constants = render_bench_constants((float) width / (float) height);
+    RenderIsa const best_isa = render_best_isa();
+    printf("rendersimd: %dx%d, %d frames per kernel, best kernel on this cpu %s\n",
+           width, height, frame_count, RenderIsa_name(best_isa));
+
+    bool is_ok = true;
+    double scalar_ms = 0.0;
+    for (RenderIsa isa = RENDER_ISA_SCALAR; isa <= best_isa; ++isa)
+    {
+        RenderTarget const *const output = isa == RENDER_ISA_SCALAR ? &reference : &target;
+        uint64_t const time_start = time_now_ns();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            render_frame_isa(output, &constants, isa);
+        }
+        double const frame_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+        scalar_ms = isa == RENDER_ISA_SCALAR ? frame_ms : scalar_ms;
+
+        int const max_error = render_max_error(&reference, output);
+        is_ok &= max_error <= RENDER_SIMD_MAX_ERROR;
+        printf("    %-6s %8.2f ms per frame, %7.1f million pixels/s, %5.1fx scalar, max error %d: %s\n",
+               RenderIsa_name(isa), frame_ms, (double) pixel_count / frame_ms / 1e3, scalar_ms / frame_ms,
+               max_error, max_error <= RENDER_SIMD_MAX_ERROR ? "ok" : "FAILED");
+    }
+
+    free(reference.pixels);
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// frames are checked at a size that is not a multiple of any tile or block size
+#define RENDER_CHECK_WIDTH (901)
+#define RENDER_CHECK_HEIGHT (601)
+
+// the frames of a check, the ball goes through both paddles, the middle line and the scores on its way
+#define RENDER_CHECK_SWEEP_COUNT (65)
+
+// draws a frame the way a bench wants to check against render_frame_isa
+typedef void (*RenderCheckDraw)(void *context, RenderTarget const *target, ShaderConstants const *constants,
+                                RenderIsa isa);
+
+static void render_check_sweep(ShaderConstants frames[RENDER_CHECK_SWEEP_COUNT])
+{
+    float const aspect_ratio = (float) RENDER_CHECK_WIDTH / (float) RENDER_CHECK_HEIGHT;
+    for (int i = 0; i < RENDER_CHECK_SWEEP_COUNT; ++i)
+    {
+        float const t = (float) i / (float) (RENDER_CHECK_SWEEP_COUNT - 1);
+        frames[i] = render_bench_constants(aspect_ratio);
+        frames[i].ball_position = (float2) {aspect_ratio * t, 0.4f + 0.55f * t};
+        frames[i].player2_score = (uint32_t) i * 1573u;
+    }
+}
+
+// draws every frame with draw and with render_frame_isa at RENDER_CHECK_WIDTHxRENDER_CHECK_HEIGHT into buffers of
+// its own and returns the largest error, or INT_MAX when it could not allocate them
+static int render_check_frames(ShaderConstants const *const frames, int const frame_count, RenderIsa const isa,
+                               RenderCheckDraw const draw, void *const context)
+{
+    size_t const pixel_count = (size_t) RENDER_CHECK_WIDTH * (size_t) RENDER_CHECK_HEIGHT;
+    RenderTarget const reference = {
+        .pixels = malloc(pixel_count * sizeof(uint32_t)),
+        .width = RENDER_CHECK_WIDTH,
+        .height = RENDER_CHECK_HEIGHT,
+        .pitch = RENDER_CHECK_WIDTH,
+    };
+    RenderTarget const target = {
+        .pixels = malloc(pixel_count * sizeof(uint32_t)),
+        .width = RENDER_CHECK_WIDTH,
+        .height = RENDER_CHECK_HEIGHT,
+        .pitch = RENDER_CHECK_WIDTH,
+    };
+
+    int max_error = INT_MAX;
+    if (reference.pixels != NULL && target.pixels != NULL)
+    {
+        max_error = 0;
+        for (int i = 0; i < frame_count; ++i)
+        {
+            render_frame_isa(&reference, &frames[i], isa);
+            draw(context, &target, &frames[i], isa);
+            int const error = render_max_error(&reference, &target);
+            max_error = error > max_error ? error : max_error;
+        }
+    }
+
+    free(reference.pixels);
+    free(target.pixels);
+    return max_error;
+}
+
+static void render_check_draw_pool(void *const context, RenderTarget const *const target,
+                                   ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderPool_draw(context, target, constants, isa);
+}
+
+// draws frames at 4k with the tiled renderer on 1, 2, 4 ... threads. before that every ball position of a
+// sweep across a frame whose size is not a multiple of the tile size has to come out exactly like render_frame_isa
+static int bench_render_tiles(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 10;
+    int const max_thread_count = argc > 1 && atoi(argv[1]) > 0 ? atoi(argv[1]) : thread_hardware_count();
+    int const width = 3840;
+    int const height = 2160;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderPool *const pool = malloc(sizeof(RenderPool));
+    if (reference.pixels == NULL || target.pixels == NULL || pool == NULL) return 1;
+
+    RenderIsa const isa = render_best_isa();
+    printf("rendertiles: %dx%d, %d frames, %s kernel, %dx%d tiles, up to %d threads on %d cores\n",
+           width, height, frame_count, RenderIsa_name(isa), RENDER_TILE_SIZE, RENDER_TILE_SIZE,
+           max_thread_count, thread_hardware_count());
+
+    bool is_ok = true;
+
+    {
+        ShaderConstants frames[RENDER_CHECK_SWEEP_COUNT];
+        render_check_sweep(frames);
+
+        RenderPool_start(pool, max_thread_count);
+        int const max_error = render_check_frames(frames, RENDER_CHECK_SWEEP_COUNT, isa, render_check_draw_pool, pool);
+        RenderPool_stop(pool);
+
+        is_ok &= max_error == 0;
+        printf("    %d frames at %dx%d against the full frame kernel, max error %d: %s\n", RENDER_CHECK_SWEEP_COUNT,
+               RENDER_CHECK_WIDTH, RENDER_CHECK_HEIGHT, max_error, max_error == 0 ? "ok" : "FAILED");
+    }
+
+    ShaderConstants const constants = render_bench_constants((float) width / (float) height);
+
+    uint64_t time_start = time_now_ns();
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        render_frame_isa(&reference, &constants, isa);
+    }
+    double const full_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+    printf("    full frame %8.2f ms per frame\n", full_ms);
+
+    double single_ms = 0.0;
+    for (int thread_count = 1;; thread_count *= 2)
+    {
+        if (thread_count > max_thread_count) thread_count = max_thread_count;
+
+        int const started_count = RenderPool_start(pool, thread_count);
+        time_start = time_now_ns();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            RenderPool_draw(pool, &target, &constants, isa);
+        }
+        double const frame_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+        RenderPool_stop(pool);
+
+        single_ms = started_count == 1 ? frame_ms : single_ms;
+        int const max_error = render_max_error(&reference, &target);
+        is_ok &= max_error == 0;
+        printf("    %3d threads %8.2f ms per frame, %5.2fx 1 thread, %5.2fx full frame, "
+               "%u tiles shaded, %u empty, max error %d: %s\n",
+               started_count, frame_ms, single_ms / frame_ms, full_ms / frame_ms,
+               pool->stats.shaded_count, pool->stats.empty_count, max_error, max_error == 0 ? "ok" : "FAILED");
+
+        if (thread_count == max_thread_count) break;
+    }
+
+    free(pool);
+    free(reference.pixels);
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// the constants main.c fills in from a snapshot
+static ShaderConstants render_snapshot_constants(GameSnapshot const *const snapshot, float const aspect_ratio)
+{
+    return (ShaderConstants) {
+        .player_size = PLAYER_SIZE,
+        .player1_position = snapshot->player1_position,
+        .player2_position = snapshot->player2_position,
+        .ball_position = snapshot->ball_position,
+        .ball_radius = BALL_RADIUS,
+        .aspect_ratio = aspect_ratio,
+        .player1_score = snapshot->player1_score,
+        .player2_score = snapshot->player2_score,
+    };
+}
+
+// records an ai vs ai match at 60 frames per second, then draws every frame of it once in full and once
+// incrementally with render_dirty.h and checks both come out the same
+static int bench_render_dirty(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 600;
+    int const width = argc > 1 ? atoi(argv[1]) : 1920;
+    int const height = argc > 2 ? atoi(argv[2]) : 1080;
+    float const aspect_ratio = (float) width / (float) height;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    GameSnapshot *const recording = malloc((size_t) frame_count * sizeof(GameSnapshot));
+    if (reference.pixels == NULL || target.pixels == NULL || recording == NULL) return 1;
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        Game_step_match_swept(&game, (float) GAME_UNITS_PER_SECOND / 60.0f);
+        recording[frame] = Game_snapshot(&game);
+    }
+
+    RenderIsa const isa = render_best_isa();
+    printf("renderdirty: %dx%d, %d recorded frames at 60 hz, %s kernel\n",
+           width, height, frame_count, RenderIsa_name(isa));
+
+    RenderDirty dirty = {0};
+    uint64_t full_ns = 0;
+    uint64_t dirty_ns = 0;
+    uint64_t shaded_count = 0;
+    uint64_t rect_count = 0;
+    int full_redraw_count = 0;
+    int max_error = 0;
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        ShaderConstants const constants = render_snapshot_constants(&recording[frame], aspect_ratio);
+
+        uint64_t const time_start = time_now_ns();
+        render_frame_isa(&reference, &constants, isa);
+        uint64_t const time_middle = time_now_ns();
+        shaded_count += RenderDirty_draw(&dirty, &target, &constants, isa);
+        dirty_ns += time_now_ns() - time_middle;
+        full_ns += time_middle - time_start;
+
+        rect_count += (uint64_t) dirty.rect_count;
+        full_redraw_count += dirty.was_full;
+
+        int const error = render_max_error(&reference, &target);
+        max_error = error > max_error ? error : max_error;
+    }
+
+    double const full_ms = (double) full_ns / 1e6 / frame_count;
+    double const dirty_ms = (double) dirty_ns / 1e6 / frame_count;
+    printf("    full        %8.3f ms per frame, %9.0f pixels shaded per frame\n", full_ms, (double) pixel_count);
+    printf("    incremental %8.3f ms per frame, %9.0f pixels shaded per frame, %.1f rects, %d full redraws\n",
+           dirty_ms, (double) shaded_count / frame_count, (double) rect_count / frame_count, full_redraw_count);
+    printf("    %.1fx less shading, %.1fx faster, max error %d: %s\n",
+           (double) pixel_count * frame_count / (double) shaded_count, full_ms / dirty_ms,
+           max_error, max_error == 0 ? "ok" : "FAILED");
+
+    free(recording);
+    free(reference.pixels);
+    free(target.pixels);
+    return max_error == 0 ? 0 : 1;
+}
+
+static void render_check_draw_score(void *const context, RenderTarget const *const target,
+                                    ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScoreCache_draw_frame(context, target, constants, isa);
+}
+
+// draws the bench frame with every kernel with and without the score cache of render_score.h. before that
+// frames with scores of up to 10 digits have to come out the same both ways
+static int bench_render_score(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 3;
+    int const width = argc > 1 ? atoi(argv[1]) : 1920;
+    int const height = argc > 2 ? atoi(argv[2]) : 1080;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    if (reference.pixels == NULL || target.pixels == NULL) return 1;
+
+    RenderIsa const best_isa = render_best_isa();
+    printf("renderscore: %dx%d, %d frames per kernel\n", width, height, frame_count);
+
+    bool is_ok = true;
+    RenderScoreCache cache = {0};
+
+    {
+        static uint32_t const scores[][2] = {
+            {0, 0}, {9, 10}, {99, 100}, {12345, 7}, {999999999, 1000000000}, {0, UINT32_MAX},
+        };
+        int const score_count = (int) (sizeof(scores) / sizeof(*scores));
+        ShaderConstants frames[sizeof(scores) / sizeof(*scores)];
+        for (int i = 0; i < score_count; ++i)
+        {
+            frames[i] = render_bench_constants((float) RENDER_CHECK_WIDTH / (float) RENDER_CHECK_HEIGHT);
+            frames[i].player1_score = scores[i][0];
+            frames[i].player2_score = scores[i][1];
+        }
+
+        int max_error = 0;
+        for (RenderIsa isa = RENDER_ISA_SCALAR; isa <= best_isa; ++isa)
+        {
+            int const error = render_check_frames(frames, score_count, isa, render_check_draw_score, &cache);
+            max_error = error > max_error ? error : max_error;
+        }
+
+        is_ok &= max_error == 0;
+        printf("    %d pairs of scores at %dx%d with every kernel, max error %d: %s\n", score_count,
+               RENDER_CHECK_WIDTH, RENDER_CHECK_HEIGHT, max_error, max_error == 0 ? "ok" : "FAILED");
+    }
+
+    ShaderConstants const constants = render_bench_constants((float) width / (float) height);
+    for (RenderIsa isa = RENDER_ISA_SCALAR; isa <= best_isa; ++isa)
+    {
+        uint64_t time_start = time_now_ns();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            render_frame_isa(&reference, &constants, isa);
+        }
+        double const uncached_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+
+        // the first frame draws the images, like the first frame after a point
+        cache.update_count = 0;
+        cache.update_ns = 0;
+        cache.is_valid = false;
+        time_start = time_now_ns();
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            RenderScoreCache_draw_frame(&cache, &target, &constants, isa);
+        }
+        double const cached_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+
+        int const max_error = render_max_error(&reference, &target);
+        is_ok &= max_error == 0;
+        printf("    %-6s %8.2f ms per frame decoding digits, %8.2f ms with the cache, %5.2fx, "
+               "%llu updates of %.3f ms, max error %d: %s\n",
+               RenderIsa_name(isa), uncached_ms, cached_ms, uncached_ms / cached_ms,
+               (unsigned long long) cache.update_count, (double) cache.update_ns / 1e6 / (double) cache.update_count,
+               max_error, max_error == 0 ? "ok" : "FAILED");
+    }
+
+    RenderScoreCache_free(&cache);
+    free(reference.pixels);
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// draws the bench frame at every size of render_sizes with every kernel, with the score cache alone and
+// with the middle line of render_background.h cached as well, and reports the time saved per frame
+static int bench_render_background(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 2;
+
+    printf("renderbackground: %d frames per size and kernel, scores cached in both\n", frame_count);
+
+    bool is_ok = true;
+    for (size_t i = 0; i < sizeof(render_sizes) / sizeof(*render_sizes); ++i)
+    {
+        int const width = render_sizes[i][0];
+        int const height = render_sizes[i][1];
+        size_t const pixel_count = (size_t) width * (size_t) height;
+        RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+        RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+        if (reference.pixels == NULL || target.pixels == NULL) return 1;
+
+        ShaderConstants const constants = render_bench_constants((float) width / (float) height);
+        RenderScoreCache score_cache = {0};
+        RenderBackgroundCache background_cache = {0};
+
+        for (RenderIsa isa = RENDER_ISA_SCALAR; isa <= render_best_isa(); ++isa)
+        {
+            uint64_t time_start = time_now_ns();
+            for (int frame = 0; frame < frame_count; ++frame)
+            {
+                RenderScene scene = render_scene(&constants);
+                RenderScoreCache_update(&score_cache, &reference, &scene);
+                render_rect_isa(&reference, &scene, isa, RENDER_SHAPES_ALL, 0, 0, width, height);
+            }
+            double const dynamic_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+
+            // the first frame draws the strip, like the first frame after a resize
+            background_cache.is_valid = false;
+            background_cache.update_count = 0;
+            background_cache.update_ns = 0;
+            time_start = time_now_ns();
+            for (int frame = 0; frame < frame_count; ++frame)
+            {
+                RenderScene scene = render_scene(&constants);
+                RenderScoreCache_update(&score_cache, &target, &scene);
+                RenderBackgroundCache_update(&background_cache, &target, &scene);
+                render_rect_isa(&target, &scene, isa, RENDER_SHAPES_ALL, 0, 0, width, height);
+            }
+            double const static_ms = (double) (time_now_ns() - time_start) / 1e6 / frame_count;
+
+            int const max_error = render_max_error(&reference, &target);
+            is_ok &= max_error == 0;
+            printf("    %4dx%-4d %-6s %8.2f ms per frame, %8.2f ms with the static layer, %6.2f ms saved, "
+                   "strip %dx%d drawn in %.3f ms, max error %d: %s\n",
+                   width, height, RenderIsa_name(isa), dynamic_ms, static_ms, dynamic_ms - static_ms,
+                   background_cache.middle_line_image.x1 - background_cache.middle_line_image.x0, height,
+                   (double) background_cache.update_ns / 1e6, max_error, max_error == 0 ? "ok" : "FAILED");
+        }
+
+        RenderBackgroundCache_free(&background_cache);
+        RenderScoreCache_free(&score_cache);
+        free(reference.pixels);
+        free(target.pixels);
+    }
+
+    return is_ok ? 0 : 1;
+}
+
+// how far a frame is from the reference, the largest difference of a channel and how many pixels differ at all
+static void render_error_stats(RenderTarget const *const reference, RenderTarget const *const target,
+                               int *const max_error, uint64_t *const error_count)
+{
+    for (int y = 0; y < reference->height; ++y)
+    {
+        for (int x = 0; x < reference->width; ++x)
+        {
+            uint32_t const pixel_a = reference->pixels[(size_t) y * (size_t) reference->pitch + (size_t) x];
+            uint32_t const pixel_b = target->pixels[(size_t) y * (size_t) target->pitch + (size_t) x];
+            if (pixel_a == pixel_b) continue;
+
+            ++*error_count;
+            for (int shift = 0; shift < 32; shift += 8)
+            {
+                int const error = abs((int) (pixel_a >> shift & 0xFF) - (int) (pixel_b >> shift & 0xFF));
+                *max_error = error > *max_error ? error : *max_error;
+            }
+        }
+    }
+}
+
+// the sprites of render_sprites.h with RENDER_SPRITE_PHASES phases have to stay within this many steps of a color
+// channel of exact shading. they are up to a 32nd of a pixel off and the edges fade over a thousandth of the height,
+// which comes to about 20 steps at 600 pixels high and less above that
+#define RENDER_SPRITES_MAX_ERROR (32)
+
+// records an ai vs ai match at 60 frames per second and draws every frame of it with exact shading in full,
+// incrementally with render_dirty.h and with the sprites of render_sprites.h at 4, 8 and 16 phases, and
+// compares how long they take and how far the sprites are off. before that the avx2 blend has to agree with
+// the scalar one
+static int bench_render_sprites(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 600;
+    int const width = argc > 1 ? atoi(argv[1]) : 1920;
+    int const height = argc > 2 ? atoi(argv[2]) : 1080;
+    float const aspect_ratio = (float) width / (float) height;
+
+    static int const phase_counts[] = {4, 8, RENDER_SPRITE_PHASES};
+    enum { SPRITE_COUNT = sizeof(phase_counts) / sizeof(*phase_counts) };
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const dirty_target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget sprite_targets[SPRITE_COUNT];
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        sprite_targets[i] = (RenderTarget) {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+        if (sprite_targets[i].pixels == NULL) return 1;
+    }
+    GameSnapshot *const recording = malloc((size_t) frame_count * sizeof(GameSnapshot));
+    if (reference.pixels == NULL || dirty_target.pixels == NULL || recording == NULL) return 1;
+
+    RenderIsa const isa = render_best_isa();
+    bool is_ok = true;
+
+    {
+        static uint32_t pixels[2][1027];
+        static uint8_t masks[1027];
+        uint32_t random = 1;
+        for (int i = 0; i < 1027; ++i)
+        {
+            random = random * 1664525u + 1013904223u;
+            pixels[0][i] = pixels[1][i] = random;
+            masks[i] = (uint8_t) (i < 256 ? (uint32_t) i : random >> 24);
+        }
+
+        render_sprites_blend(pixels[0], masks, 0xFF3C00FFu, 1027);
+        bool is_same = true;
+#ifdef RENDER_HAS_SIMD
+        if (isa >= RENDER_ISA_AVX2)
+        {
+            render_sprites_blend_avx2(pixels[1], masks, 0xFF3C00FFu, 1027);
+            is_same = memcmp(pixels[0], pixels[1], sizeof(pixels[0])) == 0;
+        }
+#endif
+        is_ok &= is_same;
+        printf("rendersprites: avx2 blend against the scalar one: %s\n", is_same ? "ok" : "FAILED");
+    }
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        Game_step_match_swept(&game, (float) GAME_UNITS_PER_SECOND / 60.0f);
+        recording[frame] = Game_snapshot(&game);
+    }
+
+    printf("    %dx%d, %d recorded frames at 60 hz, %s kernel\n", width, height, frame_count, RenderIsa_name(isa));
+
+    RenderDirty dirty = {0};
+    RenderSprites sprites[SPRITE_COUNT] = {{0}};
+    uint64_t full_ns = 0;
+    uint64_t dirty_ns = 0;
+    uint64_t sprite_ns[SPRITE_COUNT] = {0};
+    uint64_t blended_count[SPRITE_COUNT] = {0};
+    uint64_t shaded_count[SPRITE_COUNT] = {0};
+    uint64_t error_count[SPRITE_COUNT] = {0};
+    int max_error[SPRITE_COUNT] = {0};
+    int dirty_max_error = 0;
+    int blend_frame_count = 0;
+    for (int i = 0; i < SPRITE_COUNT; ++i) sprites[i].phase_count = phase_counts[i];
+
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        ShaderConstants const constants = render_snapshot_constants(&recording[frame], aspect_ratio);
+        blend_frame_count += shader_variant(&constants) != SHADER_VARIANT_APART;
+
+        uint64_t time_start = time_now_ns();
+        render_frame_isa(&reference, &constants, isa);
+        full_ns += time_now_ns() - time_start;
+
+        time_start = time_now_ns();
+        RenderDirty_draw(&dirty, &dirty_target, &constants, isa);
+        dirty_ns += time_now_ns() - time_start;
+
+        int const error = render_max_error(&reference, &dirty_target);
+        dirty_max_error = error > dirty_max_error ? error : dirty_max_error;
+
+        for (int i = 0; i < SPRITE_COUNT; ++i)
+        {
+            time_start = time_now_ns();
+            if (!RenderSprites_draw(&sprites[i], &sprite_targets[i], &constants, isa)) return 1;
+            sprite_ns[i] += time_now_ns() - time_start;
+
+            blended_count[i] += sprites[i].blended_count;
+            shaded_count[i] += sprites[i].shaded_count;
+            render_error_stats(&reference, &sprite_targets[i], &max_error[i], &error_count[i]);
+        }
+    }
+
+    is_ok &= dirty_max_error == 0;
+    double const full_ms = (double) full_ns / 1e6 / frame_count;
+    double const dirty_ms = (double) dirty_ns / 1e6 / frame_count;
+    printf("    exact, full frames  %8.3f ms per frame\n", full_ms);
+    printf("    exact, incremental  %8.3f ms per frame, %5.1fx faster, max error %d: %s\n",
+           dirty_ms, full_ms / dirty_ms, dirty_max_error, dirty_max_error == 0 ? "ok" : "FAILED");
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        // the first frame draws the background in full, like the first frame after a point
+        double const sprite_ms = (double) sprite_ns[i] / 1e6 / frame_count;
+        bool const is_close = phase_counts[i] != RENDER_SPRITE_PHASES || max_error[i] <= RENDER_SPRITES_MAX_ERROR;
+        is_ok &= is_close;
+        printf("    sprites, %2d phases %8.3f ms per frame, %5.1fx faster than full, %5.1fx than incremental, "
+               "%.0f pixels blended and %.0f shaded exactly per frame, %llu masks rasterized in %.2f ms, "
+               "%.3f%% of pixels off by up to %d%s\n",
+               phase_counts[i], sprite_ms, full_ms / sprite_ms, dirty_ms / sprite_ms,
+               (double) blended_count[i] / frame_count, (double) shaded_count[i] / frame_count,
+               (unsigned long long) sprites[i].rasterized_count, (double) sprites[i].rasterize_ns / 1e6,
+               100.0 * (double) error_count[i] / ((double) pixel_count * frame_count), max_error[i],
+               phase_counts[i] != RENDER_SPRITE_PHASES ? "" : is_close ? ": ok" : ": FAILED");
+    }
+    printf("    the ball was close enough to a paddle to blend with it in %d frames\n", blend_frame_count);
+
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        RenderSprites_free(&sprites[i]);
+        free(sprite_targets[i].pixels);
+    }
+    free(recording);
+    free(reference.pixels);
+    free(dirty_target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// draws a frame of a check with the shader variant of the frame and adds up the pixels it filled in the context
+static void render_check_draw_hierarchy(void *const context, RenderTarget const *const target,
+                                        ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScene scene = render_scene(constants);
+    scene.variant = shader_variant(constants);
+
+    RenderHierarchyStats stats;
+    render_hierarchy_frame(target, &scene, isa, &stats);
+    *(uint64_t *) context += stats.filled_count;
+}
+
+// checks render_hierarchy.h against the full frame kernel on a sweep of the ball through both paddles, the middle
+// line and the scores with the shader variant of each frame, then replays an ai vs ai match with both and compares
+// how many pixels they shade and how long they take, with the 64x64 tiles of render_tiles.h on one thread for scale
+static int bench_render_hierarchy(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 300;
+    int const width = argc > 1 ? atoi(argv[1]) : 1920;
+    int const height = argc > 2 ? atoi(argv[2]) : 1080;
+    float const aspect_ratio = (float) width / (float) height;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    GameSnapshot *const recording = malloc((size_t) frame_count * sizeof(GameSnapshot));
+    RenderPool *const pool = malloc(sizeof(RenderPool));
+    if (reference.pixels == NULL || target.pixels == NULL || recording == NULL || pool == NULL) return 1;
+
+    RenderIsa const isa = render_best_isa();
+    printf("renderhierarchy: %dx%d blocks split into %dx%d, %s kernel\n", RENDER_HIERARCHY_COARSE,
+           RENDER_HIERARCHY_COARSE, RENDER_HIERARCHY_BLOCK, RENDER_HIERARCHY_BLOCK, RenderIsa_name(isa));
+
+    bool is_ok = true;
+
+    {
+        ShaderConstants frames[RENDER_CHECK_SWEEP_COUNT];
+        render_check_sweep(frames);
+
+        uint64_t filled_count = 0;
+        int const max_error =
+            render_check_frames(frames, RENDER_CHECK_SWEEP_COUNT, isa, render_check_draw_hierarchy, &filled_count);
+
+        is_ok &= max_error == 0;
+        printf("    %d frames at %dx%d against the full frame kernel, %.0f pixels filled per frame, "
+               "max error %d: %s\n", RENDER_CHECK_SWEEP_COUNT, RENDER_CHECK_WIDTH, RENDER_CHECK_HEIGHT,
+               (double) filled_count / RENDER_CHECK_SWEEP_COUNT, max_error, max_error == 0 ? "ok" : "FAILED");
+    }
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        Game_step_match_swept(&game, (float) GAME_UNITS_PER_SECOND / 60.0f);
+        recording[frame] = Game_snapshot(&game);
+    }
+
+    RenderPool_start(pool, 1);
+    RenderHierarchyStats total = {0};
+    uint64_t full_ns = 0;
+    uint64_t tiles_ns = 0;
+    uint64_t hierarchy_ns = 0;
+    uint64_t tile_count = 0;
+    int max_error = 0;
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        ShaderConstants const constants = render_snapshot_constants(&recording[frame], aspect_ratio);
+        RenderScene const scene = render_scene(&constants);
+
+        uint64_t time_start = time_now_ns();
+        render_frame_isa(&reference, &constants, isa);
+        full_ns += time_now_ns() - time_start;
+
+        time_start = time_now_ns();
+        RenderPool_draw(pool, &target, &constants, isa);
+        tiles_ns += time_now_ns() - time_start;
+        tile_count += pool->stats.shaded_count;
+
+        RenderHierarchyStats stats;
+        time_start = time_now_ns();
+        render_hierarchy_frame(&target, &scene, isa, &stats);
+        hierarchy_ns += time_now_ns() - time_start;
+
+        total.shaded_count += stats.shaded_count;
+        total.static_count += stats.static_count;
+        total.filled_count += stats.filled_count;
+        total.coarse_count += stats.coarse_count;
+        total.block_count += stats.block_count;
+
+        int const error = render_max_error(&reference, &target);
+        max_error = error > max_error ? error : max_error;
+    }
+    RenderPool_stop(pool);
+
+    is_ok &= max_error == 0;
+    double const full_ms = (double) full_ns / 1e6 / frame_count;
+    double const tiles_ms = (double) tiles_ns / 1e6 / frame_count;
+    double const hierarchy_ms = (double) hierarchy_ns / 1e6 / frame_count;
+    printf("    %dx%d, %d recorded frames at 60 hz\n", width, height, frame_count);
+    printf("    brute force %8.3f ms per frame, %9.0f pixels shaded with the moving shapes per frame\n",
+           full_ms, (double) pixel_count);
+    printf("    tiles       %8.3f ms per frame, %9.0f pixels in tiles with a moving shape per frame\n",
+           tiles_ms, (double) tile_count * RENDER_TILE_SIZE * RENDER_TILE_SIZE / frame_count);
+    printf("    hierarchy   %8.3f ms per frame, %9.0f pixels shaded with the moving shapes, %.0f with the static "
+           "ones alone and %.0f filled per frame\n", hierarchy_ms, (double) total.shaded_count / frame_count,
+           (double) total.static_count / frame_count, (double) total.filled_count / frame_count);
+    printf("                %.0f coarse blocks and %.0f blocks looked at per frame, %.1fx less shading and %.1fx faster "
+           "than brute force, %.2fx than tiles, max error %d: %s\n",
+           (double) total.coarse_count / frame_count, (double) total.block_count / frame_count,
+           (double) pixel_count * frame_count / (double) total.shaded_count, full_ms / hierarchy_ms,
+           tiles_ms / hierarchy_ms, max_error, max_error == 0 ? "ok" : "FAILED");
+
+    free(pool);
+    free(recording);
+    free(reference.pixels);
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// records an ai vs ai match at 60 frames per second and draws every frame of it with every kernel, once
+// with SHADER_VARIANT_FULL and once with the variant shader_variant picks, which has to come out the same
+static int bench_shader_variants(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 240;
+    int const width = argc > 1 ? atoi(argv[1]) : 1280;
+    int const height = argc > 2 ? atoi(argv[2]) : 720;
+    float const aspect_ratio = (float) width / (float) height;
+
+    size_t const pixel_count = (size_t) width * (size_t) height;
+    RenderTarget const reference = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    RenderTarget const target = {malloc(pixel_count * sizeof(uint32_t)), width, height, width};
+    GameSnapshot *const recording = malloc((size_t) frame_count * sizeof(GameSnapshot));
+    if (reference.pixels == NULL || target.pixels == NULL || recording == NULL) return 1;
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    int variant_counts[SHADER_VARIANT_COUNT] = {0};
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        Game_step_match_swept(&game, (float) GAME_UNITS_PER_SECOND / 60.0f);
+        recording[frame] = Game_snapshot(&game);
+
+        ShaderConstants const constants = render_snapshot_constants(&recording[frame], aspect_ratio);
+        ++variant_counts[shader_variant(&constants)];
+    }
+
+    printf("shadervariants: %dx%d, %d recorded frames at 60 hz, scores and middle line cached\n",
+           width, height, frame_count);
+    for (ShaderVariant variant = 0; variant < SHADER_VARIANT_COUNT; ++variant)
+    {
+        printf("    %-7s picked for %5.1f%% of frames\n",
+               ShaderVariant_name(variant), 100.0 * variant_counts[variant] / frame_count);
+    }
+
+    bool is_ok = true;
+    RenderScoreCache score_cache = {0};
+    RenderBackgroundCache background_cache = {0};
+    for (RenderIsa isa = RENDER_ISA_SCALAR; isa <= render_best_isa(); ++isa)
+    {
+        uint64_t full_ns[SHADER_VARIANT_COUNT] = {0};
+        uint64_t variant_ns[SHADER_VARIANT_COUNT] = {0};
+        int max_error = 0;
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            ShaderConstants const constants = render_snapshot_constants(&recording[frame], aspect_ratio);
+            RenderScene scene = render_scene(&constants);
+            RenderScoreCache_update(&score_cache, &target, &scene);
+            RenderBackgroundCache_update(&background_cache, &target, &scene);
+            ShaderVariant const variant = shader_variant(&constants);
+
+            uint64_t const time_start = time_now_ns();
+            render_rect_isa(&reference, &scene, isa, RENDER_SHAPES_ALL, 0, 0, width, height);
+            uint64_t const time_middle = time_now_ns();
+            scene.variant = variant;
+            render_rect_isa(&target, &scene, isa, RENDER_SHAPES_ALL, 0, 0, width, height);
+            variant_ns[variant] += time_now_ns() - time_middle;
+            full_ns[variant] += time_middle - time_start;
+
+            int const error = render_max_error(&reference, &target);
+            max_error = error > max_error ? error : max_error;
+        }
+
+        is_ok &= max_error == 0;
+        printf("    %-6s max error %d: %s\n", RenderIsa_name(isa), max_error, max_error == 0 ? "ok" : "FAILED");
+        for (ShaderVariant variant = 0; variant < SHADER_VARIANT_COUNT; ++variant)
+        {
+            if (variant_counts[variant] == 0) continue;
+
+            double const full_ms = (double) full_ns[variant] / 1e6 / variant_counts[variant];
+            double const variant_ms = (double) variant_ns[variant] / 1e6 / variant_counts[variant];
+            printf("        %-7s %8.3f ms per frame with full, %8.3f ms specialized, %5.2fx\n",
+                   ShaderVariant_name(variant), full_ms, variant_ms, full_ms / variant_ms);
+        }
+    }
+
+    RenderBackgroundCache_free(&background_cache);
+    RenderScoreCache_free(&score_cache);
+    free(recording);
+    free(reference.pixels);
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// replays an ai vs ai match with the full frame kernel at the size the resolution governor picks, with twice the
+// work per frame from halfway through like a slower machine would have, and prints the log of the scales it picked.
+// then feeds it frame times with noise from a budget that falls between two steps, where a governor without
+// hysteresis that picks the step that fits each window goes back and forth
+static int bench_resolution(int const argc, char **const argv)
+{
+    int const frame_count = argc > 0 ? atoi(argv[0]) : 400;
+    double const budget_ms = argc > 1 ? atof(argv[1]) : 8.0;
+    int const width = argc > 2 ? atoi(argv[2]) : 1920;
+    int const height = argc > 3 ? atoi(argv[3]) : 1080;
+    float const aspect_ratio = (float) width / (float) height;
+
+    RenderTarget target = {malloc((size_t) width * (size_t) height * sizeof(uint32_t)), width, height, width};
+    if (target.pixels == NULL) return 1;
+
+    RenderIsa const isa = render_best_isa();
+    ResolutionGovernor governor;
+    ResolutionGovernor_init(&governor, (uint64_t) (budget_ms * 1e6));
+    printf("resolution: %dx%d, %s kernel, budget %.2f ms, twice the work from frame %d\n", width, height,
+           RenderIsa_name(isa), budget_ms, frame_count / 2);
+
+    Game game;
+    Game_setup_random_match(&game, 1, aspect_ratio);
+    double full_ms[2] = {0};
+    uint64_t over_budget_counts[2] = {0};
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        Game_step_match_swept(&game, (float) GAME_UNITS_PER_SECOND / 60.0f);
+        GameSnapshot const snapshot = Game_snapshot(&game);
+        ShaderConstants const constants = render_snapshot_constants(&snapshot, aspect_ratio);
+        int const load = frame < frame_count / 2 ? 1 : 2;
+
+        // what the frame would have taken at full scale, for the first few frames of each half
+        if (frame % (frame_count / 2) < 8)
+        {
+            target.width = width;
+            target.height = height;
+            uint64_t const time_start = time_now_ns();
+            for (int i = 0; i < load; ++i) render_frame_isa(&target, &constants, isa);
+            full_ms[load - 1] += (double) (time_now_ns() - time_start) / 1e6 / 8.0;
+        }
+
+        target.width = ResolutionGovernor_size(&governor, width);
+        target.height = ResolutionGovernor_size(&governor, height);
+        target.pitch = target.width;
+
+        uint64_t const time_start = time_now_ns();
+        for (int i = 0; i < load; ++i) render_frame_isa(&target, &constants, isa);
+        uint64_t const frame_ns = time_now_ns() - time_start;
+
+        over_budget_counts[load - 1] += frame_ns > governor.budget_ns;
+        ResolutionGovernor_add(&governor, frame_ns);
+    }
+
+    uint64_t const first_change = governor.change_count > RESOLUTION_LOG_CAPACITY ?
+        governor.change_count - RESOLUTION_LOG_CAPACITY : 0;
+    for (uint64_t i = first_change; i < governor.change_count; ++i)
+    {
+        char line[128];
+        ResolutionChange_format(&governor.log[i % RESOLUTION_LOG_CAPACITY], line);
+        printf("    %s", line);
+    }
+
+    char summary[128];
+    ResolutionGovernor_format(&governor, summary);
+    printf("    %s", summary);
+    printf("    frames per scale:");
+    for (int scale = RESOLUTION_SCALE_MIN; scale <= RESOLUTION_SCALE_ONE; ++scale)
+    {
+        uint64_t const count = governor.frame_counts[scale - RESOLUTION_SCALE_MIN];
+        if (count != 0) printf(" %d/16 %llu", scale, (unsigned long long) count);
+    }
+    printf("\n");
+    printf("    full scale takes %.2f ms, then %.2f ms, %llu and %llu frames of each half over the budget\n",
+           full_ms[0], full_ms[1], (unsigned long long) over_budget_counts[0],
+           (unsigned long long) over_budget_counts[1]);
+
+    // frame times that go with the pixel count, with 15% noise either way, for a budget between 12/16 and 13/16
+    uint64_t const budget_ns = 10000000u;
+    uint64_t const full_ns = budget_ns * RESOLUTION_SCALE_ONE * RESOLUTION_SCALE_ONE / (int) (12.5f * 12.5f);
+    ResolutionGovernor_init(&governor, budget_ns);
+    int naive_scale = RESOLUTION_SCALE_ONE;
+    uint64_t naive_window_ns = 0;
+    uint64_t naive_change_count = 0;
+    uint32_t seed = 1;
+    int const noisy_frame_count = 100000;
+    for (int frame = 0; frame < noisy_frame_count; ++frame)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        double const noise = 0.85 + 0.3 * (double) (seed >> 8) / (double) (1u << 24);
+
+        int const scale = governor.scale;
+        ResolutionGovernor_add(&governor, (uint64_t) ((double) full_ns * scale * scale / 256.0 * noise));
+
+        // the largest step that the last window says fits the budget
+        naive_window_ns += (uint64_t) ((double) full_ns * naive_scale * naive_scale / 256.0 * noise);
+        if ((frame + 1) % RESOLUTION_WINDOW == 0)
+        {
+            uint64_t const average_ns = naive_window_ns / RESOLUTION_WINDOW;
+            int to = RESOLUTION_SCALE_ONE;
+            while (to > RESOLUTION_SCALE_MIN && resolution_predict_ns(average_ns, naive_scale, to) > budget_ns) --to;
+            naive_change_count += to != naive_scale;
+            naive_scale = to;
+            naive_window_ns = 0;
+        }
+    }
+
+    bool const is_steady = governor.change_count <= 2;
+    printf("    %d noisy frames with the budget between 12/16 and 13/16: %llu changes to %d/16, %llu frames over "
+           "the budget, %llu changes without hysteresis: %s\n", noisy_frame_count,
+           (unsigned long long) governor.change_count, governor.scale,
+           (unsigned long long) governor.over_budget_count, (unsigned long long) naive_change_count,
+           is_steady ? "ok" : "FAILED");
+
+    free(target.pixels);
+    return is_steady ? 0 : 1;
+}
+
+static uint64_t cpu_time_ns(clockid_t const clock)
+{
+    struct timespec time;
+    clock_gettime(clock, &time);
+    return (uint64_t) time.tv_sec * 1000000000u + (uint64_t) time.tv_nsec;
+}
+
+// plays the window thread of main.c against the simulation thread at 60 frames per second, with the cpu renderer
+// standing in for the gpu: a phase waiting for a serve, one of play with space held and one paused, once drawing
+// every frame and once with the present on change of present.h, and reports how busy the cpu was in each
+static int bench_present_skip(int const argc, char **const argv)
+{
+    double const phase_seconds = argc > 0 ? atof(argv[0]) : 1.0;
+    int const width = argc > 1 ? atoi(argv[1]) : 960;
+    int const height = argc > 2 ? atoi(argv[2]) : 540;
+    float const aspect_ratio = (float) width / (float) height;
+    uint64_t const frame_ns = 16666667u;
+    uint64_t const phase_frame_count = (uint64_t) (phase_seconds * 60.0);
+
+    RenderTarget const target = {malloc((size_t) width * (size_t) height * sizeof(uint32_t)), width, height, width};
+    if (target.pixels == NULL) return 1;
+    RenderIsa const isa = render_best_isa();
+
+    static char const *const phase_names[] = {"serving", "playing", "paused "};
+    printf("presentskip: %dx%d with the %s kernel, %.1f s per phase, busy time per second\n", width, height,
+           RenderIsa_name(isa), phase_seconds);
+
+    bool is_ok = true;
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        static Simulation simulation;
+        simulation.game = (Game) {.aspect_ratio = aspect_ratio, .player2_ai_gain = AI_GAIN, .seed = 7};
+        Game_reset(&simulation.game);
+        simulation.input = (Input) {0};
+        if (!Simulation_start(&simulation, SIMULATION_HZ))
+        {
+            fprintf(stderr, "could not start the simulation thread\n");
+            return 1;
+        }
+
+        PresentFilter filter = {0};
+        printf("    %s\n", mode == 0 ? "every frame drawn" : "drawn on change");
+        for (int phase = 0; phase < 3; ++phase)
+        {
+            uint64_t const now_ns = time_now_ns();
+            if (phase == 1) Input_key(&simulation.input, ' ', true, now_ns);
+            if (phase == 2)
+            {
+                Input_key(&simulation.input, ' ', false, now_ns);
+                Input_key(&simulation.input, KEY_PAUSE, true, now_ns);
+                Input_key(&simulation.input, KEY_PAUSE, false, now_ns);
+            }
+
+            uint64_t const drawn_start = filter.drawn_count;
+            uint64_t const thread_start_ns = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+            uint64_t const process_start_ns = cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID);
+            uint64_t render_ns = 0;
+            uint64_t next_frame_ns = time_now_ns();
+            for (uint64_t frame = 0; frame < phase_frame_count; ++frame)
+            {
+                TripleBuffer_acquire(&simulation.snapshots);
+                GameSnapshot const snapshot = *TripleBuffer_front(&simulation.snapshots);
+                ShaderConstants const constants = render_snapshot_constants(&snapshot, aspect_ratio);
+
+                if (mode == 0) PresentFilter_invalidate(&filter);
+                if (PresentFilter_update(&filter, &constants, width, height, RESOLUTION_SCALE_ONE))
+                {
+                    uint64_t const time_start = time_now_ns();
+                    render_frame_isa(&target, &constants, isa);
+                    render_ns += time_now_ns() - time_start;
+                }
+
+                // the present, or the wait for input of a frame that was not drawn
+                next_frame_ns += frame_ns;
+                uint64_t const time_now = time_now_ns();
+                if (next_frame_ns > time_now) thread_sleep_ns(next_frame_ns - time_now);
+            }
+
+            double const seconds = (double) phase_frame_count / 60.0;
+            uint64_t const drawn_count = filter.drawn_count - drawn_start;
+            printf("        %s %4llu of %4llu frames drawn, drawing %7.2f ms, frame thread %7.2f ms, "
+                   "process %7.2f ms\n", phase_names[phase], (unsigned long long) drawn_count,
+                   (unsigned long long) phase_frame_count, (double) render_ns / 1e6 / seconds,
+                   (double) (cpu_time_ns(CLOCK_THREAD_CPUTIME_ID) - thread_start_ns) / 1e6 / seconds,
+                   (double) (cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID) - process_start_ns) / 1e6 / seconds);
+
+            // a paused game does not change, only the first frame of the phase can differ from the one before it
+            if (mode == 1 && phase == 2) is_ok &= drawn_count <= 1;
+        }
+
+        Simulation_stop(&simulation);
+    }
+
+    printf("    nothing drawn while paused: %s\n", is_ok ? "ok" : "FAILED");
+    free(target.pixels);
+    return is_ok ? 0 : 1;
+}
+
+// plays the frame loop of main.c against the simulation thread while active, without focus, paused and minimized,
+// once the way it was before the idle scheduler, spinning while minimized and stepping at full rate throughout,
+// and once with idle.h and the pacing of the simulation, which stands still while minimized, and reports the cpu
+// time of the process and the steps in each. a present is a sleep until the next 60 hz vsync and the waits for
+// window messages are plain sleeps. then checks that unpausing wakes the parked simulation thread right away
+static int bench_idle(int const argc, char **const argv)
+{
+    double const phase_seconds = argc > 0 ? atof(argv[0]) : 1.0;
+    uint64_t const phase_ns = (uint64_t) (phase_seconds * 1e9);
+    uint64_t const frame_ns = 16666667u;
+
+    printf("idle: %.1f s per mode, background frames capped at %d hz, cpu time of the process\n", phase_seconds,
+           IDLE_BACKGROUND_HZ);
+
+    static Simulation simulation;
+    bool is_ok = true;
+    for (int mode_index = 0; mode_index < 2; ++mode_index)
+    {
+        bool const is_idle = mode_index == 1;
+        simulation.game = (Game) {.aspect_ratio = 1.5f, .player2_ai_gain = AI_GAIN, .seed = 7};
+        Game_reset(&simulation.game);
+        KeyBitmap_flip(&simulation.game.keys, ' ');
+        simulation.input = (Input) {0};
+        Simulation_set_pacing(&simulation, SIMULATION_PACING_SPIN);
+        if (!Simulation_start(&simulation, SIMULATION_HZ))
+        {
+            fprintf(stderr, "could not start the simulation thread\n");
+            return 1;
+        }
+
+        printf("    %s\n", is_idle ? "idle scheduler" : "before");
+        IdleScheduler idle = {0};
+        PresentFilter filter = {0};
+        for (IdleMode phase = 0; phase < IDLE_MODE_COUNT; ++phase)
+        {
+            bool const is_paused = phase == IDLE_MODE_PAUSED;
+            if (is_paused != Simulation_is_paused(&simulation))
+            {
+                Input_key(&simulation.input, KEY_PAUSE, true, time_now_ns());
+                Input_key(&simulation.input, KEY_PAUSE, false, time_now_ns());
+                Simulation_wake(&simulation);
+                while (Simulation_is_paused(&simulation) != is_paused) thread_sleep_ns(1000000u);
+            }
+
+            uint64_t const drawn_start = filter.drawn_count;
+            uint64_t const step_start = simulation.clock.step_count;
+            uint64_t const wake_start = simulation.park_count;
+            uint64_t const time_start = time_now_ns();
+            uint64_t const cpu_start_ns = cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID);
+            uint64_t const time_end = time_start + phase_ns;
+            uint64_t loop_count = 0;
+            for (uint64_t time_now = time_start; time_now < time_end; time_now = time_now_ns())
+            {
+                ++loop_count;
+                IdleMode const mode = is_idle ? idle_mode(phase == IDLE_MODE_MINIMIZED,
+                                                          phase != IDLE_MODE_BACKGROUND, is_paused) :
+                    IDLE_MODE_ACTIVE;
+                Simulation_set_pacing(&simulation, !is_idle ? SIMULATION_PACING_SPIN :
+                                      mode == IDLE_MODE_MINIMIZED ? SIMULATION_PACING_PARKED :
+                                      mode == IDLE_MODE_BACKGROUND ?
+                                      SIMULATION_PACING_BACKGROUND : SIMULATION_PACING_FOREGROUND);
+
+                uint64_t const wait_ns = IdleScheduler_wait_before_ns(&idle, mode, time_now);
+                if (wait_ns != 0)
+                {
+                    // no window message ever comes here
+                    uint64_t const left_ns = time_end - time_now;
+                    thread_sleep_ns(wait_ns < left_ns ? wait_ns : left_ns);
+                    IdleScheduler_waited(&idle, mode, time_now_ns() - time_now);
+                    continue;
+                }
+
+                // what the frame loop did when minimized before
+                if (phase == IDLE_MODE_MINIMIZED) continue;
+
+                TripleBuffer_acquire(&simulation.snapshots);
+                GameSnapshot const snapshot = *TripleBuffer_front(&simulation.snapshots);
+                ShaderConstants const constants = render_snapshot_constants(&snapshot, 1.5f);
+                if (!is_idle) PresentFilter_invalidate(&filter);
+                if (PresentFilter_update(&filter, &constants, 900, 600, RESOLUTION_SCALE_ONE))
+                {
+                    thread_sleep_ns(frame_ns - time_now % frame_ns);
+                }
+                else
+                {
+                    uint64_t const after_ns = IdleScheduler_wait_after_ns(&idle, mode, 0);
+                    uint64_t const left_ns = time_end - time_now;
+                    thread_sleep_ns(after_ns < left_ns ? after_ns : left_ns);
+                    IdleScheduler_waited(&idle, mode, time_now_ns() - time_now);
+                }
+            }
+
+            double const elapsed_ns = (double) (time_now_ns() - time_start);
+            double const cpu_percent = (double) (cpu_time_ns(CLOCK_PROCESS_CPUTIME_ID) - cpu_start_ns) /
+                                       elapsed_ns * 100.0;
+            uint64_t const step_count = simulation.clock.step_count - step_start;
+            printf("        %-10s cpu %6.2f%%, %7llu loops, %4llu frames, %5llu steps, simulation parked %llu times\n",
+                   IdleMode_name(phase), cpu_percent, (unsigned long long) loop_count,
+                   (unsigned long long) (filter.drawn_count - drawn_start), (unsigned long long) step_count,
+                   (unsigned long long) (simulation.park_count - wake_start));
+
+            if (is_idle && (phase == IDLE_MODE_PAUSED || phase == IDLE_MODE_MINIMIZED)) is_ok &= cpu_percent < 2.0;
+
+            // a minimized match stands still, the steps that were due as the phase began may still run
+            if (is_idle && phase == IDLE_MODE_MINIMIZED) is_ok &= step_count <= 2;
+        }
+
+        // the game is not paused any more after the minimized phase, restore the window and pause it to see how
+        // fast it wakes up
+        if (is_idle)
+        {
+            Simulation_set_pacing(&simulation, SIMULATION_PACING_FOREGROUND);
+            Input_key(&simulation.input, KEY_PAUSE, true, time_now_ns());
+            Input_key(&simulation.input, KEY_PAUSE, false, time_now_ns());
+            Simulation_wake(&simulation);
+            while (!Simulation_is_paused(&simulation)) thread_sleep_ns(1000000u);
+            thread_sleep_ns(50000000u);
+
+            uint64_t const step = simulation.clock.step_count;
+            uint64_t const time_start = time_now_ns();
+            Input_key(&simulation.input, KEY_PAUSE, true, time_start);
+            Simulation_wake(&simulation);
+            while (TripleBuffer_acquire(&simulation.snapshots), TripleBuffer_front(&simulation.snapshots)->step == step ||
+                   Simulation_is_paused(&simulation))
+            {
+                thread_yield();
+            }
+            double const wake_ms = (double) (time_now_ns() - time_start) / 1e6;
+            is_ok &= wake_ms < 20.0;
+            printf("        unpausing reached the parked simulation in %.2f ms\n", wake_ms);
+        }
+
+        Simulation_stop(&simulation);
+    }
+
+    printf("    near zero cpu while paused and minimized: %s\n", is_ok ? "ok" : "FAILED");
+    return is_ok ? 0 : 1;
+}
+
+// a clock for the pacer that only moves when it is read or slept on, so a test paces the same every time.
+// every read takes read_ns and every sleep overshoots by a pseudo random amount, now and then by a lot
+typedef struct PacerTestClock
+{
+    uint64_t now_ns;
+    uint64_t read_ns;
+    uint32_t seed;
+    uint64_t sleep_count;
+} PacerTestClock;
+
+static uint64_t PacerTestClock_now(void *const context)
+{
+    PacerTestClock *const this = context;
+    this->now_ns += this->read_ns;
+    return this->now_ns;
+}
+
+static void PacerTestClock_sleep(void *const context, uint64_t const ns)
+{
+    PacerTestClock *const this = context;
+    this->seed = this->seed * 1664525u + 1013904223u;
+    uint32_t const random = this->seed >> 8;
+
+    // up to 300 us late, and 1.5 to 2.5 ms late for one sleep in 16 like a busy os
+    uint64_t const late_ns = random % 16 == 0 ? 1500000u + random % 1000000u : random % 300000u;
+    this->now_ns += ns + late_ns;
+    ++this->sleep_count;
+}
+
+static double bench_thread_cpu_ms(uint64_t const start_ns)
+{
+    return (double) (cpu_time_ns(CLOCK_THREAD_CPUTIME_ID) - start_ns) / 1e6;
+}
+
+static void bench_print_pacer(FramePacer const *const pacer, char const *const name, double const cpu_ms,
+                              double const seconds)
+{
+    char line[128];
+    FramePacer_format(pacer, name, line);
+    printf("    %.*s, cpu %.1f%%\n", (int) strlen(line) - 1, line, cpu_ms / 10.0 / seconds);
+}
+
+// paces against PacerTestClock twice and checks both runs wake up at the same times, on the deadline unless a
+// sleep overshot the margin, then paces for real with a sleep alone, a spin alone and the pacer and compares
+// their jitter, late frames and cpu time. all three count a frame late against its deadline the same way
+static int bench_frame_pacer(int const argc, char **const argv)
+{
+    uint32_t const hz = argc > 0 ? (uint32_t) strtoul(argv[0], NULL, 10) : 144u;
+    int const frame_count = argc > 1 ? atoi(argv[1]) : 600;
+    double const seconds = (double) frame_count / hz;
+
+    printf("framepacer: %u hz, %d frames\n", hz, frame_count);
+
+    static FramePacer pacers[2];
+    uint64_t wake_sums[2] = {0};
+    for (int run = 0; run < 2; ++run)
+    {
+        PacerTestClock clock = {.now_ns = 1000000000u, .read_ns = 500u, .seed = 1};
+        FramePacer_init(&pacers[run], hz, &PacerTestClock_now, &PacerTestClock_sleep, &clock);
+        for (int frame = 0; frame < frame_count; ++frame)
+        {
+            wake_sums[run] = wake_sums[run] * 31u + FramePacer_wait(&pacers[run]);
+        }
+    }
+
+    FramePacerStats const *const stats = &pacers[0].stats;
+    bool const is_deterministic = wake_sums[0] == wake_sums[1] &&
+                                  memcmp(&pacers[0].stats, &pacers[1].stats, sizeof(FramePacerStats)) == 0;
+    // frames on time are at most a clock read past the deadline, the interval before a late frame and the
+    // one after it are off by how late it was
+    bool const is_on_time = stats->count - 2 * stats->late_count <= stats->buckets[0] + stats->buckets[1];
+    // the margin leaves out the slowest sleeps, which the test clock makes one in 16 of
+    bool const is_ok = is_deterministic && is_on_time &&
+                       stats->late_count * 100 <= (uint64_t) frame_count * (100 - FRAME_PACER_MARGIN_PERCENT);
+    bench_print_pacer(&pacers[0], "    test clock, pacer", 0.0, seconds);
+    printf("        margin %.2f ms, the same both runs: %s, on the deadline unless late: %s\n",
+           (double) pacers[0].spin_margin_ns / 1e6, is_deterministic ? "ok" : "FAILED",
+           is_on_time ? "ok" : "FAILED");
+
+    // a sleep alone
+    ThreadTimer timer;
+    ThreadTimer_init(&timer);
+    FramePacer pacer;
+    FramePacer_init(&pacer, hz, &frame_pacer_os_now, &frame_pacer_os_sleep, &timer);
+    uint64_t cpu_start_ns = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t deadline_ns = time_now_ns();
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        uint64_t const now_ns = time_now_ns();
+        if (now_ns < deadline_ns) ThreadTimer_sleep_ns(&timer, deadline_ns - now_ns);
+        deadline_ns = FramePacer_mark_due(&pacer, time_now_ns(), deadline_ns);
+    }
+    bench_print_pacer(&pacer, "    sleep", bench_thread_cpu_ms(cpu_start_ns), seconds);
+
+    // a spin alone
+    FramePacer_init(&pacer, hz, &frame_pacer_os_now, &frame_pacer_os_sleep, &timer);
+    cpu_start_ns = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    deadline_ns = time_now_ns();
+    for (int frame = 0; frame < frame_count; ++frame)
+    {
+        uint64_t now_ns;
+        while ((now_ns = time_now_ns()) < deadline_ns) thread_pause();
+        deadline_ns = FramePacer_mark_due(&pacer, now_ns, deadline_ns);
+    }
+    bench_print_pacer(&pacer, "    spin ", bench_thread_cpu_ms(cpu_start_ns), seconds);
+
+    FramePacer_init(&pacer, hz, &frame_pacer_os_now, &frame_pacer_os_sleep, &timer);
+    cpu_start_ns = cpu_time_ns(CLOCK_THREAD_CPUTIME_ID);
+    for (int frame = 0; frame < frame_count; ++frame) FramePacer_wait(&pacer);
+    bench_print_pacer(&pacer, "    pacer", bench_thread_cpu_ms(cpu_start_ns), seconds);
+    printf("        margin %.3f ms, spun %.1f ms\n", (double) pacer.spin_margin_ns / 1e6,
+           (double) pacer.stats.spin_ns / 1e6);
+    ThreadTimer_free(&timer);
+
+    return is_ok ? 0 : 1;
+}
+
+// stores bytecode sized stand-ins for every shader main.c loads in a cache in a temporary directory, reads
+// them back and checks damaged, cut short and unknown files are turned down, then times the cache hits
+// and hashing shader_program, which is what a start without embedded bytecode costs before d3d gets involved
+static int bench_shader_cache(int const argc, char **const argv)
+{
+    int const iteration_count = argc > 0 ? atoi(argv[0]) : 1000;
+
+    char directory[SHADER_CACHE_MAX_PATH] = "/tmp/pong_shader_cache_XXXXXX";
+    if (mkdtemp(directory) == NULL) return 1;
+    strcat(directory, "/");
+
+    uint64_t time_start = time_now_ns();
+    // a different seed every time so the compiler can not hash once for the whole loop
+    uint64_t hash_sum = 0;
+    for (int i = 0; i < iteration_count; ++i)
+    {
+        hash_sum += shader_hash(SHADER_HASH_SEED + (uint64_t) i, shader_program, sizeof(shader_program));
+    }
+    double const hash_us = (double) (time_now_ns() - time_start) / 1e3 / iteration_count;
+    uint64_t const source_hash = shader_source_hash();
+
+    static struct
+    {
+        char const *entry;
+        char const *target;
+        int variant;
+    } const shaders[] = {
+        {"vs_main", "vs_5_0", -1},
+        {"ps_overlay", "ps_5_0", -1},
+        {"ps_main", "ps_5_0", SHADER_VARIANT_FULL},
+        {"ps_main", "ps_5_0", SHADER_VARIANT_PLAYER1},
+        {"ps_main", "ps_5_0", SHADER_VARIANT_PLAYER2},
+        {"ps_main", "ps_5_0", SHADER_VARIANT_APART},
+        {"ps_upscale", "ps_5_0", -1},
+    };
+    size_t const shader_count = sizeof(shaders) / sizeof(*shaders);
+
+    // 1 << 11 is D3DCOMPILE_ENABLE_STRICTNESS
+    uint32_t const flags = 1u << 11;
+    uint64_t keys[sizeof(shaders) / sizeof(*shaders)];
+    bool is_ok = true;
+    for (size_t i = 0; i < shader_count; ++i)
+    {
+        keys[i] = shader_key(source_hash, shaders[i].entry, shaders[i].target, shaders[i].variant, flags);
+        for (size_t j = 0; j < i; ++j) is_ok &= keys[i] != keys[j];
+
+        // any change to the source or the flags names other files
+        is_ok &= keys[i] != shader_key(source_hash ^ 1, shaders[i].entry, shaders[i].target, shaders[i].variant, flags);
+        is_ok &= keys[i] != shader_key(source_hash, shaders[i].entry, shaders[i].target, shaders[i].variant, flags | 1);
+    }
+    printf("shadercache: source hash %016llx in %.2f us (sum %llx), %zu shaders with different keys: %s\n",
+           (unsigned long long) source_hash, hash_us, (unsigned long long) hash_sum, shader_count,
+           is_ok ? "ok" : "FAILED");
+
+    // the shaders of main.c are a few kilobytes each
+    static uint8_t bytecode[SHADER_CACHE_MAX_SIZE + 1];
+    static uint8_t loaded[SHADER_CACHE_MAX_SIZE];
+    for (size_t i = 0; i < sizeof(bytecode); ++i) bytecode[i] = (uint8_t) shader_program[i % sizeof(shader_program)];
+    size_t const sizes[] = {1200, 3000, 4000, 4100, 4200, 2800, 900};
+
+    bool is_round_trip_ok = true;
+    for (size_t i = 0; i < shader_count; ++i)
+    {
+        is_round_trip_ok &= shader_cache_load(directory, keys[i], loaded) == 0;
+        is_round_trip_ok &= shader_cache_store(directory, keys[i], bytecode + i, sizes[i]);
+        is_round_trip_ok &= shader_cache_load(directory, keys[i], loaded) == sizes[i] &&
+                            memcmp(loaded, bytecode + i, sizes[i]) == 0;
+    }
+    is_ok &= is_round_trip_ok;
+    printf("    stored and read back every shader: %s\n", is_round_trip_ok ? "ok" : "FAILED");
+
+    time_start = time_now_ns();
+    for (int i = 0; i < iteration_count; ++i)
+    {
+        for (size_t j = 0; j < shader_count; ++j) shader_cache_load(directory, keys[j], loaded);
+    }
+    double const load_us = (double) (time_now_ns() - time_start) / 1e3 / iteration_count;
+    printf("    reading all %zu from the cache takes %.1f us\n", shader_count, load_us);
+
+    // damage the file of the first shader in every way a crash or another program could
+    char path[SHADER_CACHE_MAX_PATH];
+    shader_cache_path(path, directory, keys[0], ".cso");
+    FILE *file = fopen(path, "r+b");
+    if (file == NULL) return 1;
+    fseek(file, (long) sizeof(ShaderCacheHeader) + 100, SEEK_SET);
+    fputc(bytecode[100] ^ 1, file);
+    fclose(file);
+    bool const is_damage_found = shader_cache_load(directory, keys[0], loaded) == 0;
+
+    shader_cache_store(directory, keys[0], bytecode, sizes[0]);
+    if (truncate(path, (off_t) (sizeof(ShaderCacheHeader) + sizes[0] - 1)) != 0) return 1;
+    bool const is_cut_found = shader_cache_load(directory, keys[0], loaded) == 0;
+
+    bool const is_unknown_found = shader_cache_load(directory, keys[0] ^ 1, loaded) == 0;
+    bool const is_too_big_found = !shader_cache_store(directory, keys[0], bytecode, SHADER_CACHE_MAX_SIZE + 1);
+
+    bool const is_checked = is_damage_found && is_cut_found && is_unknown_found && is_too_big_found;
+    is_ok &= is_checked;
+    printf("    damaged %s, cut short %s, unknown %s, too big %s: %s\n",
+           is_damage_found ? "turned down" : "READ", is_cut_found ? "turned down" : "READ",
+           is_unknown_found ? "missed" : "READ", is_too_big_found ? "turned down" : "STORED",
+           is_checked ? "ok" : "FAILED");
+
+    for (size_t i = 0; i < shader_count; ++i)
+    {
+        shader_cache_path(path, directory, keys[i], ".cso");
+        remove(path);
+    }
+    remove(directory);
+
+    return is_ok ? 0 : 1;
+}
+
+typedef struct Command
+{
+    char const *name;
+    char const *usage;
+    int (*run)(int argc, char **argv);
+} Command;
+
+static Command const commands[] = {
+    {"sim", "[ticks] [dt]", &bench_sim},
+    {"batch", "[matches] [ticks] [dt]", &bench_batch},
+    {"fastforward", "[rallies] [player1 ai gain] [dt]", &bench_fast_forward},
+    {"swept", "[reference dt]", &bench_swept},
+    {"fixedstep", "[hz] [frames]", &bench_fixed_step},
+    {"input", "[frames] [burst size]", &bench_input},
+    {"inputring", "[events] [mouse hz] [seconds]", &bench_input_ring},
+    {"latency", "[frames] [simulation hz]", &bench_latency},
+    {"timing", "[drift seconds]", &bench_timing},
+    {"simthread", "[hz] [seconds]", &bench_simulation_thread},
+    {"render", "[frames] [ppm path for the 900x600 frame]", &bench_render},
+    {"rendersimd", "[frames] [width] [height]", &bench_render_simd},
+    {"rendertiles", "[frames] [max threads]", &bench_render_tiles},
+    {"renderdirty", "[frames] [width] [height]", &bench_render_dirty},
+    {"renderscore", "[frames] [width] [height]", &bench_render_score},
+    {"renderbackground", "[frames]", &bench_render_background},
+    {"rendersprites", "[frames] [width] [height]", &bench_render_sprites},
+    {"renderhierarchy", "[frames] [width] [height]", &bench_render_hierarchy},
+    {"shadervariants", "[frames] [width] [height]", &bench_shader_variants},
+    {"shadercache", "[iterations]", &bench_shader_cache},
+    {"resolution", "[frames] [budget ms] [width] [height]", &bench_resolution},
+    {"presentskip", "[seconds per phase] [width] [height]", &bench_present_skip},
+    {"idle", "[seconds per mode]", &bench_idle},
+    {"framepacer", "[hz] [frames]", &bench_frame_pacer},
+    {"tournament", "[matches] [threads, 0 for a scaling sweep] [ticks] [time limit ms]", &bench_tournament},
+};
+
+int main(int const argc, char **const argv)
+{
+    char const *const name = argc > 1 ? argv[1] : "sim";
+
+    time_init();
+
+    for (size_t i = 0; i < sizeof(commands) / sizeof(*commands); ++i)
+    {
+        if (strcmp(commands[i].name, name) == 0)
+        {
+            return commands[i].run(argc > 2 ? argc - 2 : 0, argv + 2);
+        }
+    }
+
+    fprintf(stderr, "usage: %s <command> [args]\n", argv[0]);
+    for (size_t i = 0; i < sizeof(commands) / sizeof(*commands); ++i)
+    {
+        fprintf(stderr, "    %s %s\n", commands[i].name, commands[i].usage);
+    }
+
+    return 1;
+}
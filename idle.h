@@ -0,0 +1,93 @@
+#pragma once
+
+// decides when the frame loop of main.c blocks instead of drawing. minimized there is nothing to draw and it
+// blocks until a window message comes or IDLE_MINIMIZED_WAIT_NS, paused nothing changes without input so a frame
+// that looks like the one on screen blocks until input or IDLE_PAUSED_WAIT_NS, and without focus frames are capped
+// at IDLE_BACKGROUND_HZ. the waits themselves are up to the platform, this only says how long they may be.
+// needs timing.h and present.h
+
+// build with -DIDLE_BACKGROUND_HZ=... for another cap
+#ifndef IDLE_BACKGROUND_HZ
+#define IDLE_BACKGROUND_HZ (30)
+#endif
+
+// a paused game only changes with input, this is only in case something was missed
+#define IDLE_PAUSED_WAIT_NS (500000000u)
+
+// minimized the loop waits for window messages, but wakes up this often anyway so FrameClock keeps
+// calibrating the clock the simulation thread reads
+#define IDLE_MINIMIZED_WAIT_NS (FRAME_CLOCK_CALIBRATE_NS)
+
+typedef enum IdleMode
+{
+    IDLE_MODE_ACTIVE,
+    IDLE_MODE_BACKGROUND,
+    IDLE_MODE_PAUSED,
+    IDLE_MODE_MINIMIZED,
+    IDLE_MODE_COUNT,
+} IdleMode;
+
+typedef struct IdleScheduler
+{
+    uint64_t next_background_ns;
+
+    // how often the loop blocked and for how long in each mode
+    uint64_t wait_counts[IDLE_MODE_COUNT];
+    uint64_t wait_ns[IDLE_MODE_COUNT];
+} IdleScheduler;
+
+static inline IdleMode idle_mode(bool const is_minimized, bool const is_focused, bool const is_paused)
+{
+    if (is_minimized) return IDLE_MODE_MINIMIZED;
+    if (is_paused) return IDLE_MODE_PAUSED;
+    if (!is_focused) return IDLE_MODE_BACKGROUND;
+    return IDLE_MODE_ACTIVE;
+}
+
+static inline char const *IdleMode_name(IdleMode const mode)
+{
+    switch (mode)
+    {
+        case IDLE_MODE_BACKGROUND: return "background";
+        case IDLE_MODE_PAUSED: return "paused";
+        case IDLE_MODE_MINIMIZED: return "minimized";
+        default: return "active";
+    }
+}
+
+// returns 0 if the loop should look at the game now, otherwise how long it may block before it has to
+static uint64_t IdleScheduler_wait_before_ns(IdleScheduler *const this, IdleMode const mode, uint64_t const now_ns)
+{
+    if (mode == IDLE_MODE_MINIMIZED) return IDLE_MINIMIZED_WAIT_NS;
+
+    if (mode == IDLE_MODE_BACKGROUND)
+    {
+        if (now_ns < this->next_background_ns) return this->next_background_ns - now_ns;
+
+        // a frame that is late does not make the next one early
+        uint64_t const interval_ns = 1000000000u / IDLE_BACKGROUND_HZ;
+        this->next_background_ns = this->next_background_ns + interval_ns > now_ns ?
+            this->next_background_ns + interval_ns : now_ns + interval_ns;
+    }
+    return 0;
+}
+
+// how long the loop may block after a frame that was not drawn since it looked like the one on screen,
+// there is no present that waits for vsync then. pumped_count is how many events came in just before
+static uint64_t IdleScheduler_wait_after_ns(IdleScheduler const *const this, IdleMode const mode,
+                                            uint32_t const pumped_count)
+{
+    (void) this;
+
+    // the simulation needs a step or two to show the input
+    if (pumped_count != 0) return PRESENT_SETTLE_NS;
+    if (mode == IDLE_MODE_PAUSED) return IDLE_PAUSED_WAIT_NS;
+    return (uint64_t) PRESENT_IDLE_WAIT_MS * 1000000u;
+}
+
+// counts a wait the loop did in mode
+static inline void IdleScheduler_waited(IdleScheduler *const this, IdleMode const mode, uint64_t const ns)
+{
+    ++this->wait_counts[mode];
+    this->wait_ns[mode] += ns;
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+// platform independent input. the thread that captures input pushes every event with the time it
+// arrived into a single producer single consumer ring while Input_pump drains the platform queue
+// within a time budget, and the simulation thread pops the events in order at its own rate and keeps
+// the key bitmap and the paddle position, see Simulation_consume_input. neither side ever takes a lock
+// or waits for the other. the ring also keeps statistics on how deep it got and how long events waited.
+// needs timing.h and latency.h
+
+#include <stdatomic.h>
+
+// must be a power of two
+#define INPUT_QUEUE_SIZE (256u)
+
+// how many of the newest mouse moves keep the time they arrived at, see Input_mouse_time_ns.
+// must be a power of two
+#define INPUT_MOUSE_HISTORY (64u)
+
+// events that did not fit into the ring wait here in order until there is room, must be a power of two
+#define INPUT_PENDING_SIZE (64u)
+
+// how long Input_pump may spend draining the platform queue per frame
+#define INPUT_PUMP_BUDGET_NS (2000000u)
+
+// same value as VK_P
+#define KEY_PAUSE ('P')
+
+typedef enum InputEventType
+{
+    INPUT_EVENT_KEY_DOWN,
+    INPUT_EVENT_KEY_UP,
+    INPUT_EVENT_MOUSE_MOVE,
+} InputEventType;
+
+typedef struct InputEvent
+{
+    uint64_t time_ns;
+    InputEventType type;
+    union
+    {
+        int key;
+        float mouse_height;
+    };
+} InputEvent;
+
+typedef struct Input
+{
+    InputEvent events[INPUT_QUEUE_SIZE];
+
+    // the producer side, only the thread that pushes writes these.
+    // tail is where the next event is pushed, head and tail only ever increase and wrap around on their own.
+    // cached_head is the last head the producer loaded, it only has to load it again when the ring looks full
+    _Alignas(64) _Atomic uint32_t tail;
+    uint32_t cached_head;
+
+    // the events that did not fit, they are pushed before anything else once there is room. mouse moves in a
+    // row are merged into one, key events are all kept since a lost key up would leave the key held
+    InputEvent pending[INPUT_PENDING_SIZE];
+    uint32_t pending_head;
+    uint32_t pending_count;
+
+    // mouse moves pushed so far and the newest height, read by other threads for late latching
+    _Atomic uint32_t mouse_count;
+    _Atomic uint32_t mouse_height;
+
+    // mouse moves that were merged into a pending move because the ring was full, and events that had to be
+    // dropped since even the pending ones filled up. Input_pump stops taking events from the platform while
+    // any are pending, so only events handled outside of it can ever be dropped
+    uint64_t merged_count;
+    uint64_t dropped_count;
+
+    uint64_t event_count;
+    uint64_t pumped_count;
+    uint64_t max_pump_ns;
+
+    // the time the newest mouse moves arrived at, by mouse_count
+    uint64_t mouse_times_ns[INPUT_MOUSE_HISTORY];
+
+    // how old the newest mouse move a presented frame shows is, once for every move that is shown,
+    // see Input_presented. presented_count is the mouse_count of the last one
+    LatencyStats present_latency;
+    uint32_t presented_count;
+
+    // the consumer side, only the thread that pops writes these.
+    // head is the next event to pop, cached_tail the last tail the consumer loaded
+    _Alignas(64) _Atomic uint32_t head;
+    uint32_t cached_tail;
+
+    uint64_t consume_count;
+    uint64_t depth_total;
+    uint32_t max_depth;
+
+    // from the time an event arrived until it was popped
+    LatencyStats queue_latency;
+} Input;
+
+// handles one pending platform event, which ends up in Input_push, returns false when there are none left
+typedef bool (*InputSource)(void *context);
+
+// pushes event unless the ring is full, only the producer may call this
+static inline bool Input_try_push(Input *const this, InputEvent const event)
+{
+    uint32_t const tail = atomic_load_explicit(&this->tail, memory_order_relaxed);
+    if (tail - this->cached_head == INPUT_QUEUE_SIZE)
+    {
+        // the acquire makes sure the consumer is done reading the slot before it is written again
+        this->cached_head = atomic_load_explicit(&this->head, memory_order_acquire);
+        if (tail - this->cached_head == INPUT_QUEUE_SIZE) return false;
+    }
+
+    this->events[tail & (INPUT_QUEUE_SIZE - 1)] = event;
+    atomic_store_explicit(&this->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// pops the oldest event into event, returns false when the ring is empty. only the consumer may call this
+static inline bool Input_try_pop(Input *const this, InputEvent *const event)
+{
+    uint32_t const head = atomic_load_explicit(&this->head, memory_order_relaxed);
+    if (head == this->cached_tail)
+    {
+        this->cached_tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+        if (head == this->cached_tail) return false;
+    }
+
+    *event = this->events[head & (INPUT_QUEUE_SIZE - 1)];
+    atomic_store_explicit(&this->head, head + 1, memory_order_release);
+    return true;
+}
+
+// the oldest event without popping it, NULL when the ring is empty. only the consumer may call this
+static inline InputEvent const *Input_peek(Input *const this)
+{
+    uint32_t const head = atomic_load_explicit(&this->head, memory_order_relaxed);
+    if (head == this->cached_tail)
+    {
+        this->cached_tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+        if (head == this->cached_tail) return NULL;
+    }
+
+    return &this->events[head & (INPUT_QUEUE_SIZE - 1)];
+}
+
+// pops the event Input_peek returned, only the consumer may call this
+static inline void Input_pop(Input *const this)
+{
+    uint32_t const head = atomic_load_explicit(&this->head, memory_order_relaxed);
+    atomic_store_explicit(&this->head, head + 1, memory_order_release);
+}
+
+// how many events wait for the consumer, only the consumer may call this
+static inline uint32_t Input_depth(Input *const this)
+{
+    this->cached_tail = atomic_load_explicit(&this->tail, memory_order_acquire);
+    return this->cached_tail - atomic_load_explicit(&this->head, memory_order_relaxed);
+}
+
+static inline bool Input_push_event(Input *const this, InputEvent const event)
+{
+    if (!Input_try_push(this, event)) return false;
+
+    if (event.type == INPUT_EVENT_MOUSE_MOVE)
+    {
+        atomic_store_explicit(&this->mouse_height, fbits(event.mouse_height), memory_order_relaxed);
+        uint32_t const mouse_count = atomic_fetch_add_explicit(&this->mouse_count, 1, memory_order_release) + 1;
+        this->mouse_times_ns[mouse_count & (INPUT_MOUSE_HISTORY - 1)] = event.time_ns;
+    }
+
+    return true;
+}
+
+// pushes the pending events that fit now, returns true if none are left. only the producer may call this
+static bool Input_push_pending(Input *const this)
+{
+    while (this->pending_count != 0)
+    {
+        if (!Input_push_event(this, this->pending[this->pending_head & (INPUT_PENDING_SIZE - 1)])) return false;
+        ++this->pending_head;
+        --this->pending_count;
+    }
+    return true;
+}
+
+// only the producer may call this
+static void Input_push(Input *const this, InputEvent const event)
+{
+    ++this->event_count;
+
+    // nothing overtakes the pending events
+    if (Input_push_pending(this) && Input_push_event(this, event)) return;
+
+    // a move right after a pending move keeps the newest height and the time the older move arrived,
+    // the move cannot be merged into the ring itself since the consumer may be reading it
+    InputEvent *const last = this->pending_count != 0 ?
+        &this->pending[(this->pending_head + this->pending_count - 1) & (INPUT_PENDING_SIZE - 1)] : NULL;
+    if (event.type == INPUT_EVENT_MOUSE_MOVE && last != NULL && last->type == INPUT_EVENT_MOUSE_MOVE)
+    {
+        last->mouse_height = event.mouse_height;
+        ++this->merged_count;
+        return;
+    }
+
+    if (this->pending_count == INPUT_PENDING_SIZE)
+    {
+        ++this->dropped_count;
+        return;
+    }
+
+    this->pending[(this->pending_head + this->pending_count) & (INPUT_PENDING_SIZE - 1)] = event;
+    ++this->pending_count;
+}
+
+static inline void Input_key(Input *const this, int const key, bool const is_down, uint64_t const time_ns)
+{
+    Input_push(this, (InputEvent) {
+        .time_ns = time_ns,
+        .type = is_down ? INPUT_EVENT_KEY_DOWN : INPUT_EVENT_KEY_UP,
+        .key = key,
+    });
+}
+
+static inline void Input_mouse(Input *const this, float const height, uint64_t const time_ns)
+{
+    Input_push(this, (InputEvent) {
+        .time_ns = time_ns,
+        .type = INPUT_EVENT_MOUSE_MOVE,
+        .mouse_height = height,
+    });
+}
+
+// drains the platform queue until it is empty, budget_ns ran out or the ring is full, returns how many events
+// it handled. once the ring is full the rest wait in the platform queue, which never drops them.
+// only the producer may call this
+static uint32_t Input_pump(Input *const this, InputSource const source, void *const context, uint64_t const budget_ns)
+{
+    uint64_t const start_ns = time_now_ns();
+    uint64_t now = start_ns;
+    uint32_t count = 0;
+    while (Input_push_pending(this))
+    {
+        if (!source(context)) break;
+        ++count;
+        now = time_now_ns();
+        if (now - start_ns >= budget_ns) break;
+    }
+
+    this->pumped_count += count;
+    this->max_pump_ns = now - start_ns > this->max_pump_ns ? now - start_ns : this->max_pump_ns;
+    return count;
+}
+
+// the time the mouse move that made mouse_count count arrived at, 0 if it is too old to tell.
+// only the producer may call this
+static inline uint64_t Input_mouse_time_ns(Input const *const this, uint32_t const count)
+{
+    uint32_t const newest = atomic_load_explicit(&this->mouse_count, memory_order_relaxed);
+    if (count == 0 || newest - count >= INPUT_MOUSE_HISTORY) return 0;
+    return this->mouse_times_ns[count & (INPUT_MOUSE_HISTORY - 1)];
+}
+
+// a frame that shows the mouse moves up to shown_input_count was presented at present_ns. what late latching
+// changes is how new the newest move a frame shows is, so that is what is measured, once per move so a mouse
+// that stopped does not count as ever older. only the producer may call this
+static inline void Input_presented(Input *const this, uint32_t const shown_input_count, uint64_t const present_ns)
+{
+    if (shown_input_count == this->presented_count) return;
+    this->presented_count = shown_input_count;
+
+    uint64_t const time_ns = Input_mouse_time_ns(this, shown_input_count);
+    if (time_ns != 0) LatencyStats_add(&this->present_latency, present_ns > time_ns ? present_ns - time_ns : 0);
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+// input to present latency statistics. the samples go into a histogram so percentiles need neither
+// sorting nor memory, and formatting does not need the crt so the window build can print them
+
+// 0.1 ms buckets up to 100 ms, everything slower lands in the last one
+#define LATENCY_BUCKET_NS (100000u)
+#define LATENCY_BUCKET_COUNT (1000)
+
+typedef struct LatencyStats
+{
+    uint32_t buckets[LATENCY_BUCKET_COUNT];
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} LatencyStats;
+
+static inline void LatencyStats_add(LatencyStats *const this, uint64_t const ns)
+{
+    uint64_t const bucket = ns / LATENCY_BUCKET_NS;
+    ++this->buckets[bucket < LATENCY_BUCKET_COUNT ? bucket : LATENCY_BUCKET_COUNT - 1];
+    ++this->count;
+    this->total_ns += ns;
+    this->max_ns = ns > this->max_ns ? ns : this->max_ns;
+}
+
+static inline uint64_t LatencyStats_average_ns(LatencyStats const *const this)
+{
+    return this->count != 0 ? this->total_ns / this->count : 0;
+}
+
+// the percentile of a histogram of count samples in buckets bucket_ns wide, the last one holding everything
+// beyond. the samples are taken to spread evenly over their bucket, which never puts a percentile past
+// max_ns, the largest sample
+static uint64_t latency_histogram_percentile_ns(uint32_t const *const buckets, uint32_t const bucket_count,
+                                                uint64_t const bucket_ns, uint64_t const count,
+                                                uint64_t const max_ns, uint32_t const percent)
+{
+    uint64_t const wanted = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < bucket_count && wanted != 0; ++i)
+    {
+        if (seen + buckets[i] >= wanted)
+        {
+            uint64_t const lower = (uint64_t) i * bucket_ns;
+            uint64_t upper = i == bucket_count - 1 ? max_ns : lower + bucket_ns;
+            upper = upper < max_ns ? upper : max_ns;
+            if (upper <= lower) return upper;
+
+            return lower + (upper - lower) * (wanted - seen) / buckets[i];
+        }
+        seen += buckets[i];
+    }
+
+    return 0;
+}
+
+static inline uint64_t LatencyStats_percentile_ns(LatencyStats const *const this, uint32_t const percent)
+{
+    return latency_histogram_percentile_ns(this->buckets, LATENCY_BUCKET_COUNT, LATENCY_BUCKET_NS, this->count,
+                                           this->max_ns, percent);
+}
+
+// writes value in decimal, returns the end of what it wrote
+static char *latency_write_uint(char *out, uint64_t value)
+{
+    char digits[24];
+    int digit_count = 0;
+    do
+    {
+        digits[digit_count++] = (char) ('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (digit_count != 0) *out++ = digits[--digit_count];
+    return out;
+}
+
+// writes ns as milliseconds with two decimals, returns the end of what it wrote
+static char *latency_write_ms(char *out, uint64_t const ns)
+{
+    uint64_t const hundredths = (ns + 5000u) / 10000u;
+
+    out = latency_write_uint(out, hundredths / 100);
+    *out++ = '.';
+    *out++ = (char) ('0' + hundredths / 10 % 10);
+    *out++ = (char) ('0' + hundredths % 10);
+    return out;
+}
+
+static char *latency_write_string(char *out, char const *string)
+{
+    while (*string != '\0') *out++ = *string++;
+    return out;
+}
+
+// one line like "name: avg 1.23 p50 1.20 p99 4.50 max 5.12 ms\n" into buffer, which needs 128 bytes,
+// returns its length
+static size_t LatencyStats_format(LatencyStats const *const this, char const *const name, char *const buffer)
+{
+    char *out = latency_write_string(buffer, name);
+    out = latency_write_string(out, ": avg ");
+    out = latency_write_ms(out, LatencyStats_average_ns(this));
+    out = latency_write_string(out, " p50 ");
+    out = latency_write_ms(out, LatencyStats_percentile_ns(this, 50));
+    out = latency_write_string(out, " p99 ");
+    out = latency_write_ms(out, LatencyStats_percentile_ns(this, 99));
+    out = latency_write_string(out, " max ");
+    out = latency_write_ms(out, this->max_ns);
+    out = latency_write_string(out, " ms\n");
+    *out = '\0';
+    return (size_t) (out - buffer);
+}
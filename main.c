@@ -21,6 +21,40 @@
 #include "vec.h"
 #include "font.h"
 #include "shader.h"
+#include "shader_cache.h"
+#include "game.h"
+#include "timing.h"
+#include "thread.h"
+#include "fixed_step.h"
+#include "triple_buffer.h"
+#include "latency.h"
+#include "resolution.h"
+#include "present.h"
+#include "idle.h"
+#include "frame_pacer.h"
+#include "input.h"
+#include "simulation.h"
+
+typedef struct ShaderBytecode
+{
+    void const *code;
+    size_t size;
+} ShaderBytecode;
+
+// the shaders the makefile compiles with fxc, builds without them compile the shaders when they start
+#ifdef SHADER_BYTECODE
+#include "bin/shader_source_hash.h"
+#include "bin/shader_vs_main.h"
+#include "bin/shader_ps_overlay.h"
+#include "bin/shader_ps_main_0.h"
+#include "bin/shader_ps_main_1.h"
+#include "bin/shader_ps_main_2.h"
+#include "bin/shader_ps_main_3.h"
+#include "bin/shader_ps_upscale.h"
+#define SHADER_EMBEDDED(name) ((ShaderBytecode) {name, sizeof(name)})
+#else
+#define SHADER_EMBEDDED(name) ((ShaderBytecode) {NULL, 0})
+#endif
 
 #ifdef REAL_MSVC
 #pragma function(memset)
@@ -35,65 +69,96 @@ void *memset(void *dest, int c, size_t count)
     return dest;
 }
 
-typedef struct ShaderConstants
+#ifdef REAL_MSVC
+#pragma function(memcpy)
+#endif
+void *memcpy(void *dest, void const *src, size_t count)
 {
-    float2 player_size;
-    float2 player1_position;
-    float2 player2_position;
-    float2 ball_position;
-    
-    float ball_radius;
-    float aspect_ratio;
-    
-    int unsigned player1_score;
-    int unsigned player2_score;
-} ShaderConstants;
+    char *bytes = (char *)dest;
+    char const *source = (char const *)src;
+    while (count-- != 0)
+    {
+        *bytes++ = *source++;
+    }
+    return dest;
+}
 
-typedef enum PlayerMode
-{
-    PLAYER1_SERVE,
-    PLAYER2_SERVE,
-    PLAYER1_FACE,
-    PLAYER2_FACE,
-} PlayerMode;
+// the gpu time of the frame pass is read back this many frames later so reading it never waits for the gpu
+#define GPU_TIMER_COUNT (4)
 
-typedef struct Player
+typedef struct GpuTimer
 {
-    float2 pos;
-    int unsigned score;
-} Player;
+    ID3D11Query *disjoint;
+    ID3D11Query *start;
+    ID3D11Query *end;
+    // after ps_upscale, the frame time the resolution governor goes by
+    ID3D11Query *upscaled;
+    ShaderVariant variant;
+    bool is_resolution_fixed;
+    bool is_pending;
+} GpuTimer;
 
-#define KEY_BITMAP_BIT_SIZE (64)
-typedef struct KeyBitmap
+// what the once a second report compares against, to tell how busy the cpu and the gpu were in between
+typedef struct BusyCounters
 {
-    uint64_t data[4];
-} KeyBitmap;
+    uint64_t drawn_count;
+    uint64_t skipped_count;
+    uint64_t thread_ns;
+    uint64_t process_ns;
+    uint64_t gpu_ns;
+} BusyCounters;
 
-static inline bool KeyBitmap_get(KeyBitmap const self, int const index)
+// where State_load_shader got the bytecode of a shader from, in the order it tries them
+typedef enum ShaderOrigin
 {
-    return ((self.data[index / KEY_BITMAP_BIT_SIZE] >> (index % KEY_BITMAP_BIT_SIZE)) & 1) != 0;
-}
+    SHADER_ORIGIN_EMBEDDED,
+    SHADER_ORIGIN_CACHE,
+    SHADER_ORIGIN_COMPILED,
+    SHADER_ORIGIN_COUNT,
+} ShaderOrigin;
+
+#define STARTUP_MAX_STEPS (16)
 
-static inline void KeyBitmap_flip(KeyBitmap *const this, int const index)
+// how long each step from entry to the first present took, on the os clock since the tsc clock
+// is only calibrated part of the way through
+typedef struct StartupTimeline
 {
-    this->data[index / KEY_BITMAP_BIT_SIZE] ^= ((uint64_t)1 << (index % KEY_BITMAP_BIT_SIZE));
-}
+    uint64_t start_ns;
+    char const *names[STARTUP_MAX_STEPS];
+    uint64_t times_ns[STARTUP_MAX_STEPS];
+    int count;
+    bool is_done;
+} StartupTimeline;
 
-// NOTE: this might be useful for later
-#if 0
-static inline void KeyBitmap_change(KeyBitmap *const this, int const index, bool const new_bit)
+static void StartupTimeline_mark(StartupTimeline *const this, char const *const name)
 {
-    this->data[index / KEY_BITMAP_BIT_SIZE] ^=
-        (-((uint64_t) new_bit) ^ this->data[index / KEY_BITMAP_BIT_SIZE]) &
-        ((uint64_t) 1 << (index % KEY_BITMAP_BIT_SIZE));
+    if (this->count == STARTUP_MAX_STEPS) return;
+    
+    this->names[this->count] = name;
+    this->times_ns[this->count] = time_os_ns();
+    ++this->count;
 }
-#endif
 
-typedef enum GameMode
+// one line per step to the debugger output, with how long it took and when it was done
+static void StartupTimeline_print(StartupTimeline const *const this)
 {
-    GAME_MODE_START,
-    GAME_MODE_GAME,
-} GameMode;
+    uint64_t last_ns = this->start_ns;
+    for (int i = 0; i < this->count; ++i)
+    {
+        char line[128];
+        char *out = latency_write_string(line, "startup: ");
+        out = latency_write_string(out, this->names[i]);
+        out = latency_write_string(out, " ");
+        out = latency_write_ms(out, this->times_ns[i] - last_ns);
+        out = latency_write_string(out, " ms, at ");
+        out = latency_write_ms(out, this->times_ns[i] - this->start_ns);
+        out = latency_write_string(out, " ms\n");
+        *out = '\0';
+        OutputDebugStringA(line);
+        
+        last_ns = this->times_ns[i];
+    }
+}
 
 typedef struct State
 {
@@ -107,7 +172,8 @@ typedef struct State
     ID3D11RenderTargetView *frame_buffer_view;
     
     ID3D11VertexShader *vertex_shader;
-    ID3D11PixelShader *pixel_shader;
+    // one permutation of ps_main per ShaderVariant, each frame uses the one shader_variant picks
+    ID3D11PixelShader *pixel_shaders[SHADER_VARIANT_COUNT];
     
     ID3D11Buffer *constant_buffer;
     
@@ -115,26 +181,157 @@ typedef struct State
     ID3D11ShaderResourceView *texture_view;
     ID3D11SamplerState *sampler_state;
     
+    // the static layer, the middle line and both scores, at the size of the frame buffer.
+    // ps_overlay only draws it again when the window was resized or a score changed
+    ID3D11PixelShader *overlay_shader;
+    ID3D11Texture2D *overlay_texture;
+    ID3D11RenderTargetView *overlay_target_view;
+    ID3D11ShaderResourceView *overlay_texture_view;
+    int unsigned drawn_scores[2];
+    bool is_overlay_texture_valid;
+    
+    // frames are drawn to the top left of scaled_texture at the size the governor picks, and ps_upscale
+    // stretches them over the frame buffer. at full scale they are drawn to the frame buffer directly
+    ID3D11PixelShader *upscale_shader;
+    ID3D11Texture2D *scaled_texture;
+    ID3D11RenderTargetView *scaled_target_view;
+    ID3D11ShaderResourceView *scaled_texture_view;
+    ID3D11Buffer *upscale_buffer;
+    ID3D11SamplerState *upscale_sampler;
+    ResolutionGovernor resolution;
+    uint64_t logged_change_count;
+    
+    // the size the overlay texture was drawn at and upscale_buffer is for
+    int drawn_width;
+    int drawn_height;
+    
+    // 'F' draws every frame at full scale to compare
+    bool is_resolution_fixed;
+    
+    GpuTimer gpu_timers[GPU_TIMER_COUNT];
+    int gpu_timer_index;
+    // the gpu time of every timed frame, with the upscale
+    uint64_t gpu_busy_ns;
+    LatencyStats variant_gpu_time[SHADER_VARIANT_COUNT];
+    
     int width;
     int height;
     
-    float2 ball_position;
-    float2 ball_velocity;
+    // the embedded bytecode is only used if it was compiled from this shader_program,
+    // otherwise the shaders come from the cache in the directory of the exe
+    uint64_t shader_source_hash;
+    bool is_bytecode_current;
+    char shader_cache_directory[SHADER_CACHE_MAX_PATH];
+    int shader_origin_counts[SHADER_ORIGIN_COUNT];
     
-    Player player1;
-    Player player2;
-    PlayerMode player_mode;
+    StartupTimeline startup;
     
-    KeyBitmap keys;
+    // owns the game, the window thread only sends it input and draws its snapshots
+    Simulation simulation;
     
-    GameMode game_mode;
+    // 'L' turns late latching off to compare the latency with and without it
+    bool is_latch_disabled;
     
-    bool is_paused;
+    // frames that look like the one on screen are not drawn, 'D' draws every frame to compare
+    PresentFilter present_filter;
+    bool is_present_on_change_disabled;
+    BusyCounters reported;
+    
+    // the loop blocks on window messages and the timer when minimized, paused or without focus,
+    // 'I' turns that off to compare
+    IdleScheduler idle;
+    ThreadTimer timer;
+    bool is_focused;
+    bool is_idle_disabled;
+    
+    // 'V' turns vsync off and paces frames at FRAME_PACER_HZ instead, with vsync on the pacer only measures
+    FramePacer pacer;
+    bool is_vsync_disabled;
+    
+    bool is_quitting;
 } State;
 
-#define BALL_RADIUS (0.025f)
-#define PLAYER_SIZE ((float2){0.05f, 0.24f})
-#define INITIAL_BALL_VELOCITY ((float2){.x = 0.01f, .y = 0.0f})
+// (re)creates the overlay texture and the scaled texture at the size of the window, the next State_draw fills
+// them in. a smaller scale only uses the top left of them, so a change of scale does not create them again
+static void State_create_overlay_texture(State *const this)
+{
+    if (this->overlay_texture != NULL)
+    {
+        this->overlay_texture_view->lpVtbl->Release(this->overlay_texture_view);
+        this->overlay_target_view->lpVtbl->Release(this->overlay_target_view);
+        this->overlay_texture->lpVtbl->Release(this->overlay_texture);
+        
+        this->scaled_texture_view->lpVtbl->Release(this->scaled_texture_view);
+        this->scaled_target_view->lpVtbl->Release(this->scaled_target_view);
+        this->scaled_texture->lpVtbl->Release(this->scaled_texture);
+    }
+    
+    this->device->lpVtbl->CreateTexture2D(this->device,
+                                          &(D3D11_TEXTURE2D_DESC) {
+                                              .Width = (int unsigned) this->width,
+                                              .Height = (int unsigned) this->height,
+                                              .MipLevels = 1,
+                                              .ArraySize = 1,
+                                              .Format = DXGI_FORMAT_R32_FLOAT,
+                                              .SampleDesc.Count = 1,
+                                              .Usage = D3D11_USAGE_DEFAULT,
+                                              .BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE
+                                          }, NULL, &this->overlay_texture);
+    
+    this->device->lpVtbl->CreateRenderTargetView(this->device, (ID3D11Resource *) this->overlay_texture,
+                                                 NULL, &this->overlay_target_view);
+    this->device->lpVtbl->CreateShaderResourceView(this->device, (ID3D11Resource *) this->overlay_texture,
+                                                   NULL, &this->overlay_texture_view);
+    
+    this->device->lpVtbl->CreateTexture2D(this->device,
+                                          &(D3D11_TEXTURE2D_DESC) {
+                                              .Width = (int unsigned) this->width,
+                                              .Height = (int unsigned) this->height,
+                                              .MipLevels = 1,
+                                              .ArraySize = 1,
+                                              .Format = DXGI_FORMAT_R8G8B8A8_UNORM,
+                                              .SampleDesc.Count = 1,
+                                              .Usage = D3D11_USAGE_DEFAULT,
+                                              .BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE
+                                          }, NULL, &this->scaled_texture);
+    
+    this->device->lpVtbl->CreateRenderTargetView(this->device, (ID3D11Resource *) this->scaled_texture,
+                                                 NULL, &this->scaled_target_view);
+    this->device->lpVtbl->CreateShaderResourceView(this->device, (ID3D11Resource *) this->scaled_texture,
+                                                   NULL, &this->scaled_texture_view);
+    
+    this->is_overlay_texture_valid = false;
+    this->drawn_width = 0;
+    this->drawn_height = 0;
+}
+
+// (re)starts the pacer at FRAME_PACER_HZ without vsync, otherwise at the rate of the display to measure vsync
+static void State_init_pacer(State *const this)
+{
+    uint32_t hz = FRAME_PACER_HZ;
+    if (!this->is_vsync_disabled)
+    {
+        DEVMODEW mode = {.dmSize = sizeof(DEVMODEW)};
+        bool const has_mode = EnumDisplaySettingsW(NULL, ENUM_CURRENT_SETTINGS, &mode) != FALSE;
+
+        // 0 and 1 mean the default rate of the hardware
+        hz = has_mode && mode.dmDisplayFrequency > 1 ? (uint32_t) mode.dmDisplayFrequency : 60;
+    }
+
+    FramePacer_init(&this->pacer, hz, &frame_pacer_os_now, &frame_pacer_os_sleep, &this->timer);
+}
+
+// when the message being handled was posted, on the time_now_ns clock, so the time input waited in the
+// message queue counts as well. GetMessageTime is a GetTickCount reading and only as fine as the system
+// timer, 15.6 ms by default, so single events are off by up to that much but not on average
+static uint64_t message_time_ns(void)
+{
+    uint64_t const now_ns = time_now_ns();
+    DWORD const age_ms = GetTickCount() - (DWORD) GetMessageTime();
+
+    // anything older than a second is a message sent without the queue, which did not wait
+    return age_ms < 1000u ? now_ns - (uint64_t) age_ms * 1000000u : now_ns;
+}
 
 static LRESULT __stdcall WindowProc(HWND const window_handle, UINT const message,
                                     WPARAM const wParam, LPARAM const lParam)
@@ -180,6 +377,11 @@ static LRESULT __stdcall WindowProc(HWND const window_handle, UINT const message
 
             this->width = (int) lParam & 0xFFFF;
             this->height = ((int) lParam >> 16) & 0xFFFF;
+            if (this->width != 0 && this->height != 0)
+            {
+                Simulation_set_aspect_ratio(&this->simulation, (float) this->width / (float) this->height);
+            }
+            
             if ((this->width == old_width && this->height == old_height) ||
                 this->width == 0 || this->height == 0 || this->device == NULL) break;
             
@@ -209,6 +411,17 @@ static LRESULT __stdcall WindowProc(HWND const window_handle, UINT const message
                                                          (ID3D11Resource *) this->frame_buffer,
                                                          NULL, &this->frame_buffer_view);
             
+            State_create_overlay_texture(this);
+            
+            // the new buffers hold nothing yet, even when restoring from minimized at the same size
+            PresentFilter_invalidate(&this->present_filter);
+            
+            break;
+        }
+        
+        case WM_ACTIVATEAPP:
+        {
+            this->is_focused = wParam != FALSE;
             break;
         }
         
@@ -222,13 +435,8 @@ static LRESULT __stdcall WindowProc(HWND const window_handle, UINT const message
 
         case WM_MOUSEMOVE:
         {
-            if (!this->is_paused)
-            {
-                int const mouse_y = ((int) lParam >> 16) & 0xFFFF;
-                float const new_player_height = 1.0f - (float) mouse_y / (float) this->height;
-
-                this->player1.pos.y = fclamp(new_player_height, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
-            }
+            int const mouse_y = ((int) lParam >> 16) & 0xFFFF;
+            Input_mouse(&this->simulation.input, 1.0f - (float) mouse_y / (float) this->height, message_time_ns());
 
             break;
         }
@@ -236,13 +444,32 @@ static LRESULT __stdcall WindowProc(HWND const window_handle, UINT const message
         case WM_KEYUP:
         case WM_KEYDOWN:
         {
-            if (message == WM_KEYDOWN && wParam == 'P')
+            if (message == WM_KEYDOWN && wParam == 'L')
             {
-                this->is_paused ^= 1;
+                this->is_latch_disabled ^= 1;
+                this->simulation.input.present_latency = (LatencyStats) {0};
+            }
+            else if (message == WM_KEYDOWN && wParam == 'F')
+            {
+                this->is_resolution_fixed ^= 1;
+            }
+            else if (message == WM_KEYDOWN && wParam == 'D')
+            {
+                this->is_present_on_change_disabled ^= 1;
+            }
+            else if (message == WM_KEYDOWN && wParam == 'I')
+            {
+                this->is_idle_disabled ^= 1;
+            }
+            else if (message == WM_KEYDOWN && wParam == 'V')
+            {
+                this->is_vsync_disabled ^= 1;
+                State_init_pacer(this);
             }
             else if (((lParam >> 30) & 0x1) == ((lParam >> 31) & 0x1))
             {
-                KeyBitmap_flip(&this->keys, wParam);
+                // only the key going down or up, not the repeats while it is held
+                Input_key(&this->simulation.input, (int) wParam, message == WM_KEYDOWN, message_time_ns());
             }
 
             break;
@@ -287,6 +514,74 @@ static void State_create_window(State *const this,
     ShowWindow(this->window_handle, SW_SHOWDEFAULT);
 }
 
+// the cache goes into shader_cache next to the exe
+static void State_setup_shader_cache(State *const this)
+{
+    this->shader_source_hash = shader_source_hash();
+#ifdef SHADER_BYTECODE
+    this->is_bytecode_current = this->shader_source_hash == SHADER_BYTECODE_SOURCE_HASH;
+#endif
+    
+    char *const directory = this->shader_cache_directory;
+    DWORD length = GetModuleFileNameA(NULL, directory, SHADER_CACHE_MAX_PATH);
+    if (length == 0 || length >= SHADER_CACHE_MAX_PATH) length = 0;
+    while (length != 0 && directory[length - 1] != '\\') --length;
+    
+    char const name[] = "shader_cache\\";
+    if (length + sizeof(name) > SHADER_CACHE_MAX_PATH) length = 0;
+    for (size_t i = 0; i < sizeof(name); ++i) directory[length + i] = name[i];
+}
+
+// the bytecode of entry, compiled with SHADER_VARIANT defined to variant unless it is negative.
+// it is embedded if it was compiled from this shader_program, otherwise it is read from the cache or
+// compiled and stored in the cache for the next start. the bytecode read from the cache is only
+// there until the next call
+static ShaderBytecode State_load_shader(State *const this, char const *const entry, char const *const target,
+                                        int const variant, ShaderBytecode const embedded)
+{
+    if (this->is_bytecode_current && embedded.size != 0)
+    {
+        ++this->shader_origin_counts[SHADER_ORIGIN_EMBEDDED];
+        return embedded;
+    }
+    
+    uint32_t const flags = D3DCOMPILE_ENABLE_STRICTNESS;
+    uint64_t const key = shader_key(this->shader_source_hash, entry, target, variant, flags);
+    
+    static uint8_t cached_bytecode[SHADER_CACHE_MAX_SIZE];
+    size_t const cached_size = shader_cache_load(this->shader_cache_directory, key, cached_bytecode);
+    if (cached_size != 0)
+    {
+        ++this->shader_origin_counts[SHADER_ORIGIN_CACHE];
+        return (ShaderBytecode) {cached_bytecode, cached_size};
+    }
+    
+    char const variant_define[2] = {(char) ('0' + variant), '\0'};
+    D3D_SHADER_MACRO const defines[] = {{"SHADER_VARIANT", variant_define}, {NULL, NULL}};
+    
+    ID3DBlob *error_blob;
+    ID3DBlob *blob;
+    HRESULT const result = D3DCompile(shader_program, sizeof(shader_program), "main.hlsl",
+                                      variant < 0 ? NULL : defines, D3D_COMPILE_STANDARD_FILE_INCLUDE,
+                                      entry, target, flags, 0, &blob, &error_blob);
+#ifndef RELEASE_BUILD
+    if (FAILED(result))
+    {
+        MessageBoxA(this->window_handle, error_blob->lpVtbl->GetBufferPointer(error_blob), "error:", MB_OK);
+        ExitProcess(1);
+    }
+#endif
+    
+    (void)result;
+    (void)error_blob;
+    
+    ShaderBytecode const bytecode = {blob->lpVtbl->GetBufferPointer(blob), blob->lpVtbl->GetBufferSize(blob)};
+    shader_cache_store(this->shader_cache_directory, key, bytecode.code, bytecode.size);
+    
+    ++this->shader_origin_counts[SHADER_ORIGIN_COMPILED];
+    return bytecode;
+}
+
 static void State_setup_d3d(State *const this)
 {
     D3D_FEATURE_LEVEL const feature_levels[] = {D3D_FEATURE_LEVEL_11_1};
@@ -341,52 +636,73 @@ static void State_setup_d3d(State *const this)
                                                  (ID3D11Resource *) this->frame_buffer,
                                                  NULL, &this->frame_buffer_view);
     
-    ID3DBlob *error_blob;
-    ID3DBlob *vertex_shader_blob;
+    StartupTimeline_mark(&this->startup, "device and swap chain");
     
-    HRESULT result = D3DCompile(shader_program, sizeof(shader_program), "main.hlsl",
-                                NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                                "vs_main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0,
-                                &vertex_shader_blob, &error_blob);
-#ifndef RELEASE_BUILD
-    if (FAILED(result))
+    State_setup_shader_cache(this);
+    
+    ShaderBytecode const vertex_shader = State_load_shader(this, "vs_main", "vs_5_0", -1, SHADER_EMBEDDED(shader_vs_main));
+    this->device->lpVtbl->CreateVertexShader(this->device, vertex_shader.code, vertex_shader.size,
+                                             NULL, &this->vertex_shader);
+    
+    ShaderBytecode const embedded_pixel_shaders[SHADER_VARIANT_COUNT] = {
+        SHADER_EMBEDDED(shader_ps_main_0), SHADER_EMBEDDED(shader_ps_main_1),
+        SHADER_EMBEDDED(shader_ps_main_2), SHADER_EMBEDDED(shader_ps_main_3),
+    };
+    for (ShaderVariant variant = 0; variant < SHADER_VARIANT_COUNT; ++variant)
     {
-        MessageBoxA(this->window_handle, error_blob->lpVtbl->GetBufferPointer(error_blob), "error:", MB_OK);
-        ExitProcess(1);
+        ShaderBytecode const pixel_shader = State_load_shader(this, "ps_main", "ps_5_0", (int) variant,
+                                                              embedded_pixel_shaders[variant]);
+        this->device->lpVtbl->CreatePixelShader(this->device, pixel_shader.code, pixel_shader.size,
+                                                NULL, &this->pixel_shaders[variant]);
     }
-#endif
-    
-    (void)error_blob;
     
-    void *const vertex_shader_blob_buffer_pointer =
-        vertex_shader_blob->lpVtbl->GetBufferPointer(vertex_shader_blob);
+    ShaderBytecode const overlay_shader = State_load_shader(this, "ps_overlay", "ps_5_0", -1,
+                                                            SHADER_EMBEDDED(shader_ps_overlay));
+    this->device->lpVtbl->CreatePixelShader(this->device, overlay_shader.code, overlay_shader.size,
+                                            NULL, &this->overlay_shader);
     
-    size_t const vertex_shader_blob_buffer_size =
-        vertex_shader_blob->lpVtbl->GetBufferSize(vertex_shader_blob);
+    ShaderBytecode const upscale_shader = State_load_shader(this, "ps_upscale", "ps_5_0", -1,
+                                                            SHADER_EMBEDDED(shader_ps_upscale));
+    this->device->lpVtbl->CreatePixelShader(this->device, upscale_shader.code, upscale_shader.size,
+                                            NULL, &this->upscale_shader);
     
-    this->device->lpVtbl->CreateVertexShader(this->device,
-                                             vertex_shader_blob_buffer_pointer,
-                                             vertex_shader_blob_buffer_size,
-                                             NULL, &this->vertex_shader);
+    StartupTimeline_mark(&this->startup,
+                         this->shader_origin_counts[SHADER_ORIGIN_COMPILED] != 0 ? "shaders compiled" :
+                         this->shader_origin_counts[SHADER_ORIGIN_CACHE] != 0 ? "shaders read from the cache" :
+                         "shaders embedded");
     
-    ID3DBlob *pixel_shader_blob;
-    result = D3DCompile(shader_program, sizeof(shader_program), "main.hlsl",
-                        NULL, D3D_COMPILE_STANDARD_FILE_INCLUDE,
-                        "ps_main", "ps_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0,
-                        &pixel_shader_blob, &error_blob);
+    State_create_overlay_texture(this);
     
-#ifndef RELEASE_BUILD
-    if (FAILED(result))
+    for (int i = 0; i < GPU_TIMER_COUNT; ++i)
     {
-        MessageBoxA(this->window_handle, error_blob->lpVtbl->GetBufferPointer(error_blob), "error:", MB_OK);
-        ExitProcess(1);
+        GpuTimer *const timer = &this->gpu_timers[i];
+        this->device->lpVtbl->CreateQuery(this->device, &(D3D11_QUERY_DESC) {.Query = D3D11_QUERY_TIMESTAMP_DISJOINT},
+                                          &timer->disjoint);
+        this->device->lpVtbl->CreateQuery(this->device, &(D3D11_QUERY_DESC) {.Query = D3D11_QUERY_TIMESTAMP},
+                                          &timer->start);
+        this->device->lpVtbl->CreateQuery(this->device, &(D3D11_QUERY_DESC) {.Query = D3D11_QUERY_TIMESTAMP},
+                                          &timer->end);
+        this->device->lpVtbl->CreateQuery(this->device, &(D3D11_QUERY_DESC) {.Query = D3D11_QUERY_TIMESTAMP},
+                                          &timer->upscaled);
     }
-#endif
     
-    this->device->lpVtbl->CreatePixelShader(this->device,
-                                            pixel_shader_blob->lpVtbl->GetBufferPointer(pixel_shader_blob),
-                                            pixel_shader_blob->lpVtbl->GetBufferSize(pixel_shader_blob),
-                                            NULL, &this->pixel_shader);
+    ResolutionGovernor_init(&this->resolution, RESOLUTION_BUDGET_NS);
+    
+    this->device->lpVtbl->CreateBuffer(this->device,
+                                       &(D3D11_BUFFER_DESC) {
+                                           .ByteWidth = (int unsigned) sizeof(UpscaleConstants),
+                                           .Usage = D3D11_USAGE_DEFAULT,
+                                           .BindFlags  = D3D11_BIND_CONSTANT_BUFFER,
+                                       }, NULL, &this->upscale_buffer);
+    
+    this->device->lpVtbl->CreateSamplerState(this->device,
+                                             &(D3D11_SAMPLER_DESC) {
+                                                 .Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR,
+                                                 .AddressU       = D3D11_TEXTURE_ADDRESS_CLAMP,
+                                                 .AddressV       = D3D11_TEXTURE_ADDRESS_CLAMP,
+                                                 .AddressW       = D3D11_TEXTURE_ADDRESS_CLAMP,
+                                                 .ComparisonFunc = D3D11_COMPARISON_NEVER
+                                             }, &this->upscale_sampler);
     
     this->device->lpVtbl->CreateBuffer(this->device,
                                        &(D3D11_BUFFER_DESC) {
@@ -423,247 +739,435 @@ static void State_setup_d3d(State *const this)
                                                  .AddressW       = D3D11_TEXTURE_ADDRESS_WRAP,
                                                  .ComparisonFunc = D3D11_COMPARISON_NEVER
                                              }, &this->sampler_state);
+    
+    StartupTimeline_mark(&this->startup, "buffers and textures");
 }
 
-static void State_draw(State *const this)
+// adds the gpu time of the frame timer measured to the stats of its variant and the time with the upscale
+// to the resolution governor once the gpu got to it.
+// returns false while the gpu is still behind, the timer can not be used again until then
+static bool State_read_gpu_timer(State *const this, GpuTimer *const timer)
 {
+    if (!timer->is_pending) return true;
+    
+    ID3D11DeviceContext1 *const context = this->device_context;
+    D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+    uint64_t start;
+    uint64_t end;
+    uint64_t upscaled;
+    if (context->lpVtbl->GetData(context, (ID3D11Asynchronous *) timer->disjoint, &disjoint, sizeof(disjoint),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+        context->lpVtbl->GetData(context, (ID3D11Asynchronous *) timer->start, &start, sizeof(start),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+        context->lpVtbl->GetData(context, (ID3D11Asynchronous *) timer->end, &end, sizeof(end),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK ||
+        context->lpVtbl->GetData(context, (ID3D11Asynchronous *) timer->upscaled, &upscaled, sizeof(upscaled),
+                                 D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+    {
+        return false;
+    }
+    
+    // the timestamps mean nothing if the gpu changed its clock in between
+    if (!disjoint.Disjoint && end >= start && upscaled >= end && disjoint.Frequency != 0)
+    {
+        LatencyStats_add(&this->variant_gpu_time[timer->variant], (end - start) * 1000000000u / disjoint.Frequency);
+        this->gpu_busy_ns += (upscaled - start) * 1000000000u / disjoint.Frequency;
+        
+        // frames drawn while the scale is fixed say nothing about the scale the governor picked
+        if (!timer->is_resolution_fixed)
+        {
+            ResolutionGovernor_add(&this->resolution, (upscaled - start) * 1000000000u / disjoint.Frequency);
+        }
+    }
+    
+    timer->is_pending = false;
+    return true;
+}
+
+static void State_draw(State *const this, ShaderVariant const variant,
+                       int unsigned const player1_score, int unsigned const player2_score)
+{
+    // frames whose timer is still in flight are not timed. reading it first lets the governor pick the
+    // scale of this frame from the newest time
+    GpuTimer *const timer = &this->gpu_timers[this->gpu_timer_index];
+    bool const is_timed = State_read_gpu_timer(this, timer);
+    
+    bool const is_scaled = !this->is_resolution_fixed && this->resolution.scale != RESOLUTION_SCALE_ONE;
+    int const draw_width = is_scaled ? ResolutionGovernor_size(&this->resolution, this->width) : this->width;
+    int const draw_height = is_scaled ? ResolutionGovernor_size(&this->resolution, this->height) : this->height;
+    
+    if (draw_width != this->drawn_width || draw_height != this->drawn_height)
+    {
+        // the overlay texture is read a texel per pixel, so it is drawn again at the new size
+        this->is_overlay_texture_valid = false;
+        this->drawn_width = draw_width;
+        this->drawn_height = draw_height;
+        
+        // the centers of the first and last texel drawn to, half a texel in from the edge
+        UpscaleConstants const upscale_constants = {
+            .uv_scale = {(float) draw_width / (float) this->width, (float) draw_height / (float) this->height},
+            .uv_max = {((float) draw_width - 0.5f) / (float) this->width,
+                       ((float) draw_height - 0.5f) / (float) this->height},
+        };
+        this->device_context->lpVtbl->UpdateSubresource(this->device_context, (ID3D11Resource *) this->upscale_buffer,
+                                                        0, NULL, &upscale_constants, 0, 0);
+    }
+    
+    ID3D11RenderTargetView *const target_view = is_scaled ? this->scaled_target_view : this->frame_buffer_view;
+    
     // clear background color to black
     this->device_context->lpVtbl->ClearRenderTargetView(this->device_context,
-                                                        this->frame_buffer_view,
+                                                        target_view,
                                                         (float[4]) {[3] = 1.0f});
     
     // get the size of the portion of the window that we can draw to
     this->device_context->lpVtbl->RSSetViewports(this->device_context, 1,
                                                  &(D3D11_VIEWPORT) {
-                                                     .Width = (float)this->width,
-                                                     .Height = (float)this->height,
+                                                     .Width = (float)draw_width,
+                                                     .Height = (float)draw_height,
                                                      .MinDepth = 0.0f,
                                                      .MaxDepth = 1.0f,
                                                  });
     
-    this->device_context->lpVtbl->OMSetRenderTargets(this->device_context, 1, &this->frame_buffer_view, NULL);
-    
     this->device_context->lpVtbl->IASetPrimitiveTopology(this->device_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
     
     this->device_context->lpVtbl->VSSetShader(this->device_context, this->vertex_shader, NULL, 0);
-    this->device_context->lpVtbl->PSSetShader(this->device_context, this->pixel_shader, NULL, 0);
     
     this->device_context->lpVtbl->PSSetConstantBuffers(this->device_context, 0, 1, &this->constant_buffer);
     this->device_context->lpVtbl->PSSetShaderResources(this->device_context, 0, 1, &this->texture_view);
     this->device_context->lpVtbl->PSSetSamplers(this->device_context, 0, 1, &this->sampler_state);
     
-    // draw the shaders and swap the front/back buffer
-    this->device_context->lpVtbl->Draw(this->device_context, 4, 0);
-    this->swap_chain->lpVtbl->Present(this->swap_chain, 1, 0);
-}
-
-static void State_update_ai(State *const this, Player *const player, float const dt)
-{
-    float const correct_width = (float) this->width / (float) this->height;
-    if (this->ball_position.x > correct_width / 2 && this->ball_velocity.x > 0)
-    {
-        player->pos.y = flerp(player->pos.y, this->ball_position.y, dt);
-    }
-    else
+    // the scaled texture can not be read by ps_upscale and drawn to by ps_main at the same time either
+    this->device_context->lpVtbl->PSSetShaderResources(this->device_context, 2, 1,
+                                                       &(ID3D11ShaderResourceView *) {NULL});
+    
+    // the middle line and the digits are only drawn after a resize or a point, every other frame just loads them
+    if (!this->is_overlay_texture_valid ||
+        this->drawn_scores[0] != player1_score || this->drawn_scores[1] != player2_score)
     {
-        player->pos.y = flerp(player->pos.y, 0.5f, dt);
+        // the texture can not be read and drawn to at the same time
+        this->device_context->lpVtbl->PSSetShaderResources(this->device_context, 1, 1,
+                                                           &(ID3D11ShaderResourceView *) {NULL});
+        this->device_context->lpVtbl->OMSetRenderTargets(this->device_context, 1, &this->overlay_target_view, NULL);
+        this->device_context->lpVtbl->PSSetShader(this->device_context, this->overlay_shader, NULL, 0);
+        this->device_context->lpVtbl->Draw(this->device_context, 4, 0);
+        
+        this->drawn_scores[0] = player1_score;
+        this->drawn_scores[1] = player2_score;
+        this->is_overlay_texture_valid = true;
     }
     
-    player->pos.y = fclamp(player->pos.y, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
-}
-
-static inline void State_reset(State *const this)
-{
-    this->player1.pos.x = 0.1f;
-    this->player1.pos.y = 0.5f;
-    this->player2.pos.y = 0.5f;
+    this->device_context->lpVtbl->OMSetRenderTargets(this->device_context, 1, &target_view, NULL);
+    this->device_context->lpVtbl->PSSetShader(this->device_context, this->pixel_shaders[variant], NULL, 0);
+    this->device_context->lpVtbl->PSSetShaderResources(this->device_context, 1, 1, &this->overlay_texture_view);
     
-    this->player1.score = 0;
-    this->player2.score = 0;
-    this->player_mode = __rdtsc() % 2 != 0 ? PLAYER1_SERVE : PLAYER2_SERVE;
+    if (is_timed)
+    {
+        this->device_context->lpVtbl->Begin(this->device_context, (ID3D11Asynchronous *) timer->disjoint);
+        this->device_context->lpVtbl->End(this->device_context, (ID3D11Asynchronous *) timer->start);
+    }
     
-    this->game_mode = GAME_MODE_START;
-}
-
-static void State_update(State *const this, float const frame_delta)
-{
-    if (this->is_paused) return;
+    // draw the shaders and swap the front/back buffer
+    this->device_context->lpVtbl->Draw(this->device_context, 4, 0);
     
-    if (this->game_mode != GAME_MODE_START && KeyBitmap_get(this->keys, 'R'))
+    if (is_timed)
     {
-        State_reset(this);
+        this->device_context->lpVtbl->End(this->device_context, (ID3D11Asynchronous *) timer->end);
     }
     
-    if (KeyBitmap_get(this->keys, VK_UP))
+    if (is_scaled)
     {
-        this->player1.pos.y += 0.025f * frame_delta;
+        this->device_context->lpVtbl->OMSetRenderTargets(this->device_context, 1, &this->frame_buffer_view, NULL);
+        this->device_context->lpVtbl->RSSetViewports(this->device_context, 1,
+                                                     &(D3D11_VIEWPORT) {
+                                                         .Width = (float)this->width,
+                                                         .Height = (float)this->height,
+                                                         .MinDepth = 0.0f,
+                                                         .MaxDepth = 1.0f,
+                                                     });
+        
+        this->device_context->lpVtbl->PSSetShader(this->device_context, this->upscale_shader, NULL, 0);
+        this->device_context->lpVtbl->PSSetConstantBuffers(this->device_context, 1, 1, &this->upscale_buffer);
+        this->device_context->lpVtbl->PSSetShaderResources(this->device_context, 2, 1, &this->scaled_texture_view);
+        this->device_context->lpVtbl->PSSetSamplers(this->device_context, 1, 1, &this->upscale_sampler);
+        this->device_context->lpVtbl->Draw(this->device_context, 4, 0);
     }
     
-    if (KeyBitmap_get(this->keys, VK_DOWN))
+    if (is_timed)
     {
-        this->player1.pos.y -= 0.025f * frame_delta;
+        this->device_context->lpVtbl->End(this->device_context, (ID3D11Asynchronous *) timer->upscaled);
+        this->device_context->lpVtbl->End(this->device_context, (ID3D11Asynchronous *) timer->disjoint);
+        timer->variant = variant;
+        timer->is_resolution_fixed = this->is_resolution_fixed;
+        timer->is_pending = true;
+        this->gpu_timer_index = (this->gpu_timer_index + 1) % GPU_TIMER_COUNT;
     }
-
-    float const correct_width = (float) this->width / (float) this->height;
-
-    this->ball_position.x += this->ball_velocity.x * frame_delta;
-    this->ball_position.y += this->ball_velocity.y * frame_delta;
     
-    this->player2.pos.x = correct_width - this->player1.pos.x;
-    
-    State_update_ai(this, &this->player2, 0.0925f * frame_delta);
+    this->swap_chain->lpVtbl->Present(this->swap_chain, this->is_vsync_disabled ? 0 : 1, 0);
+}
 
-#define BOUNCE_STRENGTH (1.75f)
-    switch (this->player_mode)
+static uint64_t filetime_ns(FILETIME const time)
+{
+    return ((uint64_t) time.dwHighDateTime << 32 | time.dwLowDateTime) * 100u;
+}
+
+// the cpu time of the window thread and of the whole process and the gpu time so far
+static BusyCounters State_busy_counters(State const *const this)
+{
+    FILETIME creation_time;
+    FILETIME exit_time;
+    FILETIME kernel_time;
+    FILETIME user_time;
+    BusyCounters counters = {
+        .drawn_count = this->present_filter.drawn_count,
+        .skipped_count = this->present_filter.skipped_count,
+        .gpu_ns = this->gpu_busy_ns,
+    };
+    
+    if (GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time))
     {
-        case PLAYER1_SERVE:
-        {
-            this->ball_velocity = (float2) {0};
-            this->ball_position = (float2) {this->player1.pos.x + PLAYER_SIZE.x, this->player1.pos.y};
-            if (KeyBitmap_get(this->keys, ' '))
-            {
-                this->player_mode = PLAYER2_FACE;
-                this->ball_velocity = INITIAL_BALL_VELOCITY;
-                
-                this->game_mode = GAME_MODE_GAME;
-            }
-            
-            break;
-        }
-        
-        case PLAYER2_SERVE:
-        {
-            this->ball_velocity = (float2) {0};
-            this->ball_position = (float2) {this->player2.pos.x - PLAYER_SIZE.x, this->player2.pos.y};
-            
-            if (this->game_mode == GAME_MODE_GAME || KeyBitmap_get(this->keys, ' '))
-            {
-                this->player_mode = PLAYER1_FACE;
-                this->ball_velocity = (float2) {-INITIAL_BALL_VELOCITY.x, INITIAL_BALL_VELOCITY.y};
-                
-                this->game_mode = GAME_MODE_GAME;
-            }
-            
-            break;
-        }
-        
-        case PLAYER1_FACE:
-        {
-            if (this->ball_position.x - BALL_RADIUS <= this->player1.pos.x + PLAYER_SIZE.x / 2 &&
-                fabsf(this->ball_position.y - this->player1.pos.y) <= PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f)
-            {
-                float const percentage = (this->ball_position.y - this->player1.pos.y) / (PLAYER_SIZE.y / 2.0f);
-                this->ball_velocity.y = INITIAL_BALL_VELOCITY.x * percentage * BOUNCE_STRENGTH;
-                this->ball_velocity.x *= -1.0f;
-                
-                this->player_mode = PLAYER2_FACE;
-            }
-            
-            break;
-        }
-        
-        case PLAYER2_FACE:
-        {
-            if (this->ball_position.x + BALL_RADIUS >= this->player2.pos.x - PLAYER_SIZE.x / 2 &&
-                fabsf(this->ball_position.y - this->player2.pos.y) <= PLAYER_SIZE.y / 2.0f + BALL_RADIUS * 2.0f)
-            {
-                float const percentage = (this->ball_position.y - this->player2.pos.y) / (PLAYER_SIZE.y / 2.0f);
-                this->ball_velocity.y = INITIAL_BALL_VELOCITY.x * percentage * BOUNCE_STRENGTH;
-                this->ball_velocity.x *= -1.0f;
-                
-                this->player_mode = PLAYER1_FACE;
-            }
-            
-            break;
-        }
+        counters.thread_ns = filetime_ns(kernel_time) + filetime_ns(user_time);
     }
-#undef BOUNCE_STRENGTH
-    
-    if (this->ball_position.y - BALL_RADIUS < 0 || this->ball_position.y + BALL_RADIUS >= 1)
+    if (GetProcessTimes(GetCurrentProcess(), &creation_time, &exit_time, &kernel_time, &user_time))
     {
-        this->ball_velocity.y *= -1.0f;
+        counters.process_ns = filetime_ns(kernel_time) + filetime_ns(user_time);
     }
+    return counters;
+}
+
+// one line like "playing: 60 drawn 0 skipped, cpu 40.00 ms window thread 9.00 ms, gpu 30.00 ms\n" with what
+// happened since the last report, into buffer, which needs 128 bytes
+static void State_format_busy(State *const this, char const *const game_state, char *const buffer)
+{
+    BusyCounters const counters = State_busy_counters(this);
+    BusyCounters const *const reported = &this->reported;
+    
+    char *out = latency_write_string(buffer, game_state);
+    out = latency_write_string(out, ": ");
+    out = latency_write_uint(out, counters.drawn_count - reported->drawn_count);
+    out = latency_write_string(out, " drawn ");
+    out = latency_write_uint(out, counters.skipped_count - reported->skipped_count);
+    out = latency_write_string(out, " skipped, cpu ");
+    out = latency_write_ms(out, counters.process_ns - reported->process_ns);
+    out = latency_write_string(out, " ms window thread ");
+    out = latency_write_ms(out, counters.thread_ns - reported->thread_ns);
+    out = latency_write_string(out, " ms, gpu ");
+    out = latency_write_ms(out, counters.gpu_ns - reported->gpu_ns);
+    out = latency_write_string(out, " ms\n");
+    *out = '\0';
+    
+    this->reported = counters;
+}
+
+// blocks until a window message comes or wait_ns passed, see IdleScheduler
+static void State_wait(State *const this, IdleMode const mode, uint64_t const wait_ns)
+{
+    uint64_t const time_start = time_now_ns();
     
-    if (this->ball_position.x - BALL_RADIUS < 0)
+    // MWMO_INPUTAVAILABLE also wakes up for messages that were already there but not handled yet
+    if (this->timer.handle == NULL)
     {
-        ++this->player2.score;
-        this->player_mode = PLAYER2_SERVE;
+        MsgWaitForMultipleObjectsEx(0, NULL, (DWORD) (wait_ns / 1000000u), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
     }
-    else if(this->ball_position.x + BALL_RADIUS >= correct_width)
+    else
     {
-        ++this->player1.score;
-        this->player_mode = PLAYER1_SERVE;
+        // negative means relative, in 100 ns units
+        LARGE_INTEGER const due = {.QuadPart = -(LONGLONG) (wait_ns / 100u)};
+        SetWaitableTimer(this->timer.handle, &due, 0, NULL, NULL, FALSE);
+        MsgWaitForMultipleObjectsEx(1, &this->timer.handle, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
     }
     
-    this->ball_position.y = fclamp(this->ball_position.y, BALL_RADIUS, 1.0f - BALL_RADIUS);
+    IdleScheduler_waited(&this->idle, mode, time_now_ns() - time_start);
+    
+    // the frame after a wait is not late
+    FramePacer_reset(&this->pacer);
+}
+
+// handles one pending window message, see Input_pump
+static bool State_pump_message(void *const context)
+{
+    State *const this = context;
+    
+    MSG message;
+    if (!PeekMessageW(&message, NULL, 0, 0, PM_REMOVE)) return false;
+    
+    TranslateMessage(&message);
+    DispatchMessageW(&message);
+    
+    if (message.message == WM_QUIT) this->is_quitting = true;
+    return true;
 }
 
 __declspec(noreturn) void entry(void);
 __declspec(noreturn) void entry(void)
 {
     static State state;
+    state.startup.start_ns = time_os_ns();
+    
     State_create_window(&state, 900, 600, L"pong");
+    StartupTimeline_mark(&state.startup, "window");
+    
     State_setup_d3d(&state);
     
-    State_reset(&state);
+    time_init();
+    StartupTimeline_mark(&state.startup, "tsc calibration");
+    
+    Game *const game = &state.simulation.game;
+    game->player2_ai_gain = AI_GAIN;
+    game->aspect_ratio = (float) state.width / (float) state.height;
+    game->seed = (uint32_t) __rdtsc() | 1;
+    Game_reset(game);
+    
+    if (!Simulation_start(&state.simulation, SIMULATION_HZ)) ExitProcess(1);
+    StartupTimeline_mark(&state.startup, "simulation thread");
     
-    LARGE_INTEGER frequency;
-    QueryPerformanceFrequency(&frequency);
+    // a high resolution timer, the timeout of MsgWaitForMultipleObjectsEx has the 15.6 ms resolution of the
+    // system timer. without it the waits are only longer
+    ThreadTimer_init(&state.timer);
+    state.is_focused = GetForegroundWindow() == state.window_handle;
+    State_init_pacer(&state);
     
-    uint64_t time_last = __rdtsc();
+    FrameClock frame_clock;
+    FrameClock_init(&frame_clock);
+    uint64_t next_report_ns = frame_clock.last_ns + 1000000000u;
     
     for (;;)
     {
-        uint64_t const time_now = __rdtsc();
-        float const frame_delta = (float)((double)(time_now - time_last) / (double)frequency.QuadPart) / 2.3333f;
-        time_last = __rdtsc();
+        // keeps the tsc clock the simulation thread reads calibrated
+        FrameClock_delta_ns(&frame_clock);
         
-        MSG message;
-        if (PeekMessageW(&message, NULL, 0, 0, PM_REMOVE))
+        // push every pending message to the simulation thread before looking at what to draw
+        uint32_t const pumped_count = Input_pump(&state.simulation.input, &State_pump_message, &state,
+                                                 INPUT_PUMP_BUDGET_NS);
+        if (pumped_count != 0) Simulation_wake(&state.simulation);
+        
+        if (state.is_quitting) break;
+        
+        // a minimized game stands still, nobody could see the ai score. nobody looks closely at a window
+        // without focus, so the simulation steps in batches then
+        bool const is_minimized = state.width == 0 || state.height == 0;
+        IdleMode const mode = state.is_idle_disabled ? IDLE_MODE_ACTIVE :
+            idle_mode(is_minimized, state.is_focused, Simulation_is_paused(&state.simulation));
+        Simulation_set_pacing(&state.simulation, is_minimized ? SIMULATION_PACING_PARKED :
+                              state.is_idle_disabled ? SIMULATION_PACING_SPIN :
+                              mode == IDLE_MODE_BACKGROUND ? SIMULATION_PACING_BACKGROUND : SIMULATION_PACING_FOREGROUND);
+        
+        // minimized, or a frame without focus that is not due yet
+        uint64_t const wait_ns = IdleScheduler_wait_before_ns(&state.idle, mode, time_now_ns());
+        if (wait_ns != 0)
         {
-            TranslateMessage(&message);
-            DispatchMessageW(&message);
-            
-            if (message.message == WM_QUIT) break;
+            State_wait(&state, mode, wait_ns);
+            continue;
         }
         
-        // TODO: properly handle minimization
-        if (state.width == 0 || state.height == 0) continue;
+        // only with the idle scheduler turned off
+        if (is_minimized) continue;
         
-        D3D11_MAPPED_SUBRESOURCE mapped_subresource;
-        state.device_context->lpVtbl->Map(state.device_context,
-                                          (ID3D11Resource *) state.constant_buffer, 0,
-                                          D3D11_MAP_WRITE_DISCARD, 0, &mapped_subresource);
+        // without vsync nothing else keeps the loop from drawing as fast as it can
+        if (state.is_vsync_disabled) FramePacer_wait(&state.pacer);
         
-        ShaderConstants *const shader_constants = mapped_subresource.pData;
+        // draw the newest step the simulation finished, at 1 khz interpolating between steps is not worth it.
+        // the paddle under the mouse is latched as late as possible, right before the constants are written
+        TripleBuffer_acquire(&state.simulation.snapshots);
+        GameSnapshot snapshot = *TripleBuffer_front(&state.simulation.snapshots);
+        uint32_t const shown_input_count = state.is_latch_disabled ?
+            snapshot.input_count : Simulation_latch_mouse(&state.simulation, &snapshot);
         
-        shader_constants->player_size = PLAYER_SIZE;
-        shader_constants->player1_position = state.player1.pos;
-        shader_constants->player2_position = state.player2.pos;
+        ShaderConstants constants;
+        constants.player_size = PLAYER_SIZE;
+        constants.player1_position = snapshot.player1_position;
+        constants.player2_position = snapshot.player2_position;
         
-        shader_constants->ball_position = state.ball_position;
-        shader_constants->ball_radius = BALL_RADIUS;
-        shader_constants->aspect_ratio = (float) state.width / (float) state.height;
+        constants.ball_position = snapshot.ball_position;
+        constants.ball_radius = BALL_RADIUS;
+        constants.aspect_ratio = (float) state.width / (float) state.height;
+        
+        constants.player1_score = snapshot.player1_score;
+        constants.player2_score = snapshot.player2_score;
+        
+        // while paused or waiting for a serve most frames look like the one on screen, see present.h
+        if (state.is_present_on_change_disabled) PresentFilter_invalidate(&state.present_filter);
+        int const scale = state.is_resolution_fixed ? RESOLUTION_SCALE_ONE : state.resolution.scale;
+        bool const is_drawn = PresentFilter_update(&state.present_filter, &constants, state.width, state.height, scale);
+        
+        if (is_drawn)
+        {
+            D3D11_MAPPED_SUBRESOURCE mapped_subresource;
+            state.device_context->lpVtbl->Map(state.device_context,
+                                              (ID3D11Resource *) state.constant_buffer, 0,
+                                              D3D11_MAP_WRITE_DISCARD, 0, &mapped_subresource);
+            
+            // the mapped buffer should only be written to
+            *(ShaderConstants *) mapped_subresource.pData = constants;
+            
+            state.device_context->lpVtbl->Unmap(state.device_context,
+                                                (ID3D11Resource *) state.constant_buffer, 0);
+            
+            State_draw(&state, shader_variant(&constants), snapshot.player1_score, snapshot.player2_score);
+            
+            // present returns once vsync let it, which is what the jitter of vsync is measured from
+            if (!state.is_vsync_disabled) FramePacer_mark(&state.pacer, time_now_ns());
+        }
         
-        shader_constants->player1_score = state.player1.score;
-        shader_constants->player2_score = state.player2.score;
+        if (!state.startup.is_done)
+        {
+            StartupTimeline_mark(&state.startup, "first present");
+            StartupTimeline_print(&state.startup);
+            state.startup.is_done = true;
+        }
         
-        state.device_context->lpVtbl->Unmap(state.device_context,
-                                            (ID3D11Resource *) state.constant_buffer, 0);
+        // the log of the governor, a line per change of scale as they happen
+        for (; state.logged_change_count < state.resolution.change_count; ++state.logged_change_count)
+        {
+            char line[128];
+            ResolutionChange_format(&state.resolution.log[state.logged_change_count % RESOLUTION_LOG_CAPACITY], line);
+            OutputDebugStringA(line);
+        }
         
-        State_draw(&state);
+        // a frame that was not drawn looks like the one on screen, which already shows the input then
+        uint64_t const present_ns = time_now_ns();
+        Input_presented(&state.simulation.input, shown_input_count, present_ns);
         
-        State_update(&state, frame_delta);
+        if (present_ns >= next_report_ns)
+        {
+            char line[128];
+            if (state.simulation.input.present_latency.count != 0)
+            {
+                LatencyStats_format(&state.simulation.input.present_latency, state.is_latch_disabled ?
+                                    "mouse to present" : "mouse to present, late latched", line);
+                OutputDebugStringA(line);
+                // the simulation thread keeps adding to these while they are read, which is fine for a debug line
+                LatencyStats_format(&state.simulation.input.queue_latency, "input queue", line);
+                OutputDebugStringA(line);
+            }
+            
+            bool const is_serving = snapshot.player_mode == PLAYER1_SERVE || snapshot.player_mode == PLAYER2_SERVE;
+            IdleMode const shown_mode = idle_mode(false, state.is_focused, Simulation_is_paused(&state.simulation));
+            State_format_busy(&state, shown_mode != IDLE_MODE_ACTIVE ? IdleMode_name(shown_mode) :
+                              is_serving ? "serving" : "playing", line);
+            OutputDebugStringA(line);
+            
+            ResolutionGovernor_format(&state.resolution, line);
+            OutputDebugStringA(line);
+            
+            FramePacer_format(&state.pacer, state.is_vsync_disabled ? "pacer" : "vsync", line);
+            OutputDebugStringA(line);
+            
+            OutputDebugStringA("gpu time of the frame pass per shader variant\n");
+            for (ShaderVariant variant = 0; variant < SHADER_VARIANT_COUNT; ++variant)
+            {
+                if (state.variant_gpu_time[variant].count == 0) continue;
+                
+                LatencyStats_format(&state.variant_gpu_time[variant], ShaderVariant_name(variant), line);
+                OutputDebugStringA(line);
+            }
+            next_report_ns = present_ns + 1000000000u;
+        }
         
-        (void)shader_constants->player_size;
-        (void)shader_constants->ball_radius;
-        (void)shader_constants->aspect_ratio;
-        (void)shader_constants->ball_position;
-        (void)shader_constants->player1_position;
-        (void)shader_constants->player2_position;
-        (void)shader_constants->player1_score;
-        (void)shader_constants->player2_score;
+        // without a present to wait for vsync in, wait for input or for the simulation to move on
+        if (!is_drawn) State_wait(&state, mode, IdleScheduler_wait_after_ns(&state.idle, mode, pumped_count));
     }
     
+    Simulation_stop(&state.simulation);
     ExitProcess(0);
 }
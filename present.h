@@ -0,0 +1,55 @@
+#pragma once
+
+// present on change. a frame is only drawn and presented when something it is drawn from differs from the
+// frame on screen, so while the game is paused or waits for a serve the window thread neither maps the
+// constant buffer nor keeps the gpu busy, it waits for input or PRESENT_IDLE_WAIT_MS instead.
+// the constants are compared in full rather than hashed, they are only 48 bytes.
+// needs shader.h
+
+// how long a frame that was not drawn waits for a window message, about a frame at 60 hz, so changes that
+// come from the simulation thread alone still show up within a frame or so
+#define PRESENT_IDLE_WAIT_MS (16)
+
+// the simulation thread needs a step or two to turn input into a new snapshot, a frame that was not drawn
+// right after input only waits this long so a key press does not wait for PRESENT_IDLE_WAIT_MS
+#define PRESENT_SETTLE_NS (2000000u)
+
+typedef struct PresentFilter
+{
+    // what the frame on screen was drawn from
+    ShaderConstants constants;
+    int width;
+    int height;
+    int scale;
+    bool is_valid;
+
+    uint64_t drawn_count;
+    uint64_t skipped_count;
+} PresentFilter;
+
+// returns true if a frame drawn from constants at width by height and scale, see resolution.h, would differ
+// from the one on screen and should be drawn and presented, and then counts it as the one on screen
+static bool PresentFilter_update(PresentFilter *const this, ShaderConstants const *const constants,
+                                 int const width, int const height, int const scale)
+{
+    if (this->is_valid && this->width == width && this->height == height && this->scale == scale &&
+        ShaderConstants_equal(&this->constants, constants))
+    {
+        ++this->skipped_count;
+        return false;
+    }
+
+    this->constants = *constants;
+    this->width = width;
+    this->height = height;
+    this->scale = scale;
+    this->is_valid = true;
+    ++this->drawn_count;
+    return true;
+}
+
+// the next frame is drawn no matter what, for when the frame on screen may be gone
+static inline void PresentFilter_invalidate(PresentFilter *const this)
+{
+    this->is_valid = false;
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+// a cpu version of ps_main in shader.h, so frames can be drawn and checked without d3d11.
+// every function follows the hlsl one of the same name step by step in float, the only things the gpu
+// may do differently are the precision of its length and log and the fixed point weights of its
+// texture filter, so pixels can be off by one step of a color channel but never by more.
+// needs vec.h, font.h and shader.h
+
+// a framebuffer of RGBA8 pixels, red in the lowest byte, rows pitch pixels apart
+typedef struct RenderTarget
+{
+    uint32_t *pixels;
+    int width;
+    int height;
+    int pitch;
+} RenderTarget;
+
+// the shapes ps_main draws, a renderer may leave out the ones it knows cannot touch the pixels it shades
+typedef enum RenderShape
+{
+    RENDER_SHAPE_BALL = 1 << 0,
+    RENDER_SHAPE_PLAYER1 = 1 << 1,
+    RENDER_SHAPE_PLAYER2 = 1 << 2,
+    RENDER_SHAPE_MIDDLE_LINE = 1 << 3,
+    RENDER_SHAPE_PLAYER1_SCORE = 1 << 4,
+    RENDER_SHAPE_PLAYER2_SCORE = 1 << 5,
+
+    RENDER_SHAPES_MOVING = RENDER_SHAPE_BALL | RENDER_SHAPE_PLAYER1 | RENDER_SHAPE_PLAYER2,
+    RENDER_SHAPES_ALL = (1 << 6) - 1,
+} RenderShape;
+
+// the distance a moving shape that was left out stands in for. smin of it and anything closer than
+// 0.05 is that closer distance and its color blend is 0, so as long as the shape really is more than
+// RENDER_CULL_MARGIN away from every pixel shaded (see render_tiles.h) the pixels come out the same
+#define RENDER_SHAPE_FAR (1e30f)
+
+// the mask of a score or the middle line drawn ahead of time for the pixels from (x0, y0) up to but not
+// including (x1, y1), rows x1 - x0 apart. the mask is 0 everywhere else, see render_score.h and render_background.h
+typedef struct RenderMaskImage
+{
+    float *masks;
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} RenderMaskImage;
+
+// what ps_main computes per pixel that is the same for every pixel of a frame
+typedef struct RenderScene
+{
+    ShaderConstants constants;
+    float player1_score_log10;
+    float player2_score_log10;
+
+    // NULL or the images of player1's and player2's score for the size of the target drawn into,
+    // which are used instead of decoding the digits for every pixel
+    RenderMaskImage const *score_images;
+
+    // NULL or the image of the middle line for the size of the target drawn into
+    RenderMaskImage const *middle_line_image;
+
+    // which permutation of ps_main to follow, render_scene picks SHADER_VARIANT_FULL
+    ShaderVariant variant;
+} RenderScene;
+
+// see https://www.iquilezles.org/www/articles/smin/smin.htm
+static inline float render_smin(float const a, float const b, float const k)
+{
+    float const h = fmaxf(k - fabsf(a - b), 0.0f) / k;
+    return fminf(a, b) - h * h * h * k * (1.0f / 6.0f);
+}
+
+static inline float render_circle_sdf(float2 const coords, float2 const position, float const radius)
+{
+    return flength2(f2sub2(coords, position)) - radius;
+}
+
+static inline float render_rectangle_sdf(float2 const coords, float2 const position, float2 const half_size)
+{
+    float2 const component_wise_edge_distance = {
+        fabsf(coords.x - position.x) - half_size.x,
+        fabsf(coords.y - position.y) - half_size.y,
+    };
+    float const outside_distance = flength2((float2) {
+        fmaxf(component_wise_edge_distance.x, 0.0f),
+        fmaxf(component_wise_edge_distance.y, 0.0f),
+    });
+    float const inside_distance = fminf(fmaxf(component_wise_edge_distance.x, component_wise_edge_distance.y), 0.0f);
+    return outside_distance + inside_distance;
+}
+
+static inline float render_bl_rectangle_sdf(float2 const coords, float2 const position, float2 const size)
+{
+    float2 const half_size = f2divf(size, 2.0f);
+    return render_rectangle_sdf(coords, f2add2(position, half_size), half_size);
+}
+
+static inline float render_sdf_to_mask(float const sdf)
+{
+    return fsmoothstep(0.002f, 0.001f, sdf);
+}
+
+static inline float render_median(float const x, float const y, float const z, float const w)
+{
+    return (x + y + z + w) - fminf(x, fminf(y, fminf(z, w))) - fmaxf(x, fmaxf(y, fmaxf(z, w)));
+}
+
+// font_texture.Sample with the sampler of State_setup_d3d, bilinear and wrapping, then the median of it
+static float render_font_median(float2 const coords)
+{
+    float const u = coords.x * (float) TEXTURE_WIDTH - 0.5f;
+    float const v = coords.y * (float) TEXTURE_HEIGHT - 0.5f;
+    float const u0 = ffloor(u);
+    float const v0 = ffloor(v);
+    float const fraction_u = u - u0;
+    float const fraction_v = v - v0;
+
+    int const x0 = ((int) u0 % TEXTURE_WIDTH + TEXTURE_WIDTH) % TEXTURE_WIDTH;
+    int const y0 = ((int) v0 % TEXTURE_HEIGHT + TEXTURE_HEIGHT) % TEXTURE_HEIGHT;
+    int const x1 = (x0 + 1) % TEXTURE_WIDTH;
+    int const y1 = (y0 + 1) % TEXTURE_HEIGHT;
+
+    unsigned char const *const texel00 = &font_texture_bin[(y0 * TEXTURE_WIDTH + x0) * 4];
+    unsigned char const *const texel10 = &font_texture_bin[(y0 * TEXTURE_WIDTH + x1) * 4];
+    unsigned char const *const texel01 = &font_texture_bin[(y1 * TEXTURE_WIDTH + x0) * 4];
+    unsigned char const *const texel11 = &font_texture_bin[(y1 * TEXTURE_WIDTH + x1) * 4];
+
+    float channels[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        float const top = flerp((float) texel00[i] / 255.0f, (float) texel10[i] / 255.0f, fraction_u);
+        float const bottom = flerp((float) texel01[i] / 255.0f, (float) texel11[i] / 255.0f, fraction_u);
+        channels[i] = flerp(top, bottom, fraction_v);
+    }
+
+    return render_median(channels[0], channels[1], channels[2], channels[3]);
+}
+
+static float render_number_text_mask(float2 coords, float2 const position, float const scale,
+                                     uint32_t number, float const number_log)
+{
+    coords = f2mulf(f2sub2(coords, position), scale);
+
+    static float2 const offsets[] = {
+        {0.225f * 0.0f, 0.3375f * 2.0f}, // 0
+        {0.225f * 3.0f, 0.3375f * 2.0f}, // 1
+        {0.225f * 2.0f, 0.3375f * 1.0f}, // 2
+        {0.225f * 3.0f, 0.3375f * 1.0f}, // 3
+        {0.225f * 1.0f, 0.3375f * 0.0f}, // 4
+        {0.225f * 1.0f, 0.3375f * 1.0f}, // 5
+        {0.225f * 0.0f, 0.3375f * 1.0f}, // 6
+        {0.225f * 0.0f, 0.3375f * 0.0f}, // 7
+        {0.225f * 2.0f, 0.3375f * 2.0f}, // 8
+        {0.225f * 1.0f, 0.3375f * 2.0f}, // 9
+    };
+
+    static float const kerning[] = {
+        0.005f, // 0
+        0.0085f, // 1
+        0.04f, // 2
+        0.05f, // 3
+        0.01f, // 4
+        0.02f, // 5
+        0.0f, // 6
+        0.0f, // 7
+        0.025f, // 8
+        0.0f, // 9
+    };
+
+    float result = 0.0f;
+
+    for (float i = 0.0f; i < 9; ++i)
+    {
+        uint32_t const digit = number % 10;
+        float2 const digit_position = {0.225f * (number_log - 1 - i), 0.0f};
+        float letter_mask = render_font_median((float2) {
+            coords.x - digit_position.x + offsets[digit].x + kerning[digit],
+            coords.y - digit_position.y + offsets[digit].y,
+        });
+
+        letter_mask = fminf(letter_mask,
+                            render_sdf_to_mask(render_bl_rectangle_sdf(coords, digit_position,
+                                                                       (float2) {0.2365f, 0.3375f})));
+
+        result = fmaxf(result, letter_mask);
+        number /= 10;
+
+        if (number == 0) break;
+    }
+
+    return fsmoothstep(1.0f - 0.5f, 1.0f, result);
+}
+
+static inline float render_middle_line_mask(float2 const coords, float const aspect_ratio)
+{
+    float middle_line = fabsf(coords.x - 0.5f * aspect_ratio) - 0.005f;
+    float const middle_line_pattern = ffmod(fabsf(coords.y) + 0.01f, 0.1f) - 0.025f;
+    middle_line = fmaxf(middle_line, -middle_line_pattern);
+    return render_sdf_to_mask(middle_line);
+}
+
+static inline float render_mask_image(RenderMaskImage const *const image, int const x, int const y)
+{
+    if (x < image->x0 || x >= image->x1 || y < image->y0 || y >= image->y1) return 0.0f;
+    return image->masks[(size_t) (y - image->y0) * (size_t) (image->x1 - image->x0) + (size_t) (x - image->x0)];
+}
+
+static RenderScene render_scene(ShaderConstants const *const constants)
+{
+    return (RenderScene) {
+        .constants = *constants,
+        .player1_score_log10 = ffloor(flog((float) (constants->player1_score + 1)) / flog(10.0f)),
+        .player2_score_log10 = ffloor(flog((float) (constants->player2_score + 1)) / flog(10.0f)),
+    };
+}
+
+// ps_main for the pixel (x, y) of the target at texture_coord, (0, 0) is the bottom left corner of the screen,
+// leaving out the shapes that are not in shapes
+static float3 render_pixel(RenderScene const *const scene, uint32_t const shapes, float2 const texture_coord,
+                           int const x, int const y)
+{
+    ShaderConstants const *const constants = &scene->constants;
+    float const aspect_ratio = constants->aspect_ratio;
+    float2 const coords = {texture_coord.x * aspect_ratio, texture_coord.y};
+    float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+
+    float player1_score_mask = 0.0f;
+    float player2_score_mask = 0.0f;
+    if (scene->score_images != NULL)
+    {
+        if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0) player1_score_mask = render_mask_image(&scene->score_images[0], x, y);
+        if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0) player2_score_mask = render_mask_image(&scene->score_images[1], x, y);
+    }
+    else
+    {
+        if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0)
+        {
+            player1_score_mask = render_number_text_mask(coords, (float2) {0.085f, 0.87f}, 5.0f,
+                                                         constants->player1_score, scene->player1_score_log10);
+        }
+        if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0)
+        {
+            player2_score_mask = render_number_text_mask(coords, (float2) {aspect_ratio - 0.075f - scene->player2_score_log10 * 0.225f / 5.0f, 0.87f},
+                                                         5.0f, constants->player2_score, scene->player2_score_log10);
+        }
+    }
+    float middle_line_mask = 0.0f;
+    if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0 && scene->middle_line_image != NULL)
+    {
+        middle_line_mask = render_mask_image(scene->middle_line_image, x, y);
+    }
+    else if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0)
+    {
+        middle_line_mask = render_middle_line_mask(coords, aspect_ratio);
+    }
+
+    float const overlay_mask = fmaxf(fmaxf(player1_score_mask, player2_score_mask), middle_line_mask);
+    if ((shapes & RENDER_SHAPES_MOVING) == 0) return (float3) {overlay_mask, overlay_mask, overlay_mask};
+
+    float const ball = (shapes & RENDER_SHAPE_BALL) == 0 ? RENDER_SHAPE_FAR :
+        render_circle_sdf(coords, constants->ball_position, constants->ball_radius);
+    float const player1 = (shapes & RENDER_SHAPE_PLAYER1) == 0 ? RENDER_SHAPE_FAR :
+        render_rectangle_sdf(coords, constants->player1_position, half_player_size);
+    float const player2 = (shapes & RENDER_SHAPE_PLAYER2) == 0 ? RENDER_SHAPE_FAR :
+        render_rectangle_sdf(coords, constants->player2_position, half_player_size);
+
+    float final_sdf;
+    float3 final_color = {0.0f, 0.0f, 0.0f};
+    if (scene->variant == SHADER_VARIANT_APART)
+    {
+        final_sdf = fminf(ball, fminf(player1, player2));
+        final_color = ball <= fminf(player1, player2) ? (float3) {0, 0, 1} :
+                      player2 <= player1 ? (float3) {0, 1, 0} : (float3) {1, 0, 0};
+    }
+    else
+    {
+        switch (scene->variant)
+        {
+            case SHADER_VARIANT_PLAYER1: final_sdf = fminf(render_smin(ball, player1, 0.05f), player2); break;
+            case SHADER_VARIANT_PLAYER2: final_sdf = fminf(render_smin(ball, player2, 0.05f), player1); break;
+            default: final_sdf = render_smin(ball, fminf(player1, player2), 0.05f); break;
+        }
+
+        final_color = flerp3(final_color, (float3) {1, 0, 0}, fsmoothstep(player1 - 0.05f, player1, final_sdf));
+        final_color = flerp3(final_color, (float3) {0, 1, 0}, fsmoothstep(player2 - 0.05f, player2, final_sdf));
+        final_color = flerp3(final_color, (float3) {0, 0, 1}, fsmoothstep(ball - 0.05f, ball, final_sdf));
+    }
+
+    float const final_mask = render_sdf_to_mask(final_sdf);
+
+    return flerp3((float3) {overlay_mask, overlay_mask, overlay_mask}, final_color, final_mask);
+}
+
+// the same conversion to unorm as the swap chain does
+static inline uint32_t render_pack(float3 const color)
+{
+    uint32_t const r = (uint32_t) (fclamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    uint32_t const g = (uint32_t) (fclamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+    uint32_t const b = (uint32_t) (fclamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return r | g << 8 | b << 16 | 0xFF000000u;
+}
+
+// shades the pixels from (x0, y0) up to but not including (x1, y1), y grows downwards like in the framebuffer
+static void render_rect(RenderTarget const *const target, RenderScene const *const scene, uint32_t const shapes,
+                        int const x0, int const y0, int const x1, int const y1)
+{
+    float const inverse_width = 1.0f / (float) target->width;
+    float const inverse_height = 1.0f / (float) target->height;
+    for (int y = y0; y < y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+        float const texture_y = 1.0f - ((float) y + 0.5f) * inverse_height;
+        for (int x = x0; x < x1; ++x)
+        {
+            float2 const texture_coord = {((float) x + 0.5f) * inverse_width, texture_y};
+            row[x] = render_pack(render_pixel(scene, shapes, texture_coord, x, y));
+        }
+    }
+}
+
+static void render_frame(RenderTarget const *const target, ShaderConstants const *const constants)
+{
+    RenderScene const scene = render_scene(constants);
+    render_rect(target, &scene, RENDER_SHAPES_ALL, 0, 0, target->width, target->height);
+}
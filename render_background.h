@@ -0,0 +1,88 @@
+#pragma once
+
+// keeps the static layer of a frame, the black background and the dashed middle line, which only depend
+// on the size of the target. the line is drawn once per size into a strip as wide as its bounds in
+// render_tiles.h, the background is what every pixel without a mask is anyway, so a frame reads the strip
+// instead of working out abs, fmod and max per pixel. the masks come from render_middle_line_mask, so
+// frames drawn with the cache are the same.
+// needs timing.h, render.h and render_tiles.h
+
+typedef struct RenderBackgroundCache
+{
+    RenderMaskImage middle_line_image;
+    size_t capacity;
+
+    // what the strip was drawn for
+    int width;
+    int height;
+    float aspect_ratio;
+    bool is_valid;
+
+    uint64_t update_count;
+    uint64_t update_ns;
+} RenderBackgroundCache;
+
+// points scene at the middle line for target, drawing it first if the size changed.
+// leaves scene alone when there is no memory for it, which only makes the frame slower
+static void RenderBackgroundCache_update(RenderBackgroundCache *const this, RenderTarget const *const target,
+                                         RenderScene *const scene)
+{
+    float const aspect_ratio = scene->constants.aspect_ratio;
+    if (!this->is_valid || this->width != target->width || this->height != target->height ||
+        this->aspect_ratio != aspect_ratio)
+    {
+        uint64_t const time_start = time_now_ns();
+
+        RenderBounds bounds[RENDER_SHAPE_COUNT];
+        render_tiles_shape_bounds(target, scene, bounds);
+
+        RenderMaskImage *const image = &this->middle_line_image;
+        image->x0 = bounds[3].x0 > 0 ? bounds[3].x0 : 0;
+        image->y0 = 0;
+        image->x1 = bounds[3].x1 < target->width ? bounds[3].x1 : target->width;
+        image->y1 = target->height;
+        if (image->x1 < image->x0) image->x1 = image->x0;
+
+        size_t const image_width = (size_t) (image->x1 - image->x0);
+        size_t const size = image_width * (size_t) target->height;
+        if (size > this->capacity)
+        {
+            float *const masks = realloc(image->masks, size * sizeof(float));
+            this->is_valid = masks != NULL;
+            if (masks == NULL) return;
+
+            image->masks = masks;
+            this->capacity = size;
+        }
+
+        // the same coordinates as render_rect
+        float const inverse_width = 1.0f / (float) target->width;
+        float const inverse_height = 1.0f / (float) target->height;
+        for (int y = image->y0; y < image->y1; ++y)
+        {
+            float *const row = &image->masks[(size_t) (y - image->y0) * image_width];
+            float const texture_y = 1.0f - ((float) y + 0.5f) * inverse_height;
+            for (int x = image->x0; x < image->x1; ++x)
+            {
+                float2 const coords = {((float) x + 0.5f) * inverse_width * aspect_ratio, texture_y};
+                row[x - image->x0] = render_middle_line_mask(coords, aspect_ratio);
+            }
+        }
+
+        this->width = target->width;
+        this->height = target->height;
+        this->aspect_ratio = aspect_ratio;
+        this->is_valid = true;
+
+        ++this->update_count;
+        this->update_ns += time_now_ns() - time_start;
+    }
+
+    scene->middle_line_image = &this->middle_line_image;
+}
+
+static void RenderBackgroundCache_free(RenderBackgroundCache *const this)
+{
+    free(this->middle_line_image.masks);
+    *this = (RenderBackgroundCache) {0};
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+// draws frames of render.h into a framebuffer that is kept from one frame to the next and only shades
+// again where the ball or a paddle was or now is. the bounds of render_tiles.h already hold every pixel
+// a moving shape can change, outside of them the pixels only depend on the middle line and the scores,
+// so they are left alone unless the scores, the size of the target or the shapes themselves change.
+// needs render.h, render_simd.h and render_tiles.h
+
+// the old and the new bounds of each moving shape
+#define RENDER_DIRTY_MAX_RECTS (3 * 2)
+
+typedef struct RenderDirty
+{
+    // what the framebuffer shows, is_valid is false until the first frame is drawn into it
+    RenderTarget target;
+    ShaderConstants constants;
+    RenderBounds bounds[RENDER_SHAPE_COUNT];
+    bool is_valid;
+
+    // the last frame
+    RenderBounds rects[RENDER_DIRTY_MAX_RECTS];
+    int rect_count;
+    uint64_t shaded_count;
+    bool was_full;
+} RenderDirty;
+
+// the framebuffer changed behind the renderer's back, the next frame is drawn in full
+static inline void RenderDirty_invalidate(RenderDirty *const this)
+{
+    this->is_valid = false;
+}
+
+static inline int64_t render_dirty_area(RenderBounds const *const rect)
+{
+    return (int64_t) (rect->x1 - rect->x0) * (int64_t) (rect->y1 - rect->y0);
+}
+
+// adds rect clipped to the target, merging it with a rect it overlaps as long as that does not shade
+// more pixels than keeping them apart does. overlapping rects that are kept apart are shaded twice,
+// which draws the same pixels
+static void RenderDirty_add(RenderDirty *const this, RenderTarget const *const target, RenderBounds rect)
+{
+    rect.x0 = rect.x0 > 0 ? rect.x0 : 0;
+    rect.y0 = rect.y0 > 0 ? rect.y0 : 0;
+    rect.x1 = rect.x1 < target->width ? rect.x1 : target->width;
+    rect.y1 = rect.y1 < target->height ? rect.y1 : target->height;
+    if (rect.x0 >= rect.x1 || rect.y0 >= rect.y1) return;
+
+    for (int i = 0; i < this->rect_count; ++i)
+    {
+        RenderBounds const *const other = &this->rects[i];
+        if (other->x0 >= rect.x1 || other->x1 <= rect.x0 || other->y0 >= rect.y1 || other->y1 <= rect.y0) continue;
+
+        RenderBounds const merged = {
+            .x0 = other->x0 < rect.x0 ? other->x0 : rect.x0,
+            .y0 = other->y0 < rect.y0 ? other->y0 : rect.y0,
+            .x1 = other->x1 > rect.x1 ? other->x1 : rect.x1,
+            .y1 = other->y1 > rect.y1 ? other->y1 : rect.y1,
+        };
+        if (render_dirty_area(&merged) <= render_dirty_area(other) + render_dirty_area(&rect))
+        {
+            // the merged rect may overlap others now, so it goes in again
+            this->rects[i] = this->rects[--this->rect_count];
+            RenderDirty_add(this, target, merged);
+            return;
+        }
+    }
+
+    this->rects[this->rect_count++] = rect;
+}
+
+// draws constants into target, which has to be the framebuffer of the last frame unless it changed size.
+// returns how many pixels were shaded
+static uint64_t RenderDirty_draw(RenderDirty *const this, RenderTarget const *const target,
+                                 ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScene const scene = render_scene(constants);
+    RenderBounds bounds[RENDER_SHAPE_COUNT];
+    render_tiles_shape_bounds(target, &scene, bounds);
+
+    ShaderConstants const *const last = &this->constants;
+    bool const is_full = !this->is_valid ||
+        target->pixels != this->target.pixels || target->width != this->target.width ||
+        target->height != this->target.height || target->pitch != this->target.pitch ||
+        constants->aspect_ratio != last->aspect_ratio || constants->ball_radius != last->ball_radius ||
+        constants->player_size.x != last->player_size.x || constants->player_size.y != last->player_size.y ||
+        constants->player1_score != last->player1_score || constants->player2_score != last->player2_score;
+
+    this->rect_count = 0;
+    if (is_full)
+    {
+        this->rects[this->rect_count++] = (RenderBounds) {0, 0, target->width, target->height};
+    }
+    else
+    {
+        float2 const positions[3][2] = {
+            {last->ball_position, constants->ball_position},
+            {last->player1_position, constants->player1_position},
+            {last->player2_position, constants->player2_position},
+        };
+        for (int i = 0; i < 3; ++i)
+        {
+            if (positions[i][0].x == positions[i][1].x && positions[i][0].y == positions[i][1].y) continue;
+
+            RenderDirty_add(this, target, this->bounds[i]);
+            RenderDirty_add(this, target, bounds[i]);
+        }
+    }
+
+    uint64_t shaded_count = 0;
+    for (int i = 0; i < this->rect_count; ++i)
+    {
+        RenderBounds const *const rect = &this->rects[i];
+
+        uint32_t shapes = 0;
+        for (int j = 0; j < RENDER_SHAPE_COUNT; ++j)
+        {
+            if (bounds[j].x0 < rect->x1 && bounds[j].x1 > rect->x0 && bounds[j].y0 < rect->y1 && bounds[j].y1 > rect->y0)
+            {
+                shapes |= 1u << j;
+            }
+        }
+
+        render_rect_isa(target, &scene, isa, shapes, rect->x0, rect->y0, rect->x1, rect->y1);
+        shaded_count += (uint64_t) render_dirty_area(rect);
+    }
+
+    this->target = *target;
+    this->constants = *constants;
+    for (int i = 0; i < RENDER_SHAPE_COUNT; ++i) this->bounds[i] = bounds[i];
+    this->is_valid = true;
+    this->shaded_count = shaded_count;
+    this->was_full = is_full;
+    return shaded_count;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+// shades a frame of render.h in blocks, working out first from the distance fields at the center of each block
+// which moving shapes its pixels can see. a distance field changes by at most as much as the coords do, so the
+// distance at the center of a block bounds the distance at all of its pixels, which is all it takes to leave a
+// shape out of a block or to fill a block that is inside a shape with its color. blocks of
+// RENDER_HIERARCHY_COARSE pixels are looked at first and only the ones near an edge are split into blocks of
+// RENDER_HIERARCHY_BLOCK pixels, and runs of blocks that need the same shapes are shaded in one go.
+//
+// leaving a shape out is exact where it is at least RENDER_HIERARCHY_DROP away: a pixel only has a mask if
+// final_sdf < 0.002, so some shape is closer than 0.002 + 0.05 / 6 = 0.0103 for smin, and the shape left out is
+// then more than 0.05 further away, which is too far to blend with it or to tint it. where there is no mask
+// the pixel is the overlay no matter which shapes are left out, since final_sdf only grows without a shape.
+// inside a shape, at most 0.001 away with every other shape 0.05 further, smin is the plain min, the mask is
+// 1 and the color is that of the shape, so the pixel is exactly that color.
+// needs render.h, render_simd.h and render_tiles.h
+
+#define RENDER_HIERARCHY_BLOCK (8)
+#define RENDER_HIERARCHY_COARSE (64)
+
+// up to 8192 pixels wide, wider frames are shaded in full
+#define RENDER_HIERARCHY_MAX_BLOCKS (1024)
+
+#define RENDER_HIERARCHY_DROP (0.061f)
+
+// how far the coords and the distances float math works out may be off, far below any of the margins
+#define RENDER_HIERARCHY_EPSILON (1e-5f)
+
+// a block inside the shape in the lower bits
+#define RENDER_HIERARCHY_FILL (1u << 31)
+
+typedef struct RenderHierarchyStats
+{
+    // pixels shaded with a moving shape, shaded with the static shapes alone and filled with a color
+    uint64_t shaded_count;
+    uint64_t static_count;
+    uint64_t filled_count;
+
+    // blocks whose distances were worked out
+    uint64_t coarse_count;
+    uint64_t block_count;
+} RenderHierarchyStats;
+
+// which of candidates, a set of moving shapes, the pixels from (x0, y0) up to (x1, y1) need,
+// or RENDER_HIERARCHY_FILL and the shape they are all inside of
+static uint32_t render_hierarchy_classify(RenderTarget const *const target, RenderScene const *const scene,
+                                          uint32_t const candidates, int const x0, int const y0, int const x1, int const y1)
+{
+    ShaderConstants const *const constants = &scene->constants;
+    float const pixel_width = constants->aspect_ratio / (float) target->width;
+    float const pixel_height = 1.0f / (float) target->height;
+
+    // the centers of the first and the last pixel are (x1 - x0 - 1) pixels apart, see render_rect for the coords
+    float2 const center = {
+        (float) (x0 + x1) * 0.5f * pixel_width,
+        1.0f - (float) (y0 + y1) * 0.5f * pixel_height,
+    };
+    float2 const half_size = {(float) (x1 - x0 - 1) * 0.5f * pixel_width, (float) (y1 - y0 - 1) * 0.5f * pixel_height};
+    float const radius = flength2(half_size) + RENDER_HIERARCHY_EPSILON;
+
+    float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+    float const distances[3] = {
+        render_circle_sdf(center, constants->ball_position, constants->ball_radius),
+        render_rectangle_sdf(center, constants->player1_position, half_player_size),
+        render_rectangle_sdf(center, constants->player2_position, half_player_size),
+    };
+
+    uint32_t shapes = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        if ((candidates & 1u << i) != 0 && distances[i] - radius < RENDER_HIERARCHY_DROP) shapes |= 1u << i;
+    }
+
+    // the shapes that are not candidates are further away than RENDER_HIERARCHY_DROP, which is far enough
+    for (int i = 0; i < 3; ++i)
+    {
+        float const upper = distances[i] + radius;
+        if ((shapes & 1u << i) == 0 || upper > 0.001f) continue;
+
+        bool is_alone = true;
+        for (int j = 0; j < 3; ++j)
+        {
+            is_alone &= j == i || (shapes & 1u << j) == 0 || distances[j] - radius >= upper + 0.05f + RENDER_HIERARCHY_EPSILON;
+        }
+        if (is_alone) return RENDER_HIERARCHY_FILL | 1u << i;
+    }
+
+    return shapes;
+}
+
+static void render_hierarchy_fill(RenderTarget const *const target, uint32_t const color,
+                                  int const x0, int const y0, int const x1, int const y1)
+{
+    for (int y = y0; y < y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+        for (int x = x0; x < x1; ++x) row[x] = color;
+    }
+}
+
+// the same pixels as render_rect_isa for every shape, stats may be NULL
+static void render_hierarchy_frame(RenderTarget const *const target, RenderScene const *const scene,
+                                   RenderIsa const isa, RenderHierarchyStats *const stats)
+{
+    RenderHierarchyStats frame_stats = {0};
+    int const width = target->width;
+    int const height = target->height;
+    int const block_count = (width + RENDER_HIERARCHY_BLOCK - 1) / RENDER_HIERARCHY_BLOCK;
+    if (block_count > RENDER_HIERARCHY_MAX_BLOCKS)
+    {
+        render_rect_isa(target, scene, isa, RENDER_SHAPES_ALL, 0, 0, width, height);
+        frame_stats.shaded_count = (uint64_t) width * (uint64_t) height;
+        if (stats != NULL) *stats = frame_stats;
+        return;
+    }
+
+    RenderBounds bounds[RENDER_SHAPE_COUNT];
+    render_tiles_shape_bounds(target, scene, bounds);
+
+    // ps_main colors each shape like this where it is alone
+    static uint32_t const colors[3] = {0xFFFF0000u, 0xFF0000FFu, 0xFF00FF00u};
+
+    int const blocks_per_coarse = RENDER_HIERARCHY_COARSE / RENDER_HIERARCHY_BLOCK;
+    uint32_t coarse_classes[RENDER_HIERARCHY_MAX_BLOCKS / (RENDER_HIERARCHY_COARSE / RENDER_HIERARCHY_BLOCK) + 1];
+    uint32_t classes[RENDER_HIERARCHY_MAX_BLOCKS];
+    for (int coarse_y = 0; coarse_y < height; coarse_y += RENDER_HIERARCHY_COARSE)
+    {
+        int const coarse_y1 = coarse_y + RENDER_HIERARCHY_COARSE < height ? coarse_y + RENDER_HIERARCHY_COARSE : height;
+        for (int i = 0; i * RENDER_HIERARCHY_COARSE < width; ++i)
+        {
+            int const x0 = i * RENDER_HIERARCHY_COARSE;
+            int const x1 = x0 + RENDER_HIERARCHY_COARSE < width ? x0 + RENDER_HIERARCHY_COARSE : width;
+            coarse_classes[i] = render_hierarchy_classify(target, scene, RENDER_SHAPES_MOVING, x0, coarse_y, x1, coarse_y1);
+            ++frame_stats.coarse_count;
+        }
+
+        for (int y0 = coarse_y; y0 < coarse_y1; y0 += RENDER_HIERARCHY_BLOCK)
+        {
+            int const y1 = y0 + RENDER_HIERARCHY_BLOCK < coarse_y1 ? y0 + RENDER_HIERARCHY_BLOCK : coarse_y1;
+            for (int i = 0; i < block_count; ++i)
+            {
+                int const x0 = i * RENDER_HIERARCHY_BLOCK;
+                int const x1 = x0 + RENDER_HIERARCHY_BLOCK < width ? x0 + RENDER_HIERARCHY_BLOCK : width;
+
+                // a coarse block that is decided holds for all of its blocks
+                uint32_t class = coarse_classes[i / blocks_per_coarse];
+                if (class != 0 && (class & RENDER_HIERARCHY_FILL) == 0)
+                {
+                    class = render_hierarchy_classify(target, scene, class, x0, y0, x1, y1);
+                    ++frame_stats.block_count;
+                }
+
+                if ((class & RENDER_HIERARCHY_FILL) == 0)
+                {
+                    for (int j = 3; j < RENDER_SHAPE_COUNT; ++j)
+                    {
+                        if (bounds[j].x0 < x1 && bounds[j].x1 > x0 && bounds[j].y0 < y1 && bounds[j].y1 > y0) class |= 1u << j;
+                    }
+                }
+                classes[i] = class;
+            }
+
+            // blocks next to each other that need the same are shaded together, which keeps the rows long for simd
+            for (int i = 0; i < block_count;)
+            {
+                int end = i + 1;
+                while (end < block_count && classes[end] == classes[i]) ++end;
+
+                int const x0 = i * RENDER_HIERARCHY_BLOCK;
+                int const x1 = end * RENDER_HIERARCHY_BLOCK < width ? end * RENDER_HIERARCHY_BLOCK : width;
+                uint64_t const area = (uint64_t) (x1 - x0) * (uint64_t) (y1 - y0);
+                uint32_t const class = classes[i];
+                if ((class & RENDER_HIERARCHY_FILL) != 0)
+                {
+                    int const shape = (class & RENDER_SHAPE_BALL) != 0 ? 0 : (class & RENDER_SHAPE_PLAYER1) != 0 ? 1 : 2;
+                    render_hierarchy_fill(target, colors[shape], x0, y0, x1, y1);
+                    frame_stats.filled_count += area;
+                }
+                else if (class == 0)
+                {
+                    // the background, what render_pack makes of black
+                    render_hierarchy_fill(target, 0xFF000000u, x0, y0, x1, y1);
+                    frame_stats.filled_count += area;
+                }
+                else
+                {
+                    render_rect_isa(target, scene, isa, class, x0, y0, x1, y1);
+                    if ((class & RENDER_SHAPES_MOVING) != 0) frame_stats.shaded_count += area;
+                    else frame_stats.static_count += area;
+                }
+
+                i = end;
+            }
+        }
+    }
+
+    if (stats != NULL) *stats = frame_stats;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+// keeps the masks of both scores so a frame reads them instead of decoding up to 9 digits per pixel.
+// each image only covers the bounds of render_tiles.h where its score can be seen, and both are drawn
+// again only when a score or the size of the target changes. the masks come from the same
+// render_number_text_mask every kernel matches, so frames drawn with the cache are the same.
+// needs timing.h, render.h, render_simd.h and render_tiles.h
+
+typedef struct RenderScoreCache
+{
+    RenderMaskImage images[2];
+    size_t capacities[2];
+
+    // what the images were drawn for
+    int width;
+    int height;
+    float aspect_ratio;
+    uint32_t scores[2];
+    bool is_valid;
+
+    uint64_t update_count;
+    uint64_t update_ns;
+} RenderScoreCache;
+
+static bool RenderScoreCache_draw_image(RenderScoreCache *const this, int const player, RenderTarget const *const target,
+                                        RenderScene const *const scene, RenderBounds const bounds)
+{
+    RenderMaskImage *const image = &this->images[player];
+    image->x0 = bounds.x0 > 0 ? bounds.x0 : 0;
+    image->y0 = bounds.y0 > 0 ? bounds.y0 : 0;
+    image->x1 = bounds.x1 < target->width ? bounds.x1 : target->width;
+    image->y1 = bounds.y1 < target->height ? bounds.y1 : target->height;
+    if (image->x1 < image->x0) image->x1 = image->x0;
+    if (image->y1 < image->y0) image->y1 = image->y0;
+
+    size_t const image_width = (size_t) (image->x1 - image->x0);
+    size_t const size = image_width * (size_t) (image->y1 - image->y0);
+    if (size > this->capacities[player])
+    {
+        float *const masks = realloc(image->masks, size * sizeof(float));
+        if (masks == NULL) return false;
+
+        image->masks = masks;
+        this->capacities[player] = size;
+    }
+
+    ShaderConstants const *const constants = &scene->constants;
+    float const aspect_ratio = constants->aspect_ratio;
+    float2 const position = player == 0 ? (float2) {0.085f, 0.87f} :
+        (float2) {aspect_ratio - 0.075f - scene->player2_score_log10 * 0.225f / 5.0f, 0.87f};
+    uint32_t const score = player == 0 ? constants->player1_score : constants->player2_score;
+    float const score_log10 = player == 0 ? scene->player1_score_log10 : scene->player2_score_log10;
+
+    // the same coordinates as render_rect
+    float const inverse_width = 1.0f / (float) target->width;
+    float const inverse_height = 1.0f / (float) target->height;
+    for (int y = image->y0; y < image->y1; ++y)
+    {
+        float *const row = &image->masks[(size_t) (y - image->y0) * image_width];
+        float const texture_y = 1.0f - ((float) y + 0.5f) * inverse_height;
+        for (int x = image->x0; x < image->x1; ++x)
+        {
+            float2 const coords = {((float) x + 0.5f) * inverse_width * aspect_ratio, texture_y};
+            row[x - image->x0] = render_number_text_mask(coords, position, 5.0f, score, score_log10);
+        }
+    }
+
+    return true;
+}
+
+// points scene at images of its scores for target, drawing them first if they are out of date.
+// leaves scene alone when there is no memory for them, which only makes the frame slower
+static void RenderScoreCache_update(RenderScoreCache *const this, RenderTarget const *const target, RenderScene *const scene)
+{
+    ShaderConstants const *const constants = &scene->constants;
+    if (!this->is_valid || this->width != target->width || this->height != target->height ||
+        this->aspect_ratio != constants->aspect_ratio ||
+        this->scores[0] != constants->player1_score || this->scores[1] != constants->player2_score)
+    {
+        uint64_t const time_start = time_now_ns();
+
+        RenderBounds bounds[RENDER_SHAPE_COUNT];
+        render_tiles_shape_bounds(target, scene, bounds);
+
+        this->is_valid = RenderScoreCache_draw_image(this, 0, target, scene, bounds[4]) &&
+                         RenderScoreCache_draw_image(this, 1, target, scene, bounds[5]);
+        if (!this->is_valid) return;
+
+        this->width = target->width;
+        this->height = target->height;
+        this->aspect_ratio = constants->aspect_ratio;
+        this->scores[0] = constants->player1_score;
+        this->scores[1] = constants->player2_score;
+
+        ++this->update_count;
+        this->update_ns += time_now_ns() - time_start;
+    }
+
+    scene->score_images = this->images;
+}
+
+// render_frame_isa that reads the scores from this
+static void RenderScoreCache_draw_frame(RenderScoreCache *const this, RenderTarget const *const target,
+                                        ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScene scene = render_scene(constants);
+    RenderScoreCache_update(this, target, &scene);
+    render_rect_isa(target, &scene, isa, RENDER_SHAPES_ALL, 0, 0, target->width, target->height);
+}
+
+static void RenderScoreCache_free(RenderScoreCache *const this)
+{
+    free(this->images[0].masks);
+    free(this->images[1].masks);
+    *this = (RenderScoreCache) {0};
+}
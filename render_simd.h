@@ -0,0 +1,743 @@
+#pragma once
+
+// shades 8 (avx2) or 16 (avx512) pixels of a row at once. every kernel does the same float operations
+// in the same order as render_pixel, so it draws exactly the same pixels as the scalar renderer.
+// vec.h fmaxf(a, b) returns a when both are equal, which _mm_max_ps(b, a) does as well, that keeps
+// the sign of zeros the same too.
+// the texture is only sampled for digits some lane is inside of, a lane outside of the digit box has a
+// mask of 0 there and the median is never negative, so skipping it does not change the result.
+// needs render.h
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RENDER_HAS_SIMD
+#define RENDER_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+typedef enum RenderIsa
+{
+    RENDER_ISA_SCALAR,
+    RENDER_ISA_AVX2,
+    RENDER_ISA_AVX512,
+} RenderIsa;
+
+#ifdef RENDER_HAS_SIMD
+
+RENDER_TARGET("avx2")
+static inline __m256 render_abs_avx2(__m256 const value)
+{
+    return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), value);
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_clamp_avx2(__m256 const value, __m256 const min, __m256 const max)
+{
+    return _mm256_min_ps(_mm256_max_ps(min, value), max);
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_lerp_avx2(__m256 const a, __m256 const b, __m256 const c)
+{
+    return _mm256_add_ps(a, _mm256_mul_ps(c, _mm256_sub_ps(b, a)));
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_smoothstep_avx2(__m256 const min, __m256 const max, __m256 const value)
+{
+    __m256 const t = render_clamp_avx2(_mm256_div_ps(_mm256_sub_ps(value, min), _mm256_sub_ps(max, min)),
+                                       _mm256_setzero_ps(), _mm256_set1_ps(1.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(t, t), _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_set1_ps(2.0f), t)));
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_sdf_to_mask_avx2(__m256 const sdf)
+{
+    return render_smoothstep_avx2(_mm256_set1_ps(0.002f), _mm256_set1_ps(0.001f), sdf);
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_smin_avx2(__m256 const a, __m256 const b, __m256 const k)
+{
+    __m256 const h = _mm256_div_ps(_mm256_max_ps(_mm256_setzero_ps(), _mm256_sub_ps(k, render_abs_avx2(_mm256_sub_ps(a, b)))), k);
+    return _mm256_sub_ps(_mm256_min_ps(a, b),
+                         _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(h, h), h), k), _mm256_set1_ps(1.0f / 6.0f)));
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_floor_avx2(__m256 const value)
+{
+    __m256 const truncated = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(value));
+    __m256 const is_above = _mm256_cmp_ps(truncated, value, _CMP_GT_OQ);
+    return _mm256_sub_ps(truncated, _mm256_and_ps(is_above, _mm256_set1_ps(1.0f)));
+}
+
+RENDER_TARGET("avx2")
+static inline __m256 render_rectangle_sdf_avx2(__m256 const x, __m256 const y, float2 const position, float2 const half_size)
+{
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const edge_x = _mm256_sub_ps(render_abs_avx2(_mm256_sub_ps(x, _mm256_set1_ps(position.x))), _mm256_set1_ps(half_size.x));
+    __m256 const edge_y = _mm256_sub_ps(render_abs_avx2(_mm256_sub_ps(y, _mm256_set1_ps(position.y))), _mm256_set1_ps(half_size.y));
+    __m256 const outside_x = _mm256_max_ps(zero, edge_x);
+    __m256 const outside_y = _mm256_max_ps(zero, edge_y);
+    __m256 const outside_distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(outside_x, outside_x),
+                                                                 _mm256_mul_ps(outside_y, outside_y)));
+    __m256 const inside_distance = _mm256_min_ps(_mm256_max_ps(edge_y, edge_x), zero);
+    return _mm256_add_ps(outside_distance, inside_distance);
+}
+
+// x modulo size for x in [-2^16, 2^16], the division is exact at multiples of size so the floor is too
+RENDER_TARGET("avx2")
+static inline __m256i render_wrap_avx2(__m256 const x, int const size)
+{
+    __m256 const quotient = render_floor_avx2(_mm256_div_ps(x, _mm256_set1_ps((float) size)));
+    return _mm256_cvttps_epi32(_mm256_sub_ps(x, _mm256_mul_ps(quotient, _mm256_set1_ps((float) size))));
+}
+
+// one channel of a texel as render_font_median reads it
+RENDER_TARGET("avx2")
+static inline __m256 render_channel_avx2(__m256i const texel, int const channel)
+{
+    __m256i const value = _mm256_and_si256(_mm256_srlv_epi32(texel, _mm256_set1_epi32(channel * 8)), _mm256_set1_epi32(0xFF));
+    return _mm256_div_ps(_mm256_cvtepi32_ps(value), _mm256_set1_ps(255.0f));
+}
+
+RENDER_TARGET("avx2")
+static __m256 render_font_median_avx2(__m256 const x, __m256 const y)
+{
+    __m256 const u = _mm256_sub_ps(_mm256_mul_ps(x, _mm256_set1_ps((float) TEXTURE_WIDTH)), _mm256_set1_ps(0.5f));
+    __m256 const v = _mm256_sub_ps(_mm256_mul_ps(y, _mm256_set1_ps((float) TEXTURE_HEIGHT)), _mm256_set1_ps(0.5f));
+    __m256 const u0 = render_floor_avx2(u);
+    __m256 const v0 = render_floor_avx2(v);
+    __m256 const fraction_u = _mm256_sub_ps(u, u0);
+    __m256 const fraction_v = _mm256_sub_ps(v, v0);
+
+    __m256i const x0 = render_wrap_avx2(u0, TEXTURE_WIDTH);
+    __m256i const y0 = render_wrap_avx2(v0, TEXTURE_HEIGHT);
+    __m256i const one = _mm256_set1_epi32(1);
+    __m256i const x1 = _mm256_add_epi32(x0, _mm256_and_si256(_mm256_cmpeq_epi32(x0, _mm256_set1_epi32(TEXTURE_WIDTH - 1)),
+                                                             _mm256_set1_epi32(-TEXTURE_WIDTH)));
+    __m256i const y1 = _mm256_add_epi32(y0, _mm256_and_si256(_mm256_cmpeq_epi32(y0, _mm256_set1_epi32(TEXTURE_HEIGHT - 1)),
+                                                             _mm256_set1_epi32(-TEXTURE_HEIGHT)));
+    __m256i const column1 = _mm256_add_epi32(x1, one);
+    __m256i const row0 = _mm256_mullo_epi32(y0, _mm256_set1_epi32(TEXTURE_WIDTH));
+    __m256i const row1 = _mm256_mullo_epi32(_mm256_add_epi32(y1, one), _mm256_set1_epi32(TEXTURE_WIDTH));
+
+    int const *const texels = (int const *) font_texture_bin;
+    __m256i const texel00 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row0, x0), 4);
+    __m256i const texel10 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row0, column1), 4);
+    __m256i const texel01 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row1, x0), 4);
+    __m256i const texel11 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row1, column1), 4);
+
+    __m256 channels[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        __m256 const top = render_lerp_avx2(render_channel_avx2(texel00, i), render_channel_avx2(texel10, i), fraction_u);
+        __m256 const bottom = render_lerp_avx2(render_channel_avx2(texel01, i), render_channel_avx2(texel11, i), fraction_u);
+        channels[i] = render_lerp_avx2(top, bottom, fraction_v);
+    }
+
+    __m256 const sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(channels[0], channels[1]), channels[2]), channels[3]);
+    __m256 const min = _mm256_min_ps(channels[0], _mm256_min_ps(channels[1], _mm256_min_ps(channels[2], channels[3])));
+    __m256 const max = _mm256_max_ps(_mm256_max_ps(_mm256_max_ps(channels[3], channels[2]), channels[1]), channels[0]);
+    return _mm256_sub_ps(_mm256_sub_ps(sum, min), max);
+}
+
+RENDER_TARGET("avx2")
+static __m256 render_number_text_mask_avx2(__m256 const coords_x, __m256 const coords_y, float2 const position,
+                                           float const scale, uint32_t number, float const number_log)
+{
+    static float2 const offsets[] = {
+        {0.225f * 0.0f, 0.3375f * 2.0f}, {0.225f * 3.0f, 0.3375f * 2.0f}, {0.225f * 2.0f, 0.3375f * 1.0f},
+        {0.225f * 3.0f, 0.3375f * 1.0f}, {0.225f * 1.0f, 0.3375f * 0.0f}, {0.225f * 1.0f, 0.3375f * 1.0f},
+        {0.225f * 0.0f, 0.3375f * 1.0f}, {0.225f * 0.0f, 0.3375f * 0.0f}, {0.225f * 2.0f, 0.3375f * 2.0f},
+        {0.225f * 1.0f, 0.3375f * 2.0f},
+    };
+    static float const kerning[] = {0.005f, 0.0085f, 0.04f, 0.05f, 0.01f, 0.02f, 0.0f, 0.0f, 0.025f, 0.0f};
+
+    __m256 const x = _mm256_mul_ps(_mm256_sub_ps(coords_x, _mm256_set1_ps(position.x)), _mm256_set1_ps(scale));
+    __m256 const y = _mm256_mul_ps(_mm256_sub_ps(coords_y, _mm256_set1_ps(position.y)), _mm256_set1_ps(scale));
+    float2 const half_size = f2divf((float2) {0.2365f, 0.3375f}, 2.0f);
+
+    __m256 result = _mm256_setzero_ps();
+    for (float i = 0.0f; i < 9; ++i)
+    {
+        uint32_t const digit = number % 10;
+        float2 const digit_position = {0.225f * (number_log - 1 - i), 0.0f};
+
+        __m256 const box_mask = render_sdf_to_mask_avx2(render_rectangle_sdf_avx2(x, y, f2add2(digit_position, half_size), half_size));
+        if (_mm256_movemask_ps(_mm256_cmp_ps(box_mask, _mm256_setzero_ps(), _CMP_GT_OQ)) != 0)
+        {
+            __m256 const sample_x = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(x, _mm256_set1_ps(digit_position.x)),
+                                                                _mm256_set1_ps(offsets[digit].x)),
+                                                  _mm256_set1_ps(kerning[digit]));
+            __m256 const sample_y = _mm256_add_ps(_mm256_sub_ps(y, _mm256_set1_ps(digit_position.y)),
+                                                  _mm256_set1_ps(offsets[digit].y));
+            __m256 const letter_mask = _mm256_min_ps(render_font_median_avx2(sample_x, sample_y), box_mask);
+            result = _mm256_max_ps(letter_mask, result);
+        }
+
+        number /= 10;
+
+        if (number == 0) break;
+    }
+
+    return render_smoothstep_avx2(_mm256_set1_ps(1.0f - 0.5f), _mm256_set1_ps(1.0f), result);
+}
+
+RENDER_TARGET("avx2")
+static __m256 render_mask_image_avx2(RenderMaskImage const *const image, int const x, int const y)
+{
+    if (y < image->y0 || y >= image->y1 || x + 8 <= image->x0 || x >= image->x1) return _mm256_setzero_ps();
+
+    float const *const row = &image->masks[(size_t) (y - image->y0) * (size_t) (image->x1 - image->x0)];
+    if (x >= image->x0 && x + 8 <= image->x1) return _mm256_loadu_ps(&row[x - image->x0]);
+
+    float lanes[8] = {0};
+    for (int i = 0; i < 8; ++i)
+    {
+        if (x + i >= image->x0 && x + i < image->x1) lanes[i] = row[x + i - image->x0];
+    }
+    return _mm256_loadu_ps(lanes);
+}
+
+RENDER_TARGET("avx2")
+static void render_rect_avx2(RenderTarget const *const target, RenderScene const *const scene, uint32_t const shapes,
+                             int const x0, int const y0, int const x1, int const y1)
+{
+    ShaderConstants const *const constants = &scene->constants;
+    float const aspect_ratio = constants->aspect_ratio;
+    float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+    float2 const player2_score_position = {aspect_ratio - 0.075f - scene->player2_score_log10 * 0.225f / 5.0f, 0.87f};
+
+    float const inverse_width = 1.0f / (float) target->width;
+    float const inverse_height = 1.0f / (float) target->height;
+    __m256 const lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const blend = _mm256_set1_ps(0.05f);
+
+    for (int y = y0; y < y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+        float const texture_y = 1.0f - ((float) y + 0.5f) * inverse_height;
+        __m256 const coords_y = _mm256_set1_ps(texture_y);
+
+        int x = x0;
+        for (; x + 8 <= x1; x += 8)
+        {
+            __m256 const texture_x = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps((float) x), lanes),
+                                                                 _mm256_set1_ps(0.5f)),
+                                                   _mm256_set1_ps(inverse_width));
+            __m256 const coords_x = _mm256_mul_ps(texture_x, _mm256_set1_ps(aspect_ratio));
+
+            __m256 player1_score_mask = zero;
+            __m256 player2_score_mask = zero;
+            if (scene->score_images != NULL)
+            {
+                if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0) player1_score_mask = render_mask_image_avx2(&scene->score_images[0], x, y);
+                if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0) player2_score_mask = render_mask_image_avx2(&scene->score_images[1], x, y);
+            }
+            else
+            {
+                if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0)
+                {
+                    player1_score_mask = render_number_text_mask_avx2(coords_x, coords_y, (float2) {0.085f, 0.87f}, 5.0f,
+                                                                      constants->player1_score, scene->player1_score_log10);
+                }
+                if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0)
+                {
+                    player2_score_mask = render_number_text_mask_avx2(coords_x, coords_y, player2_score_position, 5.0f,
+                                                                      constants->player2_score, scene->player2_score_log10);
+                }
+            }
+
+            __m256 middle_line_mask = zero;
+            if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0 && scene->middle_line_image != NULL)
+            {
+                middle_line_mask = render_mask_image_avx2(scene->middle_line_image, x, y);
+            }
+            else if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0)
+            {
+                __m256 middle_line = _mm256_sub_ps(render_abs_avx2(_mm256_sub_ps(coords_x, _mm256_set1_ps(0.5f * aspect_ratio))),
+                                                   _mm256_set1_ps(0.005f));
+                __m256 const pattern_value = _mm256_add_ps(render_abs_avx2(coords_y), _mm256_set1_ps(0.01f));
+                __m256 const pattern_quotient = _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_div_ps(pattern_value, _mm256_set1_ps(0.1f))));
+                __m256 const middle_line_pattern = _mm256_sub_ps(_mm256_sub_ps(pattern_value, _mm256_mul_ps(_mm256_set1_ps(0.1f), pattern_quotient)),
+                                                                 _mm256_set1_ps(0.025f));
+                middle_line = _mm256_max_ps(_mm256_xor_ps(middle_line_pattern, _mm256_set1_ps(-0.0f)), middle_line);
+                middle_line_mask = render_sdf_to_mask_avx2(middle_line);
+            }
+            __m256 const overlay_mask = _mm256_max_ps(middle_line_mask, _mm256_max_ps(player2_score_mask, player1_score_mask));
+
+            __m256 red = overlay_mask;
+            __m256 green = overlay_mask;
+            __m256 blue = overlay_mask;
+            if ((shapes & RENDER_SHAPES_MOVING) != 0)
+            {
+                __m256 ball = _mm256_set1_ps(RENDER_SHAPE_FAR);
+                if ((shapes & RENDER_SHAPE_BALL) != 0)
+                {
+                    __m256 const ball_x = _mm256_sub_ps(coords_x, _mm256_set1_ps(constants->ball_position.x));
+                    __m256 const ball_y = _mm256_sub_ps(coords_y, _mm256_set1_ps(constants->ball_position.y));
+                    ball = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ball_x, ball_x), _mm256_mul_ps(ball_y, ball_y))),
+                                         _mm256_set1_ps(constants->ball_radius));
+                }
+                __m256 const player1 = (shapes & RENDER_SHAPE_PLAYER1) == 0 ? _mm256_set1_ps(RENDER_SHAPE_FAR) :
+                    render_rectangle_sdf_avx2(coords_x, coords_y, constants->player1_position, half_player_size);
+                __m256 const player2 = (shapes & RENDER_SHAPE_PLAYER2) == 0 ? _mm256_set1_ps(RENDER_SHAPE_FAR) :
+                    render_rectangle_sdf_avx2(coords_x, coords_y, constants->player2_position, half_player_size);
+
+                // the same permutations as render_pixel
+                __m256 const players = _mm256_min_ps(player1, player2);
+                __m256 final_sdf;
+                __m256 final_red = zero;
+                __m256 final_green = zero;
+                __m256 final_blue = zero;
+                if (scene->variant == SHADER_VARIANT_APART)
+                {
+                    final_sdf = _mm256_min_ps(ball, players);
+                    __m256 const is_ball = _mm256_cmp_ps(ball, players, _CMP_LE_OQ);
+                    __m256 const is_player2 = _mm256_andnot_ps(is_ball, _mm256_cmp_ps(player2, player1, _CMP_LE_OQ));
+                    final_red = _mm256_andnot_ps(_mm256_or_ps(is_ball, is_player2), one);
+                    final_green = _mm256_and_ps(is_player2, one);
+                    final_blue = _mm256_and_ps(is_ball, one);
+                }
+                else
+                {
+                    switch (scene->variant)
+                    {
+                        case SHADER_VARIANT_PLAYER1:
+                            final_sdf = _mm256_min_ps(render_smin_avx2(ball, player1, blend), player2);
+                            break;
+                        case SHADER_VARIANT_PLAYER2:
+                            final_sdf = _mm256_min_ps(render_smin_avx2(ball, player2, blend), player1);
+                            break;
+                        default:
+                            final_sdf = render_smin_avx2(ball, players, blend);
+                            break;
+                    }
+
+                    __m256 mix = render_smoothstep_avx2(_mm256_sub_ps(player1, blend), player1, final_sdf);
+                    final_red = render_lerp_avx2(final_red, one, mix);
+                    final_green = render_lerp_avx2(final_green, zero, mix);
+                    final_blue = render_lerp_avx2(final_blue, zero, mix);
+                    mix = render_smoothstep_avx2(_mm256_sub_ps(player2, blend), player2, final_sdf);
+                    final_red = render_lerp_avx2(final_red, zero, mix);
+                    final_green = render_lerp_avx2(final_green, one, mix);
+                    final_blue = render_lerp_avx2(final_blue, zero, mix);
+                    mix = render_smoothstep_avx2(_mm256_sub_ps(ball, blend), ball, final_sdf);
+                    final_red = render_lerp_avx2(final_red, zero, mix);
+                    final_green = render_lerp_avx2(final_green, zero, mix);
+                    final_blue = render_lerp_avx2(final_blue, one, mix);
+                }
+
+                __m256 const final_mask = render_sdf_to_mask_avx2(final_sdf);
+
+                red = render_lerp_avx2(overlay_mask, final_red, final_mask);
+                green = render_lerp_avx2(overlay_mask, final_green, final_mask);
+                blue = render_lerp_avx2(overlay_mask, final_blue, final_mask);
+            }
+
+            __m256 const scale = _mm256_set1_ps(255.0f);
+            __m256 const half = _mm256_set1_ps(0.5f);
+            __m256i const r = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(render_clamp_avx2(red, zero, one), scale), half));
+            __m256i const g = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(render_clamp_avx2(green, zero, one), scale), half));
+            __m256i const b = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(render_clamp_avx2(blue, zero, one), scale), half));
+            __m256i const pixels = _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                                                   _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32((int) 0xFF000000u)));
+            _mm256_storeu_si256((__m256i *) &row[x], pixels);
+        }
+
+        for (; x < x1; ++x)
+        {
+            float2 const texture_coord = {((float) x + 0.5f) * inverse_width, texture_y};
+            row[x] = render_pack(render_pixel(scene, shapes, texture_coord, x, y));
+        }
+    }
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_abs_avx512(__m512 const value)
+{
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(value), _mm512_set1_epi32(0x7FFFFFFF)));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_clamp_avx512(__m512 const value, __m512 const min, __m512 const max)
+{
+    return _mm512_min_ps(_mm512_max_ps(min, value), max);
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_lerp_avx512(__m512 const a, __m512 const b, __m512 const c)
+{
+    return _mm512_add_ps(a, _mm512_mul_ps(c, _mm512_sub_ps(b, a)));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_smoothstep_avx512(__m512 const min, __m512 const max, __m512 const value)
+{
+    __m512 const t = render_clamp_avx512(_mm512_div_ps(_mm512_sub_ps(value, min), _mm512_sub_ps(max, min)),
+                                         _mm512_setzero_ps(), _mm512_set1_ps(1.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(t, t), _mm512_sub_ps(_mm512_set1_ps(3.0f), _mm512_mul_ps(_mm512_set1_ps(2.0f), t)));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_sdf_to_mask_avx512(__m512 const sdf)
+{
+    return render_smoothstep_avx512(_mm512_set1_ps(0.002f), _mm512_set1_ps(0.001f), sdf);
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_smin_avx512(__m512 const a, __m512 const b, __m512 const k)
+{
+    __m512 const h = _mm512_div_ps(_mm512_max_ps(_mm512_setzero_ps(), _mm512_sub_ps(k, render_abs_avx512(_mm512_sub_ps(a, b)))), k);
+    return _mm512_sub_ps(_mm512_min_ps(a, b),
+                         _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(h, h), h), k), _mm512_set1_ps(1.0f / 6.0f)));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_floor_avx512(__m512 const value)
+{
+    __m512 const truncated = _mm512_cvtepi32_ps(_mm512_cvttps_epi32(value));
+    __mmask16 const is_above = _mm512_cmp_ps_mask(truncated, value, _CMP_GT_OQ);
+    return _mm512_mask_sub_ps(truncated, is_above, truncated, _mm512_set1_ps(1.0f));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_rectangle_sdf_avx512(__m512 const x, __m512 const y, float2 const position, float2 const half_size)
+{
+    __m512 const zero = _mm512_setzero_ps();
+    __m512 const edge_x = _mm512_sub_ps(render_abs_avx512(_mm512_sub_ps(x, _mm512_set1_ps(position.x))), _mm512_set1_ps(half_size.x));
+    __m512 const edge_y = _mm512_sub_ps(render_abs_avx512(_mm512_sub_ps(y, _mm512_set1_ps(position.y))), _mm512_set1_ps(half_size.y));
+    __m512 const outside_x = _mm512_max_ps(zero, edge_x);
+    __m512 const outside_y = _mm512_max_ps(zero, edge_y);
+    __m512 const outside_distance = _mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(outside_x, outside_x),
+                                                                 _mm512_mul_ps(outside_y, outside_y)));
+    __m512 const inside_distance = _mm512_min_ps(_mm512_max_ps(edge_y, edge_x), zero);
+    return _mm512_add_ps(outside_distance, inside_distance);
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512i render_wrap_avx512(__m512 const x, int const size)
+{
+    __m512 const quotient = render_floor_avx512(_mm512_div_ps(x, _mm512_set1_ps((float) size)));
+    return _mm512_cvttps_epi32(_mm512_sub_ps(x, _mm512_mul_ps(quotient, _mm512_set1_ps((float) size))));
+}
+
+RENDER_TARGET("avx512f")
+static inline __m512 render_channel_avx512(__m512i const texel, int const channel)
+{
+    __m512i const value = _mm512_and_si512(_mm512_srlv_epi32(texel, _mm512_set1_epi32(channel * 8)), _mm512_set1_epi32(0xFF));
+    return _mm512_div_ps(_mm512_cvtepi32_ps(value), _mm512_set1_ps(255.0f));
+}
+
+RENDER_TARGET("avx512f")
+static __m512 render_font_median_avx512(__m512 const x, __m512 const y)
+{
+    __m512 const u = _mm512_sub_ps(_mm512_mul_ps(x, _mm512_set1_ps((float) TEXTURE_WIDTH)), _mm512_set1_ps(0.5f));
+    __m512 const v = _mm512_sub_ps(_mm512_mul_ps(y, _mm512_set1_ps((float) TEXTURE_HEIGHT)), _mm512_set1_ps(0.5f));
+    __m512 const u0 = render_floor_avx512(u);
+    __m512 const v0 = render_floor_avx512(v);
+    __m512 const fraction_u = _mm512_sub_ps(u, u0);
+    __m512 const fraction_v = _mm512_sub_ps(v, v0);
+
+    __m512i const x0 = render_wrap_avx512(u0, TEXTURE_WIDTH);
+    __m512i const y0 = render_wrap_avx512(v0, TEXTURE_HEIGHT);
+    __m512i const one = _mm512_set1_epi32(1);
+    __mmask16 const is_last_column = _mm512_cmpeq_epi32_mask(x0, _mm512_set1_epi32(TEXTURE_WIDTH - 1));
+    __mmask16 const is_last_row = _mm512_cmpeq_epi32_mask(y0, _mm512_set1_epi32(TEXTURE_HEIGHT - 1));
+    __m512i const column1 = _mm512_mask_blend_epi32(is_last_column, _mm512_add_epi32(x0, one), _mm512_setzero_si512());
+    __m512i const y1 = _mm512_mask_blend_epi32(is_last_row, _mm512_add_epi32(y0, one), _mm512_setzero_si512());
+    __m512i const row0 = _mm512_mullo_epi32(y0, _mm512_set1_epi32(TEXTURE_WIDTH));
+    __m512i const row1 = _mm512_mullo_epi32(y1, _mm512_set1_epi32(TEXTURE_WIDTH));
+
+    int const *const texels = (int const *) font_texture_bin;
+    __m512i const texel00 = _mm512_i32gather_epi32(_mm512_add_epi32(row0, x0), texels, 4);
+    __m512i const texel10 = _mm512_i32gather_epi32(_mm512_add_epi32(row0, column1), texels, 4);
+    __m512i const texel01 = _mm512_i32gather_epi32(_mm512_add_epi32(row1, x0), texels, 4);
+    __m512i const texel11 = _mm512_i32gather_epi32(_mm512_add_epi32(row1, column1), texels, 4);
+
+    __m512 channels[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        __m512 const top = render_lerp_avx512(render_channel_avx512(texel00, i), render_channel_avx512(texel10, i), fraction_u);
+        __m512 const bottom = render_lerp_avx512(render_channel_avx512(texel01, i), render_channel_avx512(texel11, i), fraction_u);
+        channels[i] = render_lerp_avx512(top, bottom, fraction_v);
+    }
+
+    __m512 const sum = _mm512_add_ps(_mm512_add_ps(_mm512_add_ps(channels[0], channels[1]), channels[2]), channels[3]);
+    __m512 const min = _mm512_min_ps(channels[0], _mm512_min_ps(channels[1], _mm512_min_ps(channels[2], channels[3])));
+    __m512 const max = _mm512_max_ps(_mm512_max_ps(_mm512_max_ps(channels[3], channels[2]), channels[1]), channels[0]);
+    return _mm512_sub_ps(_mm512_sub_ps(sum, min), max);
+}
+
+RENDER_TARGET("avx512f")
+static __m512 render_number_text_mask_avx512(__m512 const coords_x, __m512 const coords_y, float2 const position,
+                                             float const scale, uint32_t number, float const number_log)
+{
+    static float2 const offsets[] = {
+        {0.225f * 0.0f, 0.3375f * 2.0f}, {0.225f * 3.0f, 0.3375f * 2.0f}, {0.225f * 2.0f, 0.3375f * 1.0f},
+        {0.225f * 3.0f, 0.3375f * 1.0f}, {0.225f * 1.0f, 0.3375f * 0.0f}, {0.225f * 1.0f, 0.3375f * 1.0f},
+        {0.225f * 0.0f, 0.3375f * 1.0f}, {0.225f * 0.0f, 0.3375f * 0.0f}, {0.225f * 2.0f, 0.3375f * 2.0f},
+        {0.225f * 1.0f, 0.3375f * 2.0f},
+    };
+    static float const kerning[] = {0.005f, 0.0085f, 0.04f, 0.05f, 0.01f, 0.02f, 0.0f, 0.0f, 0.025f, 0.0f};
+
+    __m512 const x = _mm512_mul_ps(_mm512_sub_ps(coords_x, _mm512_set1_ps(position.x)), _mm512_set1_ps(scale));
+    __m512 const y = _mm512_mul_ps(_mm512_sub_ps(coords_y, _mm512_set1_ps(position.y)), _mm512_set1_ps(scale));
+    float2 const half_size = f2divf((float2) {0.2365f, 0.3375f}, 2.0f);
+
+    __m512 result = _mm512_setzero_ps();
+    for (float i = 0.0f; i < 9; ++i)
+    {
+        uint32_t const digit = number % 10;
+        float2 const digit_position = {0.225f * (number_log - 1 - i), 0.0f};
+
+        __m512 const box_mask = render_sdf_to_mask_avx512(render_rectangle_sdf_avx512(x, y, f2add2(digit_position, half_size), half_size));
+        if (_mm512_cmp_ps_mask(box_mask, _mm512_setzero_ps(), _CMP_GT_OQ) != 0)
+        {
+            __m512 const sample_x = _mm512_add_ps(_mm512_add_ps(_mm512_sub_ps(x, _mm512_set1_ps(digit_position.x)),
+                                                                _mm512_set1_ps(offsets[digit].x)),
+                                                  _mm512_set1_ps(kerning[digit]));
+            __m512 const sample_y = _mm512_add_ps(_mm512_sub_ps(y, _mm512_set1_ps(digit_position.y)),
+                                                  _mm512_set1_ps(offsets[digit].y));
+            __m512 const letter_mask = _mm512_min_ps(render_font_median_avx512(sample_x, sample_y), box_mask);
+            result = _mm512_max_ps(letter_mask, result);
+        }
+
+        number /= 10;
+
+        if (number == 0) break;
+    }
+
+    return render_smoothstep_avx512(_mm512_set1_ps(1.0f - 0.5f), _mm512_set1_ps(1.0f), result);
+}
+
+RENDER_TARGET("avx512f")
+static __m512 render_mask_image_avx512(RenderMaskImage const *const image, int const x, int const y)
+{
+    if (y < image->y0 || y >= image->y1 || x + 16 <= image->x0 || x >= image->x1) return _mm512_setzero_ps();
+
+    float const *const row = &image->masks[(size_t) (y - image->y0) * (size_t) (image->x1 - image->x0)];
+    if (x >= image->x0 && x + 16 <= image->x1) return _mm512_loadu_ps(&row[x - image->x0]);
+
+    float lanes[16] = {0};
+    for (int i = 0; i < 16; ++i)
+    {
+        if (x + i >= image->x0 && x + i < image->x1) lanes[i] = row[x + i - image->x0];
+    }
+    return _mm512_loadu_ps(lanes);
+}
+
+RENDER_TARGET("avx512f")
+static void render_rect_avx512(RenderTarget const *const target, RenderScene const *const scene, uint32_t const shapes,
+                               int const x0, int const y0, int const x1, int const y1)
+{
+    ShaderConstants const *const constants = &scene->constants;
+    float const aspect_ratio = constants->aspect_ratio;
+    float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+    float2 const player2_score_position = {aspect_ratio - 0.075f - scene->player2_score_log10 * 0.225f / 5.0f, 0.87f};
+
+    float const inverse_width = 1.0f / (float) target->width;
+    float const inverse_height = 1.0f / (float) target->height;
+    __m512 const lanes = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+                                        8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f);
+    __m512 const zero = _mm512_setzero_ps();
+    __m512 const one = _mm512_set1_ps(1.0f);
+    __m512 const blend = _mm512_set1_ps(0.05f);
+
+    for (int y = y0; y < y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+        float const texture_y = 1.0f - ((float) y + 0.5f) * inverse_height;
+        __m512 const coords_y = _mm512_set1_ps(texture_y);
+
+        int x = x0;
+        for (; x + 16 <= x1; x += 16)
+        {
+            __m512 const texture_x = _mm512_mul_ps(_mm512_add_ps(_mm512_add_ps(_mm512_set1_ps((float) x), lanes),
+                                                                 _mm512_set1_ps(0.5f)),
+                                                   _mm512_set1_ps(inverse_width));
+            __m512 const coords_x = _mm512_mul_ps(texture_x, _mm512_set1_ps(aspect_ratio));
+
+            __m512 player1_score_mask = zero;
+            __m512 player2_score_mask = zero;
+            if (scene->score_images != NULL)
+            {
+                if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0) player1_score_mask = render_mask_image_avx512(&scene->score_images[0], x, y);
+                if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0) player2_score_mask = render_mask_image_avx512(&scene->score_images[1], x, y);
+            }
+            else
+            {
+                if ((shapes & RENDER_SHAPE_PLAYER1_SCORE) != 0)
+                {
+                    player1_score_mask = render_number_text_mask_avx512(coords_x, coords_y, (float2) {0.085f, 0.87f}, 5.0f,
+                                                                        constants->player1_score, scene->player1_score_log10);
+                }
+                if ((shapes & RENDER_SHAPE_PLAYER2_SCORE) != 0)
+                {
+                    player2_score_mask = render_number_text_mask_avx512(coords_x, coords_y, player2_score_position, 5.0f,
+                                                                        constants->player2_score, scene->player2_score_log10);
+                }
+            }
+
+            __m512 middle_line_mask = zero;
+            if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0 && scene->middle_line_image != NULL)
+            {
+                middle_line_mask = render_mask_image_avx512(scene->middle_line_image, x, y);
+            }
+            else if ((shapes & RENDER_SHAPE_MIDDLE_LINE) != 0)
+            {
+                __m512 middle_line = _mm512_sub_ps(render_abs_avx512(_mm512_sub_ps(coords_x, _mm512_set1_ps(0.5f * aspect_ratio))),
+                                                   _mm512_set1_ps(0.005f));
+                __m512 const pattern_value = _mm512_add_ps(render_abs_avx512(coords_y), _mm512_set1_ps(0.01f));
+                __m512 const pattern_quotient = _mm512_cvtepi32_ps(_mm512_cvttps_epi32(_mm512_div_ps(pattern_value, _mm512_set1_ps(0.1f))));
+                __m512 const middle_line_pattern = _mm512_sub_ps(_mm512_sub_ps(pattern_value, _mm512_mul_ps(_mm512_set1_ps(0.1f), pattern_quotient)),
+                                                                 _mm512_set1_ps(0.025f));
+                middle_line = _mm512_max_ps(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(middle_line_pattern), _mm512_set1_epi32((int) 0x80000000u))), middle_line);
+                middle_line_mask = render_sdf_to_mask_avx512(middle_line);
+            }
+            __m512 const overlay_mask = _mm512_max_ps(middle_line_mask, _mm512_max_ps(player2_score_mask, player1_score_mask));
+
+            __m512 red = overlay_mask;
+            __m512 green = overlay_mask;
+            __m512 blue = overlay_mask;
+            if ((shapes & RENDER_SHAPES_MOVING) != 0)
+            {
+                __m512 ball = _mm512_set1_ps(RENDER_SHAPE_FAR);
+                if ((shapes & RENDER_SHAPE_BALL) != 0)
+                {
+                    __m512 const ball_x = _mm512_sub_ps(coords_x, _mm512_set1_ps(constants->ball_position.x));
+                    __m512 const ball_y = _mm512_sub_ps(coords_y, _mm512_set1_ps(constants->ball_position.y));
+                    ball = _mm512_sub_ps(_mm512_sqrt_ps(_mm512_add_ps(_mm512_mul_ps(ball_x, ball_x), _mm512_mul_ps(ball_y, ball_y))),
+                                         _mm512_set1_ps(constants->ball_radius));
+                }
+                __m512 const player1 = (shapes & RENDER_SHAPE_PLAYER1) == 0 ? _mm512_set1_ps(RENDER_SHAPE_FAR) :
+                    render_rectangle_sdf_avx512(coords_x, coords_y, constants->player1_position, half_player_size);
+                __m512 const player2 = (shapes & RENDER_SHAPE_PLAYER2) == 0 ? _mm512_set1_ps(RENDER_SHAPE_FAR) :
+                    render_rectangle_sdf_avx512(coords_x, coords_y, constants->player2_position, half_player_size);
+
+                // the same permutations as render_pixel
+                __m512 const players = _mm512_min_ps(player1, player2);
+                __m512 final_sdf;
+                __m512 final_red = zero;
+                __m512 final_green = zero;
+                __m512 final_blue = zero;
+                if (scene->variant == SHADER_VARIANT_APART)
+                {
+                    final_sdf = _mm512_min_ps(ball, players);
+                    __mmask16 const is_ball = _mm512_cmp_ps_mask(ball, players, _CMP_LE_OQ);
+                    __mmask16 const is_player2 = (__mmask16) (~is_ball & _mm512_cmp_ps_mask(player2, player1, _CMP_LE_OQ));
+                    final_red = _mm512_maskz_mov_ps((__mmask16) ~(is_ball | is_player2), one);
+                    final_green = _mm512_maskz_mov_ps(is_player2, one);
+                    final_blue = _mm512_maskz_mov_ps(is_ball, one);
+                }
+                else
+                {
+                    switch (scene->variant)
+                    {
+                        case SHADER_VARIANT_PLAYER1:
+                            final_sdf = _mm512_min_ps(render_smin_avx512(ball, player1, blend), player2);
+                            break;
+                        case SHADER_VARIANT_PLAYER2:
+                            final_sdf = _mm512_min_ps(render_smin_avx512(ball, player2, blend), player1);
+                            break;
+                        default:
+                            final_sdf = render_smin_avx512(ball, players, blend);
+                            break;
+                    }
+
+                    __m512 mix = render_smoothstep_avx512(_mm512_sub_ps(player1, blend), player1, final_sdf);
+                    final_red = render_lerp_avx512(final_red, one, mix);
+                    final_green = render_lerp_avx512(final_green, zero, mix);
+                    final_blue = render_lerp_avx512(final_blue, zero, mix);
+                    mix = render_smoothstep_avx512(_mm512_sub_ps(player2, blend), player2, final_sdf);
+                    final_red = render_lerp_avx512(final_red, zero, mix);
+                    final_green = render_lerp_avx512(final_green, one, mix);
+                    final_blue = render_lerp_avx512(final_blue, zero, mix);
+                    mix = render_smoothstep_avx512(_mm512_sub_ps(ball, blend), ball, final_sdf);
+                    final_red = render_lerp_avx512(final_red, zero, mix);
+                    final_green = render_lerp_avx512(final_green, zero, mix);
+                    final_blue = render_lerp_avx512(final_blue, one, mix);
+                }
+
+                __m512 const final_mask = render_sdf_to_mask_avx512(final_sdf);
+
+                red = render_lerp_avx512(overlay_mask, final_red, final_mask);
+                green = render_lerp_avx512(overlay_mask, final_green, final_mask);
+                blue = render_lerp_avx512(overlay_mask, final_blue, final_mask);
+            }
+
+            __m512 const scale = _mm512_set1_ps(255.0f);
+            __m512 const half = _mm512_set1_ps(0.5f);
+            __m512i const r = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(render_clamp_avx512(red, zero, one), scale), half));
+            __m512i const g = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(render_clamp_avx512(green, zero, one), scale), half));
+            __m512i const b = _mm512_cvttps_epi32(_mm512_add_ps(_mm512_mul_ps(render_clamp_avx512(blue, zero, one), scale), half));
+            __m512i const pixels = _mm512_or_si512(_mm512_or_si512(r, _mm512_slli_epi32(g, 8)),
+                                                   _mm512_or_si512(_mm512_slli_epi32(b, 16), _mm512_set1_epi32((int) 0xFF000000u)));
+            _mm512_storeu_si512(&row[x], pixels);
+        }
+
+        for (; x < x1; ++x)
+        {
+            float2 const texture_coord = {((float) x + 0.5f) * inverse_width, texture_y};
+            row[x] = render_pack(render_pixel(scene, shapes, texture_coord, x, y));
+        }
+    }
+}
+
+#endif
+
+static inline RenderIsa render_best_isa(void)
+{
+#ifdef RENDER_HAS_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return RENDER_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return RENDER_ISA_AVX2;
+#endif
+    return RENDER_ISA_SCALAR;
+}
+
+static inline char const *RenderIsa_name(RenderIsa const isa)
+{
+    switch (isa)
+    {
+        case RENDER_ISA_AVX512: return "avx512";
+        case RENDER_ISA_AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+// render_rect with the kernel for isa, which the cpu has to support
+static void render_rect_isa(RenderTarget const *const target, RenderScene const *const scene, RenderIsa const isa,
+                            uint32_t const shapes, int const x0, int const y0, int const x1, int const y1)
+{
+    switch (isa)
+    {
+#ifdef RENDER_HAS_SIMD
+        case RENDER_ISA_AVX512:
+        {
+            render_rect_avx512(target, scene, shapes, x0, y0, x1, y1);
+            break;
+        }
+
+        case RENDER_ISA_AVX2:
+        {
+            render_rect_avx2(target, scene, shapes, x0, y0, x1, y1);
+            break;
+        }
+#endif
+
+        default:
+        {
+            render_rect(target, scene, shapes, x0, y0, x1, y1);
+            break;
+        }
+    }
+}
+
+static void render_frame_isa(RenderTarget const *const target, ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScene const scene = render_scene(constants);
+    render_rect_isa(target, &scene, isa, RENDER_SHAPES_ALL, 0, 0, target->width, target->height);
+}
@@ -0,0 +1,378 @@
+#pragma once
+
+// draws frames of render.h by blending the ball and the paddles out of sprites instead of working out their
+// distance fields for every pixel. their shapes never change, only where they are, so each one is rasterized
+// into 8 bit masks at phase_count subpixel offsets in either direction, the first time an offset is needed
+// after the target changed size, and a frame blends the mask of the offset closest to where the shape is onto
+// a copy of the static layer. that is up to half a phase off, which only shows on the antialiased edges.
+// where the ball is close enough to a paddle to blend with it, see SHADER_BLEND_GAP, the pixels both of them
+// can reach are shaded exactly instead, everywhere else no pixel is covered by more than one shape.
+// like render_dirty.h the target has to be the framebuffer of the last frame unless it changed size.
+// needs timing.h, render.h, render_simd.h, render_tiles.h and render_dirty.h
+
+#define RENDER_SPRITE_PHASES (16)
+
+// the sprites of the ball and both paddles and the exact rects around the ball and either paddle
+#define RENDER_SPRITES_MAX_RECTS (3 + 2)
+
+typedef struct RenderSprite
+{
+    // phase_count * phase_count masks of width * height. in the mask of phase (x, y) the center of the shape is
+    // radius_x + x / phase_count pixels from the left and radius_y + y / phase_count pixels from the top
+    uint8_t *masks;
+    bool *is_drawn;
+    size_t capacity;
+
+    int width;
+    int height;
+    int radius_x;
+    int radius_y;
+} RenderSprite;
+
+typedef struct RenderSprites
+{
+    // may be set before the first frame, RENDER_SPRITE_PHASES if it is 0
+    int phase_count;
+
+    RenderSprite ball;
+    RenderSprite player;
+
+    // the static layer at the size of the target, the middle line and the scores
+    uint32_t *background;
+    size_t background_capacity;
+
+    // what the framebuffer, the sprites and the background were drawn for
+    RenderTarget target;
+    ShaderConstants constants;
+    bool is_valid;
+
+    // the pixels the last frame drew on top of the background
+    RenderBounds rects[RENDER_SPRITES_MAX_RECTS];
+    int rect_count;
+
+    // the last frame
+    uint64_t blended_count;
+    uint64_t shaded_count;
+    bool was_full;
+
+    uint64_t rasterized_count;
+    uint64_t rasterize_ns;
+} RenderSprites;
+
+// the framebuffer changed behind the renderer's back, the next frame is drawn in full
+static inline void RenderSprites_invalidate(RenderSprites *const this)
+{
+    this->is_valid = false;
+}
+
+// sizes sprite for a shape that reaches half_size from its center on target, forgetting every mask drawn before
+static bool RenderSprite_setup(RenderSprite *const this, int const phase_count, RenderTarget const *const target,
+                               float const aspect_ratio, float2 const half_size)
+{
+    // the edge of the mask fades out 0.002 from the shape and a phase moves the shape by up to a pixel
+    this->radius_x = -(int) ffloor(-(half_size.x + 0.002f) * (float) target->width / aspect_ratio) + 1;
+    this->radius_y = -(int) ffloor(-(half_size.y + 0.002f) * (float) target->height) + 1;
+    this->width = 2 * this->radius_x + 2;
+    this->height = 2 * this->radius_y + 2;
+
+    size_t const phase_total = (size_t) phase_count * (size_t) phase_count;
+    size_t const size = phase_total * (size_t) this->width * (size_t) this->height;
+    if (size > this->capacity)
+    {
+        uint8_t *const masks = realloc(this->masks, size);
+        if (masks == NULL) return false;
+
+        this->masks = masks;
+        this->capacity = size;
+    }
+
+    bool *const is_drawn = realloc(this->is_drawn, phase_total * sizeof(bool));
+    if (is_drawn == NULL) return false;
+    this->is_drawn = is_drawn;
+    for (size_t i = 0; i < phase_total; ++i) is_drawn[i] = false;
+    return true;
+}
+
+static inline uint8_t *RenderSprite_mask(RenderSprite const *const this, int const phase_count,
+                                         int const phase_x, int const phase_y)
+{
+    size_t const phase = (size_t) phase_y * (size_t) phase_count + (size_t) phase_x;
+    return &this->masks[phase * (size_t) this->width * (size_t) this->height];
+}
+
+// the masks of render_sdf_to_mask for the ball, or a paddle if is_ball is false, at the same coordinates
+// render_rect uses relative to the center of the shape
+static void RenderSprite_rasterize(RenderSprite *const this, int const phase_count, int const phase_x, int const phase_y,
+                                   bool const is_ball, RenderTarget const *const target,
+                                   ShaderConstants const *const constants)
+{
+    float const pixel_width = constants->aspect_ratio / (float) target->width;
+    float const pixel_height = 1.0f / (float) target->height;
+    float const center_x = (float) this->radius_x + (float) phase_x / (float) phase_count;
+    float const center_y = (float) this->radius_y + (float) phase_y / (float) phase_count;
+    float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+
+    uint8_t *const mask = RenderSprite_mask(this, phase_count, phase_x, phase_y);
+    for (int y = 0; y < this->height; ++y)
+    {
+        for (int x = 0; x < this->width; ++x)
+        {
+            float2 const coords = {((float) x - center_x) * pixel_width, (center_y - (float) y) * pixel_height};
+            float const sdf = is_ball ? render_circle_sdf(coords, (float2) {0.0f, 0.0f}, constants->ball_radius) :
+                render_rectangle_sdf(coords, (float2) {0.0f, 0.0f}, half_player_size);
+            mask[(size_t) y * (size_t) this->width + (size_t) x] = (uint8_t) (render_sdf_to_mask(sdf) * 255.0f + 0.5f);
+        }
+    }
+
+    this->is_drawn[phase_y * phase_count + phase_x] = true;
+}
+
+// the pixel the center of a shape at position falls into and the phase closest to where in it
+static inline void render_sprites_place(float const position, int const phase_count, int *const pixel, int *const phase)
+{
+    float const whole = ffloor(position);
+    *pixel = (int) whole;
+    *phase = (int) ((position - whole) * (float) phase_count + 0.5f);
+    if (*phase == phase_count)
+    {
+        *phase = 0;
+        ++*pixel;
+    }
+}
+
+static inline bool render_sprites_clip(RenderTarget const *const target, RenderBounds *const rect)
+{
+    rect->x0 = rect->x0 > 0 ? rect->x0 : 0;
+    rect->y0 = rect->y0 > 0 ? rect->y0 : 0;
+    rect->x1 = rect->x1 < target->width ? rect->x1 : target->width;
+    rect->y1 = rect->y1 < target->height ? rect->y1 : target->height;
+    return rect->x0 < rect->x1 && rect->y0 < rect->y1;
+}
+
+// blends color onto count pixels by the masks, rounding like (pixel * (255 - mask) + color * mask) / 255
+static void render_sprites_blend(uint32_t *const pixels, uint8_t const *const masks, uint32_t const color, int const count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        uint32_t const mask = masks[i];
+        uint32_t result = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            uint32_t const sum = (pixels[i] >> shift & 0xFF) * (255 - mask) + (color >> shift & 0xFF) * mask + 128;
+            result |= (sum + (sum >> 8)) >> 8 << shift;
+        }
+        pixels[i] = result;
+    }
+}
+
+#ifdef RENDER_HAS_SIMD
+// render_sprites_blend 8 pixels at a time, in 16 bit lanes
+RENDER_TARGET("avx2")
+static void render_sprites_blend_avx2(uint32_t *const pixels, uint8_t const *const masks, uint32_t const color, int const count)
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const max = _mm256_set1_epi16(255);
+    __m256i const round = _mm256_set1_epi16(128);
+    __m256i const color_wide = _mm256_unpacklo_epi8(_mm256_set1_epi32((int) color), zero);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i const pixel = _mm256_loadu_si256((__m256i const *) &pixels[i]);
+
+        // every mask in all 4 bytes of its pixel
+        __m256i const mask = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((__m128i const *) &masks[i])),
+                                                _mm256_set1_epi32(0x01010101));
+
+        __m256i halves[2];
+        for (int half = 0; half < 2; ++half)
+        {
+            __m256i const pixel_wide = half == 0 ? _mm256_unpacklo_epi8(pixel, zero) : _mm256_unpackhi_epi8(pixel, zero);
+            __m256i const mask_wide = half == 0 ? _mm256_unpacklo_epi8(mask, zero) : _mm256_unpackhi_epi8(mask, zero);
+            __m256i const sum = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(pixel_wide, _mm256_sub_epi16(max, mask_wide)),
+                                                                  _mm256_mullo_epi16(color_wide, mask_wide)),
+                                                 round);
+            halves[half] = _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)), 8);
+        }
+
+        _mm256_storeu_si256((__m256i *) &pixels[i], _mm256_packus_epi16(halves[0], halves[1]));
+    }
+
+    render_sprites_blend(&pixels[i], &masks[i], color, count - i);
+}
+#endif
+
+// blends the mask of sprite for a shape at position onto target in color, returns the pixels it covers
+static RenderBounds RenderSprites_blit(RenderSprites *const this, RenderSprite *const sprite, bool const is_ball,
+                                       RenderTarget const *const target, ShaderConstants const *const constants,
+                                       float2 const position, uint32_t const color, RenderIsa const isa)
+{
+    int const phase_count = this->phase_count;
+
+    // the pixel whose center is at position, see render_rect for how pixels map to coords
+    int center_x, center_y, phase_x, phase_y;
+    render_sprites_place(position.x / constants->aspect_ratio * (float) target->width - 0.5f, phase_count,
+                         &center_x, &phase_x);
+    render_sprites_place((1.0f - position.y) * (float) target->height - 0.5f, phase_count, &center_y, &phase_y);
+
+    if (!sprite->is_drawn[phase_y * phase_count + phase_x])
+    {
+        uint64_t const time_start = time_now_ns();
+        RenderSprite_rasterize(sprite, phase_count, phase_x, phase_y, is_ball, target, constants);
+        this->rasterize_ns += time_now_ns() - time_start;
+        ++this->rasterized_count;
+    }
+
+    int const x0 = center_x - sprite->radius_x;
+    int const y0 = center_y - sprite->radius_y;
+    RenderBounds rect = {x0, y0, x0 + sprite->width, y0 + sprite->height};
+    if (!render_sprites_clip(target, &rect)) return (RenderBounds) {0, 0, 0, 0};
+
+    uint8_t const *const mask = RenderSprite_mask(sprite, phase_count, phase_x, phase_y);
+    int const count = rect.x1 - rect.x0;
+    for (int y = rect.y0; y < rect.y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch + (size_t) rect.x0];
+        uint8_t const *const mask_row = &mask[(size_t) (y - y0) * (size_t) sprite->width + (size_t) (rect.x0 - x0)];
+#ifdef RENDER_HAS_SIMD
+        // the blend is integer math, which avx2 already covers for the avx512 kernel
+        if (isa >= RENDER_ISA_AVX2)
+        {
+            render_sprites_blend_avx2(row, mask_row, color, count);
+            continue;
+        }
+#endif
+        render_sprites_blend(row, mask_row, color, count);
+    }
+
+    (void) isa;
+    return rect;
+}
+
+static void RenderSprites_restore(RenderSprites const *const this, RenderTarget const *const target,
+                                  RenderBounds const *const rect)
+{
+    for (int y = rect->y0; y < rect->y1; ++y)
+    {
+        uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+        uint32_t const *const background_row = &this->background[(size_t) y * (size_t) target->width];
+        for (int x = rect->x0; x < rect->x1; ++x) row[x] = background_row[x];
+    }
+}
+
+// draws constants into target, which has to be the framebuffer of the last frame unless it changed size.
+// returns false if there is no memory for the sprites, target is left alone then
+static bool RenderSprites_draw(RenderSprites *const this, RenderTarget const *const target,
+                               ShaderConstants const *const constants, RenderIsa const isa)
+{
+    RenderScene const scene = render_scene(constants);
+    RenderBounds bounds[RENDER_SHAPE_COUNT];
+    render_tiles_shape_bounds(target, &scene, bounds);
+
+    ShaderConstants const *const last = &this->constants;
+    bool const is_resized = !this->is_valid ||
+        target->width != this->target.width || target->height != this->target.height ||
+        constants->aspect_ratio != last->aspect_ratio || constants->ball_radius != last->ball_radius ||
+        constants->player_size.x != last->player_size.x || constants->player_size.y != last->player_size.y;
+    bool const is_full = is_resized || target->pixels != this->target.pixels || target->pitch != this->target.pitch ||
+        constants->player1_score != last->player1_score || constants->player2_score != last->player2_score;
+
+    if (is_resized)
+    {
+        this->is_valid = false;
+        this->phase_count = this->phase_count > 0 ? this->phase_count : RENDER_SPRITE_PHASES;
+
+        float const ball_size = constants->ball_radius;
+        float2 const half_player_size = f2divf(constants->player_size, 2.0f);
+        if (!RenderSprite_setup(&this->ball, this->phase_count, target, constants->aspect_ratio, (float2) {ball_size, ball_size}) ||
+            !RenderSprite_setup(&this->player, this->phase_count, target, constants->aspect_ratio, half_player_size))
+        {
+            return false;
+        }
+
+        size_t const pixel_count = (size_t) target->width * (size_t) target->height;
+        if (pixel_count > this->background_capacity)
+        {
+            uint32_t *const background = realloc(this->background, pixel_count * sizeof(uint32_t));
+            if (background == NULL) return false;
+
+            this->background = background;
+            this->background_capacity = pixel_count;
+        }
+    }
+
+    if (is_full)
+    {
+        RenderTarget const background = {this->background, target->width, target->height, target->width};
+        render_rect_isa(&background, &scene, isa, RENDER_SHAPES_ALL & ~RENDER_SHAPES_MOVING,
+                        0, 0, target->width, target->height);
+
+        RenderBounds const all = {0, 0, target->width, target->height};
+        RenderSprites_restore(this, target, &all);
+    }
+    else
+    {
+        for (int i = 0; i < this->rect_count; ++i) RenderSprites_restore(this, target, &this->rects[i]);
+    }
+
+    this->rect_count = 0;
+    this->blended_count = 0;
+    this->shaded_count = 0;
+
+    RenderBounds const sprite_rects[3] = {
+        RenderSprites_blit(this, &this->player, false, target, constants, constants->player1_position, 0xFF0000FFu, isa),
+        RenderSprites_blit(this, &this->player, false, target, constants, constants->player2_position, 0xFF00FF00u, isa),
+        RenderSprites_blit(this, &this->ball, true, target, constants, constants->ball_position, 0xFFFF0000u, isa),
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+        this->rects[this->rect_count++] = sprite_rects[i];
+        this->blended_count += (uint64_t) render_dirty_area(&sprite_rects[i]);
+    }
+
+    // the ball can only blend with a paddle where both bounds meet
+    ShaderVariant const variant = shader_variant(constants);
+    for (int player = 1; player <= 2; ++player)
+    {
+        bool const is_near = variant == SHADER_VARIANT_FULL ||
+            (player == 1 ? variant == SHADER_VARIANT_PLAYER1 : variant == SHADER_VARIANT_PLAYER2);
+        if (!is_near) continue;
+
+        RenderBounds rect = {
+            .x0 = bounds[0].x0 > bounds[player].x0 ? bounds[0].x0 : bounds[player].x0,
+            .y0 = bounds[0].y0 > bounds[player].y0 ? bounds[0].y0 : bounds[player].y0,
+            .x1 = bounds[0].x1 < bounds[player].x1 ? bounds[0].x1 : bounds[player].x1,
+            .y1 = bounds[0].y1 < bounds[player].y1 ? bounds[0].y1 : bounds[player].y1,
+        };
+        if (!render_sprites_clip(target, &rect)) continue;
+
+        uint32_t shapes = 0;
+        for (int j = 0; j < RENDER_SHAPE_COUNT; ++j)
+        {
+            if (bounds[j].x0 < rect.x1 && bounds[j].x1 > rect.x0 && bounds[j].y0 < rect.y1 && bounds[j].y1 > rect.y0)
+            {
+                shapes |= 1u << j;
+            }
+        }
+
+        render_rect_isa(target, &scene, isa, shapes, rect.x0, rect.y0, rect.x1, rect.y1);
+        this->rects[this->rect_count++] = rect;
+        this->shaded_count += (uint64_t) render_dirty_area(&rect);
+    }
+
+    this->target = *target;
+    this->constants = *constants;
+    this->is_valid = true;
+    this->was_full = is_full;
+    return true;
+}
+
+static void RenderSprites_free(RenderSprites *const this)
+{
+    free(this->ball.masks);
+    free(this->ball.is_drawn);
+    free(this->player.masks);
+    free(this->player.is_drawn);
+    free(this->background);
+    *this = (RenderSprites) {0};
+}
@@ -0,0 +1,316 @@
+#pragma once
+
+// draws frames of render.h in square tiles on a pool of threads that lives as long as the renderer.
+// every frame the bounding box of each shape is turned into a pixel rectangle, a tile only shades the
+// shapes whose rectangle touches it and a tile that touches none is filled with the background.
+// the ball and the paddles are grown by RENDER_CULL_MARGIN, the score boxes and the middle line by the
+// 0.002 where render_sdf_to_mask becomes 0, and every rectangle by one more pixel for rounding,
+// so a tile draws exactly the pixels render_frame does.
+// the thread that draws a frame claims tiles like the workers do, so a pool of 1 thread has no workers.
+// needs thread.h, render.h and render_simd.h
+
+#define RENDER_TILE_SIZE (64)
+
+#define RENDER_MAX_THREADS (256)
+
+// the 0.05 of smin plus the 0.05 the colors blend over. a moving shape at least this far from every
+// pixel of a tile cannot change the tile, see RENDER_SHAPE_FAR
+#define RENDER_CULL_MARGIN (0.05f + 0.05f)
+
+// the tile counter below has 16 bits, larger frames are drawn by the calling thread alone
+#define RENDER_MAX_TILES (0xFFFFu)
+
+#define RENDER_SHAPE_COUNT (6)
+
+// the pixels from (x0, y0) up to but not including (x1, y1)
+typedef struct RenderBounds
+{
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+} RenderBounds;
+
+typedef struct RenderTileStats
+{
+    uint32_t shaded_count;
+    uint32_t empty_count;
+} RenderTileStats;
+
+struct RenderPool;
+
+typedef struct RenderWorker
+{
+    _Alignas(64) RenderTileStats stats;
+    struct RenderPool *pool;
+    Thread thread;
+} RenderWorker;
+
+typedef struct RenderPool
+{
+    // the frame being drawn, only written while no tile of it is claimed
+    RenderTarget const *target;
+    RenderScene scene;
+    RenderIsa isa;
+    RenderBounds bounds[RENDER_SHAPE_COUNT];
+    int column_count;
+    RenderTileStats stats;
+
+    // generation << 32 | tile count << 16 | next tile. the tile count is part of it so a worker that
+    // is late for a frame never has to read the frame itself before it holds one of its tiles
+    _Alignas(64) _Atomic uint64_t work;
+    _Alignas(64) _Atomic uint32_t done_count;
+    _Atomic bool is_running;
+
+    uint32_t generation;
+    int thread_count;
+    RenderWorker workers[RENDER_MAX_THREADS];
+} RenderPool;
+
+// the pixel a coordinate of ps_main falls in rounded down (or up), kept within a pixel of the target so
+// shapes far off screen do not overflow
+static inline int render_tiles_pixel(float const value, int const size, bool const is_up)
+{
+    float const clamped = fclamp(value, -2.0f, (float) size + 2.0f);
+    return is_up ? -(int) ffloor(-clamped) : (int) ffloor(clamped);
+}
+
+// the pixels that may see coords from (x0, y0) to (x1, y1), see render_rect for how pixels map to coords
+static RenderBounds render_tiles_bounds(RenderTarget const *const target, float const aspect_ratio,
+                                        float const x0, float const y0, float const x1, float const y1)
+{
+    float const width = (float) target->width;
+    float const height = (float) target->height;
+    return (RenderBounds) {
+        .x0 = render_tiles_pixel(x0 / aspect_ratio * width - 0.5f, target->width, false) - 1,
+        .y0 = render_tiles_pixel((1.0f - y1) * height - 0.5f, target->height, false) - 1,
+        .x1 = render_tiles_pixel(x1 / aspect_ratio * width - 0.5f, target->width, true) + 2,
+        .y1 = render_tiles_pixel((1.0f - y0) * height - 0.5f, target->height, true) + 2,
+    };
+}
+
+// the box around the digits render_number_text_mask draws for number at position
+static RenderBounds render_tiles_score_bounds(RenderTarget const *const target, float const aspect_ratio,
+                                              float2 const position, float const scale,
+                                              uint32_t number, float const number_log)
+{
+    int digit_count = 1;
+    while (number >= 10 && digit_count < 9)
+    {
+        number /= 10;
+        ++digit_count;
+    }
+
+    float const margin = 0.002f / scale;
+    return render_tiles_bounds(target, aspect_ratio,
+                               position.x + 0.225f * (number_log - (float) digit_count) / scale - margin,
+                               position.y - margin,
+                               position.x + (0.225f * (number_log - 1.0f) + 0.2365f) / scale + margin,
+                               position.y + 0.3375f / scale + margin);
+}
+
+static void render_tiles_shape_bounds(RenderTarget const *const target, RenderScene const *const scene,
+                                      RenderBounds bounds[RENDER_SHAPE_COUNT])
+{
+    ShaderConstants const *const constants = &scene->constants;
+    float const aspect_ratio = constants->aspect_ratio;
+
+    float const ball_size = constants->ball_radius + RENDER_CULL_MARGIN;
+    bounds[0] = render_tiles_bounds(target, aspect_ratio,
+                                    constants->ball_position.x - ball_size, constants->ball_position.y - ball_size,
+                                    constants->ball_position.x + ball_size, constants->ball_position.y + ball_size);
+
+    float2 const player_size = {constants->player_size.x / 2.0f + RENDER_CULL_MARGIN,
+                                constants->player_size.y / 2.0f + RENDER_CULL_MARGIN};
+    bounds[1] = render_tiles_bounds(target, aspect_ratio,
+                                    constants->player1_position.x - player_size.x, constants->player1_position.y - player_size.y,
+                                    constants->player1_position.x + player_size.x, constants->player1_position.y + player_size.y);
+    bounds[2] = render_tiles_bounds(target, aspect_ratio,
+                                    constants->player2_position.x - player_size.x, constants->player2_position.y - player_size.y,
+                                    constants->player2_position.x + player_size.x, constants->player2_position.y + player_size.y);
+
+    // the dashes repeat forever, only the width of the line is worth culling
+    bounds[3] = render_tiles_bounds(target, aspect_ratio, 0.5f * aspect_ratio - 0.007f, 0.0f,
+                                    0.5f * aspect_ratio + 0.007f, 1.0f);
+
+    bounds[4] = render_tiles_score_bounds(target, aspect_ratio, (float2) {0.085f, 0.87f}, 5.0f,
+                                          constants->player1_score, scene->player1_score_log10);
+    bounds[5] = render_tiles_score_bounds(target, aspect_ratio,
+                                          (float2) {aspect_ratio - 0.075f - scene->player2_score_log10 * 0.225f / 5.0f, 0.87f},
+                                          5.0f, constants->player2_score, scene->player2_score_log10);
+}
+
+static void RenderPool_draw_tile(RenderPool *const this, uint32_t const tile, RenderTileStats *const stats)
+{
+    RenderTarget const *const target = this->target;
+    int const x0 = (int) (tile % (uint32_t) this->column_count) * RENDER_TILE_SIZE;
+    int const y0 = (int) (tile / (uint32_t) this->column_count) * RENDER_TILE_SIZE;
+    int const x1 = x0 + RENDER_TILE_SIZE < target->width ? x0 + RENDER_TILE_SIZE : target->width;
+    int const y1 = y0 + RENDER_TILE_SIZE < target->height ? y0 + RENDER_TILE_SIZE : target->height;
+
+    uint32_t shapes = 0;
+    for (int i = 0; i < RENDER_SHAPE_COUNT; ++i)
+    {
+        RenderBounds const *const bounds = &this->bounds[i];
+        if (bounds->x0 < x1 && bounds->x1 > x0 && bounds->y0 < y1 && bounds->y1 > y0) shapes |= 1u << i;
+    }
+
+    if (shapes == 0)
+    {
+        // what render_pixel returns without any shapes
+        for (int y = y0; y < y1; ++y)
+        {
+            uint32_t *const row = &target->pixels[(size_t) y * (size_t) target->pitch];
+            for (int x = x0; x < x1; ++x) row[x] = 0xFF000000u;
+        }
+        ++stats->empty_count;
+    }
+    else
+    {
+        render_rect_isa(target, &this->scene, this->isa, shapes, x0, y0, x1, y1);
+        ++stats->shaded_count;
+    }
+}
+
+// draws tiles of the current frame until none are left to claim, returns whether it drew any
+static bool RenderPool_work(RenderPool *const this, RenderTileStats *const stats)
+{
+    bool has_worked = false;
+    uint64_t work = atomic_load_explicit(&this->work, memory_order_acquire);
+    for (;;)
+    {
+        uint32_t const tile = (uint32_t) work & 0xFFFFu;
+        uint32_t const tile_count = (uint32_t) (work >> 16) & 0xFFFFu;
+        if (tile >= tile_count) return has_worked;
+
+        // the generation is part of work so a claim can never land in a later frame
+        if (atomic_compare_exchange_weak_explicit(&this->work, &work, work + 1,
+                                                  memory_order_acquire, memory_order_acquire))
+        {
+            RenderPool_draw_tile(this, tile, stats);
+            atomic_fetch_add_explicit(&this->done_count, 1, memory_order_release);
+            has_worked = true;
+            work = atomic_load_explicit(&this->work, memory_order_acquire);
+        }
+    }
+}
+
+static void RenderWorker_run(void *const argument)
+{
+    RenderWorker *const this = argument;
+    RenderPool *const pool = this->pool;
+
+    ThreadTimer timer;
+    ThreadTimer_init(&timer);
+
+    // spin for a little while after a frame since the next one usually is not far, then give the core away
+    uint32_t idle_count = 0;
+    while (atomic_load_explicit(&pool->is_running, memory_order_relaxed))
+    {
+        if (RenderPool_work(pool, &this->stats))
+        {
+            idle_count = 0;
+        }
+        else if (idle_count < 256)
+        {
+            ++idle_count;
+            thread_pause();
+        }
+        else if (idle_count < 512)
+        {
+            ++idle_count;
+            thread_yield();
+        }
+        else
+        {
+            ThreadTimer_sleep_ns(&timer, 100000);
+        }
+    }
+
+    ThreadTimer_free(&timer);
+}
+
+// the calling thread is one of thread_count, returns how many threads the pool ended up with
+static int RenderPool_start(RenderPool *const this, int thread_count)
+{
+    if (thread_count < 1) thread_count = 1;
+    if (thread_count > RENDER_MAX_THREADS) thread_count = RENDER_MAX_THREADS;
+
+    this->generation = 0;
+    atomic_store_explicit(&this->work, 0, memory_order_relaxed);
+    atomic_store_explicit(&this->done_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&this->is_running, true, memory_order_relaxed);
+
+    this->thread_count = 1;
+    for (int i = 1; i < thread_count; ++i)
+    {
+        RenderWorker *const worker = &this->workers[this->thread_count];
+        worker->pool = this;
+        worker->stats = (RenderTileStats) {0};
+        if (!Thread_create(&worker->thread, &RenderWorker_run, worker)) break;
+        ++this->thread_count;
+    }
+
+    return this->thread_count;
+}
+
+static void RenderPool_stop(RenderPool *const this)
+{
+    atomic_store_explicit(&this->is_running, false, memory_order_relaxed);
+    for (int i = 1; i < this->thread_count; ++i)
+    {
+        Thread_join(&this->workers[i].thread);
+    }
+    this->thread_count = 1;
+}
+
+// draws a whole frame like render_frame_isa and returns once every tile is done.
+// the tile counts of the frame end up in this->stats
+static void RenderPool_draw(RenderPool *const this, RenderTarget const *const target,
+                            ShaderConstants const *const constants, RenderIsa const isa)
+{
+    this->target = target;
+    this->scene = render_scene(constants);
+    this->isa = isa;
+    render_tiles_shape_bounds(target, &this->scene, this->bounds);
+    this->column_count = (target->width + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+
+    int const row_count = (target->height + RENDER_TILE_SIZE - 1) / RENDER_TILE_SIZE;
+    uint32_t const tile_count = (uint32_t) this->column_count * (uint32_t) row_count;
+
+    RenderTileStats *const stats = &this->workers[0].stats;
+    for (int i = 0; i < this->thread_count; ++i)
+    {
+        this->workers[i].stats = (RenderTileStats) {0};
+    }
+
+    if (tile_count > RENDER_MAX_TILES)
+    {
+        for (uint32_t tile = 0; tile < tile_count; ++tile) RenderPool_draw_tile(this, tile, stats);
+        this->stats = *stats;
+        return;
+    }
+
+    ++this->generation;
+    atomic_store_explicit(&this->done_count, 0, memory_order_relaxed);
+
+    // publishes everything above to the workers that see this generation
+    atomic_store_explicit(&this->work, (uint64_t) this->generation << 32 | (uint64_t) tile_count << 16,
+                          memory_order_release);
+
+    RenderPool_work(this, stats);
+
+    // the last tiles may still be drawn by workers, which may need this core to finish them
+    for (uint32_t spin_count = 0; atomic_load_explicit(&this->done_count, memory_order_acquire) < tile_count; ++spin_count)
+    {
+        if (spin_count < 256) thread_pause();
+        else thread_yield();
+    }
+
+    this->stats = (RenderTileStats) {0};
+    for (int i = 0; i < this->thread_count; ++i)
+    {
+        this->stats.shaded_count += this->workers[i].stats.shaded_count;
+        this->stats.empty_count += this->workers[i].stats.empty_count;
+    }
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+// dynamic resolution. ps_main costs about the same for every pixel, so the frame time scales with the pixel
+// count, and a window too big for the gpu drops frames. the governor looks at the time of each frame and picks
+// the scale of the size frames are drawn at before they are stretched over the window, in sixteenths of the
+// width and the height. it goes down as far as it takes to fit the budget at once but only goes up one step at a
+// time, after the frames were cheap enough for a while that even the next step would leave headroom, which
+// keeps it from going back and forth between two steps. every change is logged.
+// needs neither the crt nor the os, so it is the same in main.c and the benches of headless.c.
+// needs latency.h
+
+// the gpu time the frame pass may take, a bit under a frame at 60 hz for everything else.
+// build with -DRESOLUTION_BUDGET_NS=... for another one
+#ifndef RESOLUTION_BUDGET_NS
+#define RESOLUTION_BUDGET_NS (12000000u)
+#endif
+
+#define RESOLUTION_SCALE_ONE (16)
+#define RESOLUTION_SCALE_MIN (8)
+#define RESOLUTION_SCALE_COUNT (RESOLUTION_SCALE_ONE - RESOLUTION_SCALE_MIN + 1)
+
+// frames averaged for each decision
+#define RESOLUTION_WINDOW (8)
+
+// fractions of the budget in percent. above RESOLUTION_HIGH the scale goes down to where the frames should take
+// RESOLUTION_TARGET, and it only goes up when the next step should take less than RESOLUTION_LOW for
+// RESOLUTION_RAISE_WINDOWS windows in a row
+#define RESOLUTION_HIGH (95)
+#define RESOLUTION_TARGET (85)
+#define RESOLUTION_LOW (75)
+#define RESOLUTION_RAISE_WINDOWS (4)
+
+// the frames of the window after a change may still have been drawn at the old size, the gpu runs behind
+#define RESOLUTION_SETTLE_WINDOWS (1)
+
+#define RESOLUTION_LOG_CAPACITY (64)
+
+typedef struct ResolutionChange
+{
+    uint64_t frame;
+    uint64_t average_ns;
+    int from;
+    int to;
+} ResolutionChange;
+
+typedef struct ResolutionGovernor
+{
+    uint64_t budget_ns;
+    int scale;
+
+    uint64_t window_ns;
+    int window_count;
+    int settle_count;
+    int raise_count;
+
+    uint64_t frame_count;
+    uint64_t frame_counts[RESOLUTION_SCALE_COUNT];
+    uint64_t over_budget_count;
+
+    // the last RESOLUTION_LOG_CAPACITY changes, change_count of them in all
+    ResolutionChange log[RESOLUTION_LOG_CAPACITY];
+    uint64_t change_count;
+} ResolutionGovernor;
+
+static void ResolutionGovernor_init(ResolutionGovernor *const this, uint64_t const budget_ns)
+{
+    *this = (ResolutionGovernor) {.budget_ns = budget_ns, .scale = RESOLUTION_SCALE_ONE};
+}
+
+// size scaled by the current scale, never 0
+static inline int ResolutionGovernor_size(ResolutionGovernor const *const this, int const size)
+{
+    int const scaled = (size * this->scale + RESOLUTION_SCALE_ONE - 1) / RESOLUTION_SCALE_ONE;
+    return scaled > 0 ? scaled : 1;
+}
+
+// what frames that took average_ns at scale should take at to
+static inline uint64_t resolution_predict_ns(uint64_t const average_ns, int const scale, int const to)
+{
+    return average_ns * (uint64_t) (to * to) / (uint64_t) (scale * scale);
+}
+
+static void ResolutionGovernor_change(ResolutionGovernor *const this, int const to, uint64_t const average_ns)
+{
+    this->log[this->change_count % RESOLUTION_LOG_CAPACITY] = (ResolutionChange) {
+        .frame = this->frame_count,
+        .average_ns = average_ns,
+        .from = this->scale,
+        .to = to,
+    };
+    ++this->change_count;
+
+    this->scale = to;
+    this->settle_count = RESOLUTION_SETTLE_WINDOWS;
+    this->raise_count = 0;
+}
+
+// adds the time of a frame drawn at the current scale, returns true if the scale changed
+static bool ResolutionGovernor_add(ResolutionGovernor *const this, uint64_t const frame_ns)
+{
+    ++this->frame_count;
+    ++this->frame_counts[this->scale - RESOLUTION_SCALE_MIN];
+    this->over_budget_count += frame_ns > this->budget_ns;
+
+    this->window_ns += frame_ns;
+    if (++this->window_count < RESOLUTION_WINDOW) return false;
+
+    uint64_t const average_ns = this->window_ns / RESOLUTION_WINDOW;
+    this->window_ns = 0;
+    this->window_count = 0;
+
+    if (this->settle_count != 0)
+    {
+        --this->settle_count;
+        return false;
+    }
+
+    if (average_ns * 100 > this->budget_ns * RESOLUTION_HIGH && this->scale > RESOLUTION_SCALE_MIN)
+    {
+        int to = this->scale - 1;
+        while (to > RESOLUTION_SCALE_MIN &&
+               resolution_predict_ns(average_ns, this->scale, to) * 100 > this->budget_ns * RESOLUTION_TARGET)
+        {
+            --to;
+        }
+
+        ResolutionGovernor_change(this, to, average_ns);
+        return true;
+    }
+
+    if (this->scale < RESOLUTION_SCALE_ONE &&
+        resolution_predict_ns(average_ns, this->scale, this->scale + 1) * 100 < this->budget_ns * RESOLUTION_LOW)
+    {
+        if (++this->raise_count < RESOLUTION_RAISE_WINDOWS) return false;
+
+        ResolutionGovernor_change(this, this->scale + 1, average_ns);
+        return true;
+    }
+
+    this->raise_count = 0;
+    return false;
+}
+
+// one line like "frame 1234: scale 16/16 to 13/16 at 9.50 ms\n" into buffer, which needs 128 bytes,
+// returns its length. needs latency.h
+static size_t ResolutionChange_format(ResolutionChange const *const this, char *const buffer)
+{
+    char *out = latency_write_string(buffer, "frame ");
+    out = latency_write_uint(out, this->frame);
+    out = latency_write_string(out, ": scale ");
+    out = latency_write_uint(out, (uint64_t) this->from);
+    out = latency_write_string(out, "/16 to ");
+    out = latency_write_uint(out, (uint64_t) this->to);
+    out = latency_write_string(out, "/16 at ");
+    out = latency_write_ms(out, this->average_ns);
+    out = latency_write_string(out, " ms\n");
+    *out = '\0';
+    return (size_t) (out - buffer);
+}
+
+// one line like "resolution: scale 13/16, 4 changes, 12 of 3000 frames over 12.00 ms\n" into buffer,
+// which needs 128 bytes, returns its length. needs latency.h
+static size_t ResolutionGovernor_format(ResolutionGovernor const *const this, char *const buffer)
+{
+    char *out = latency_write_string(buffer, "resolution: scale ");
+    out = latency_write_uint(out, (uint64_t) this->scale);
+    out = latency_write_string(out, "/16, ");
+    out = latency_write_uint(out, this->change_count);
+    out = latency_write_string(out, " changes, ");
+    out = latency_write_uint(out, this->over_budget_count);
+    out = latency_write_string(out, " of ");
+    out = latency_write_uint(out, this->frame_count);
+    out = latency_write_string(out, " frames over ");
+    out = latency_write_ms(out, this->budget_ns);
+    out = latency_write_string(out, " ms\n");
+    *out = '\0';
+    return (size_t) (out - buffer);
+}
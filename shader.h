@@ -24,6 +24,10 @@ static char const shader_program[] =
     "Texture2D font_texture : register(t0);\n"
     "SamplerState font_sampler : register(s0);\n"
     "\n"
+    "// the static layer under the moving shapes, the middle line and both scores, for every pixel.\n"
+    "// ps_overlay draws it again after a resize or when a score changes\n"
+    "Texture2D<float> overlay_texture : register(t1);\n"
+    "\n"
     "vs_out vs_main(uint vertex_index : SV_VERTEXID)\n"
     "{\n"
     "     vs_out output;\n"
@@ -129,25 +133,15 @@ static char const shader_program[] =
     "    return smoothstep(1.0f - 0.5f, 1.0f, result);\n"
     "}\n"
     "\n"
-    "float4 ps_main(vs_out input) : SV_TARGET\n"
+    "float4 ps_overlay(vs_out input) : SV_TARGET\n"
     "{\n"
     "    const float2 scale_correction = float2(aspect_ratio, 1.0f);\n"
     "    float2 coords = input.texture_coord * scale_correction;\n"
     "\n"
-    "    float ball = circle_sdf(coords, ball_position, ball_radius);\n"
-    "    float player1 = rectangle_sdf(coords, player1_position, player_size / 2.0f);\n"
-    "    float player2 = rectangle_sdf(coords, player2_position, player_size / 2.0f);\n"
     "    float middle_line = abs(coords.x - 0.5f * aspect_ratio) - 0.005f;\n"
     "    float middle_line_pattern = fmod(abs(coords.y) + 0.01f, 0.1f) - 0.025f;\n"
     "    middle_line = max(middle_line, -middle_line_pattern);\n"
     "\n"
-    "    float final_sdf = smin(ball, min(player1, player2), 0.05f);\n"
-    "\n"
-    "    float3 final_color = 0;\n"
-    "    final_color = lerp(final_color, float3(1, 0, 0), smoothstep(player1 - 0.05f, player1, final_sdf));\n"
-    "    final_color = lerp(final_color, float3(0, 1, 0), smoothstep(player2 - 0.05f, player2, final_sdf));\n"
-    "    final_color = lerp(final_color, float3(0, 0, 1), smoothstep(ball - 0.05f, ball, final_sdf));\n"
-    "\n"
     "    float player1_score_log10 = floor(log(player1_score + 1) / log(10.0f));\n"
     "    float player2_score_log10 = floor(log(player2_score + 1) / log(10.0f));\n"
     "    float player1_score_mask = number_text_mask(coords, float2(0.085f, 0.87f), 5.0f, player1_score, player1_score_log10);\n"
@@ -156,7 +150,167 @@ static char const shader_program[] =
     "                                                5.0f, player2_score, player2_score_log10);\n"
     "\n"
     "    float overlay_mask = max(max(player1_score_mask, player2_score_mask), sdf_to_mask(middle_line));\n"
+    "    return float4(overlay_mask, 0.0f, 0.0f, 1.0f);\n"
+    "}\n"
+    "\n"
+    "float4 ps_main(vs_out input) : SV_TARGET\n"
+    "{\n"
+    "    const float2 scale_correction = float2(aspect_ratio, 1.0f);\n"
+    "    float2 coords = input.texture_coord * scale_correction;\n"
+    "\n"
+    "    float ball = circle_sdf(coords, ball_position, ball_radius);\n"
+    "    float player1 = rectangle_sdf(coords, player1_position, player_size / 2.0f);\n"
+    "    float player2 = rectangle_sdf(coords, player2_position, player_size / 2.0f);\n"
+    "\n"
+    "    // see ShaderVariant for when each of these is used\n"
+    "#if SHADER_VARIANT == 3\n"
+    "    float final_sdf = min(ball, min(player1, player2));\n"
+    "    float3 final_color = ball <= min(player1, player2) ? float3(0, 0, 1) :\n"
+    "                         player2 <= player1 ? float3(0, 1, 0) : float3(1, 0, 0);\n"
+    "#else\n"
+    "#if SHADER_VARIANT == 1\n"
+    "    float final_sdf = min(smin(ball, player1, 0.05f), player2);\n"
+    "#elif SHADER_VARIANT == 2\n"
+    "    float final_sdf = min(smin(ball, player2, 0.05f), player1);\n"
+    "#else\n"
+    "    float final_sdf = smin(ball, min(player1, player2), 0.05f);\n"
+    "#endif\n"
+    "\n"
+    "    float3 final_color = 0;\n"
+    "    final_color = lerp(final_color, float3(1, 0, 0), smoothstep(player1 - 0.05f, player1, final_sdf));\n"
+    "    final_color = lerp(final_color, float3(0, 1, 0), smoothstep(player2 - 0.05f, player2, final_sdf));\n"
+    "    final_color = lerp(final_color, float3(0, 0, 1), smoothstep(ball - 0.05f, ball, final_sdf));\n"
+    "#endif\n"
+    "\n"
+    "    // the overlay texture is the size of the frame buffer so every pixel reads its own texel\n"
+    "    float overlay_mask = overlay_texture.Load(int3(input.position.xy, 0));\n"
     "    float final_mask = sdf_to_mask(final_sdf.x);\n"
     "\n"
     "    return float4(lerp(overlay_mask, final_color, final_mask), 1.0f);\n"
+    "}\n"
+    "\n"
+    "// the frame drawn to the top left of scaled_texture at the scale of resolution.h, stretched over the window.\n"
+    "// upscale_uv_max keeps the filter from reading past the part that was drawn to\n"
+    "cbuffer upscale_constants : register (b1)\n"
+    "{\n"
+    "    float2 upscale_uv_scale;\n"
+    "    float2 upscale_uv_max;\n"
+    "}\n"
+    "\n"
+    "Texture2D scaled_texture : register(t2);\n"
+    "SamplerState scaled_sampler : register(s1);\n"
+    "\n"
+    "float4 ps_upscale(vs_out input) : SV_TARGET\n"
+    "{\n"
+    "    float2 uv = float2(input.texture_coord.x, 1.0f - input.texture_coord.y) * upscale_uv_scale;\n"
+    "    return scaled_texture.Sample(scaled_sampler, min(uv, upscale_uv_max));\n"
     "}";
+
+// the constant buffer of shader_program, also what the cpu renderer in render.h draws from
+typedef struct ShaderConstants
+{
+    float2 player_size;
+    float2 player1_position;
+    float2 player2_position;
+    float2 ball_position;
+    
+    float ball_radius;
+    float aspect_ratio;
+    
+    int unsigned player1_score;
+    int unsigned player2_score;
+} ShaderConstants;
+
+// whether a and b draw the same frame, bit for bit so it needs neither the crt nor care for -0 and nan
+static inline bool ShaderConstants_equal(ShaderConstants const *const a, ShaderConstants const *const b)
+{
+    // every field is 4 bytes, so there is no padding to compare
+    uint32_t const *const a_words = (uint32_t const *) a;
+    uint32_t const *const b_words = (uint32_t const *) b;
+    uint32_t difference = 0;
+    for (size_t i = 0; i < sizeof(ShaderConstants) / sizeof(uint32_t); ++i) difference |= a_words[i] ^ b_words[i];
+    return difference == 0;
+}
+
+// the constant buffer of ps_upscale
+typedef struct UpscaleConstants
+{
+    float2 uv_scale;
+    float2 uv_max;
+} UpscaleConstants;
+
+// the permutations of ps_main, compiled with SHADER_VARIANT defined to one of these.
+// they only leave out blending the ball with a paddle that is too far away to blend with it,
+// so whichever one shader_variant picks draws the same picture as SHADER_VARIANT_FULL
+typedef enum ShaderVariant
+{
+    // the ball may blend with both paddles
+    SHADER_VARIANT_FULL,
+
+    // only with one of them, like while a player serves
+    SHADER_VARIANT_PLAYER1,
+    SHADER_VARIANT_PLAYER2,
+
+    // with neither, so there is no smin and the color is that of the closest shape
+    SHADER_VARIANT_APART,
+
+    SHADER_VARIANT_COUNT,
+} ShaderVariant;
+
+// a blend only shows where the mask is not 0, so where smin(a, b) < 0.002. smin is at most 0.05 / 6 below
+// min(a, b), so one of them is below 0.0103, and they blend at all only if |a - b| < 0.05, so both are
+// below 0.0603 and the shapes are closer than 0.1206 to each other
+#define SHADER_BLEND_GAP (0.125f)
+
+// the distance between the edge of the ball and the edge of a paddle
+static inline float shader_ball_gap(ShaderConstants const *const constants, float2 const player_position)
+{
+    float2 const edge_distance = {
+        fmaxf(fabsf(constants->ball_position.x - player_position.x) - constants->player_size.x / 2.0f, 0.0f),
+        fmaxf(fabsf(constants->ball_position.y - player_position.y) - constants->player_size.y / 2.0f, 0.0f),
+    };
+    return flength2(edge_distance) - constants->ball_radius;
+}
+
+// the cheapest permutation that draws constants correctly
+static inline ShaderVariant shader_variant(ShaderConstants const *const constants)
+{
+    bool const is_near_player1 = shader_ball_gap(constants, constants->player1_position) < SHADER_BLEND_GAP;
+    bool const is_near_player2 = shader_ball_gap(constants, constants->player2_position) < SHADER_BLEND_GAP;
+
+    if (is_near_player1 && is_near_player2) return SHADER_VARIANT_FULL;
+    if (is_near_player1) return SHADER_VARIANT_PLAYER1;
+    if (is_near_player2) return SHADER_VARIANT_PLAYER2;
+    return SHADER_VARIANT_APART;
+}
+
+static inline char const *ShaderVariant_name(ShaderVariant const variant)
+{
+    switch (variant)
+    {
+        case SHADER_VARIANT_PLAYER1: return "player1";
+        case SHADER_VARIANT_PLAYER2: return "player2";
+        case SHADER_VARIANT_APART: return "apart";
+        default: return "full";
+    }
+}
+
+// fnv-1a
+#define SHADER_HASH_SEED (0xCBF29CE484222325u)
+#define SHADER_HASH_PRIME (0x100000001B3u)
+
+static inline uint64_t shader_hash(uint64_t hash, void const *const data, size_t const size)
+{
+    uint8_t const *const bytes = data;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * SHADER_HASH_PRIME;
+    }
+    return hash;
+}
+
+// what the bytecode the makefile embeds was compiled from
+static inline uint64_t shader_source_hash(void)
+{
+    return shader_hash(SHADER_HASH_SEED, shader_program, sizeof(shader_program));
+}
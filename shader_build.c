@@ -0,0 +1,54 @@
+// build tool that writes shader_program out for fxc, see the makefile.
+// `shader_build <directory>` writes <directory>/main.hlsl and <directory>/shader_source_hash.h, the hash
+// main.c checks the embedded bytecode against before it uses it
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <intrin.h>
+#include <Windows.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "vec.h"
+#include "shader.h"
+
+static bool write_file(char const *const directory, char const *const name, void const *const data, size_t const size)
+{
+    char path[4096];
+    if (snprintf(path, sizeof(path), "%s/%s", directory, name) >= (int) sizeof(path)) return false;
+
+    FILE *const file = fopen(path, "wb");
+    if (file == NULL) return false;
+
+    bool const is_written = fwrite(data, 1, size, file) == size;
+    return fclose(file) == 0 && is_written;
+}
+
+int main(int const argc, char **const argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: shader_build <directory>\n");
+        return 1;
+    }
+
+    char hash_header[256];
+    int const hash_header_size = snprintf(hash_header, sizeof(hash_header),
+                                          "// written by shader_build, the hash of the shader_program the bytecode\n"
+                                          "// in this directory was compiled from\n"
+                                          "#define SHADER_BYTECODE_SOURCE_HASH (0x%016llXu)\n",
+                                          (unsigned long long) shader_source_hash());
+
+    // without the terminator, fxc reads it as a file
+    if (!write_file(argv[1], "main.hlsl", shader_program, sizeof(shader_program) - 1) ||
+        !write_file(argv[1], "shader_source_hash.h", hash_header, (size_t) hash_header_size))
+    {
+        fprintf(stderr, "shader_build: could not write to %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
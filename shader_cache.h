@@ -0,0 +1,200 @@
+#pragma once
+
+// compiled shaders on disk, for builds that could not embed the bytecode of the makefile or whose
+// shader_program changed since. every entry point and variant has its own file named after a hash of the
+// source, the entry point, the target, the variant and the compile flags, so editing shader.h never reads
+// stale bytecode, and a checksum of the bytecode catches files that were cut short or damaged.
+// the hashing needs neither the crt nor the os, the files go through kernel32 on windows and stdio elsewhere
+// needs shader.h
+
+#ifndef _WIN32
+#include <stdio.h>
+#include <sys/stat.h>
+#endif
+
+#define SHADER_CACHE_MAGIC (0x43534350u)
+
+// bigger than any of the shaders in shader_program by far
+#define SHADER_CACHE_MAX_SIZE (0x10000u)
+
+// the directory, 16 hex digits, ".cso" or ".tmp" and the terminator
+#define SHADER_CACHE_MAX_PATH (260)
+
+typedef struct ShaderCacheHeader
+{
+    uint32_t magic;
+    uint32_t size;
+    uint64_t key;
+    uint64_t checksum;
+} ShaderCacheHeader;
+
+// a file as it is on disk, the header and one byte more than fits, to tell a file that is too big
+// from one that just fits
+typedef struct ShaderCacheFile
+{
+    ShaderCacheHeader header;
+    uint8_t data[SHADER_CACHE_MAX_SIZE + 1];
+} ShaderCacheFile;
+
+static uint64_t shader_hash_string(uint64_t const hash, char const *const string)
+{
+    size_t length = 0;
+    while (string[length] != '\0') ++length;
+
+    // with the terminator so "ab" "c" and "a" "bc" hash differently
+    return shader_hash(hash, string, length + 1);
+}
+
+// names the bytecode of entry for target, compiled with SHADER_VARIANT defined to variant unless it is
+// negative and with the flags of D3DCompile
+static uint64_t shader_key(uint64_t const source_hash, char const *const entry, char const *const target,
+                           int const variant, uint32_t const flags)
+{
+    uint64_t hash = shader_hash(SHADER_HASH_SEED, &source_hash, sizeof(source_hash));
+    hash = shader_hash_string(hash, entry);
+    hash = shader_hash_string(hash, target);
+    hash = shader_hash(hash, &variant, sizeof(variant));
+    return shader_hash(hash, &flags, sizeof(flags));
+}
+
+// writes directory, which ends in a path separator, the key in hex and extension to path.
+// returns false if that does not fit
+static bool shader_cache_path(char *const path, char const *const directory, uint64_t const key,
+                              char const *const extension)
+{
+    size_t length = 0;
+    while (directory[length] != '\0')
+    {
+        if (length >= SHADER_CACHE_MAX_PATH - 16 - 5) return false;
+        path[length] = directory[length];
+        ++length;
+    }
+
+    for (int shift = 60; shift >= 0; shift -= 4)
+    {
+        path[length++] = "0123456789abcdef"[key >> shift & 0xF];
+    }
+    for (int i = 0; i < 5; ++i)
+    {
+        path[length++] = extension[i];
+    }
+    return true;
+}
+
+#ifdef _WIN32
+static bool shader_cache_read_file(char const *const path, void *const data, size_t const capacity, size_t *const size)
+{
+    HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                    FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    DWORD read_size = 0;
+    BOOL const is_read = ReadFile(file, data, (DWORD) capacity, &read_size, NULL);
+    CloseHandle(file);
+    *size = read_size;
+    return is_read;
+}
+
+// replaces path with a file written next to it, so a reader never sees a file that is half written
+static bool shader_cache_write_file(char const *const path, char const *const temporary_path,
+                                    char const *const directory, void const *const data, size_t const size)
+{
+    CreateDirectoryA(directory, NULL);
+
+    HANDLE const file = CreateFileA(temporary_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    DWORD written_size = 0;
+    BOOL const is_written = WriteFile(file, data, (DWORD) size, &written_size, NULL) && written_size == size;
+    CloseHandle(file);
+
+    if (!is_written)
+    {
+        DeleteFileA(temporary_path);
+        return false;
+    }
+    return MoveFileExA(temporary_path, path, MOVEFILE_REPLACE_EXISTING);
+}
+#else
+static bool shader_cache_read_file(char const *const path, void *const data, size_t const capacity, size_t *const size)
+{
+    FILE *const file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    *size = fread(data, 1, capacity, file);
+    bool const is_read = !ferror(file);
+    fclose(file);
+    return is_read;
+}
+
+static bool shader_cache_write_file(char const *const path, char const *const temporary_path,
+                                    char const *const directory, void const *const data, size_t const size)
+{
+    mkdir(directory, 0755);
+
+    FILE *const file = fopen(temporary_path, "wb");
+    if (file == NULL) return false;
+
+    bool const is_written = fwrite(data, 1, size, file) == size;
+    if (fclose(file) != 0 || !is_written)
+    {
+        remove(temporary_path);
+        return false;
+    }
+    return rename(temporary_path, path) == 0;
+}
+#endif
+
+// reads the bytecode of key from directory into bytecode, which holds SHADER_CACHE_MAX_SIZE bytes.
+// returns its size, or 0 if it is not there or the file is damaged
+static size_t shader_cache_load(char const *const directory, uint64_t const key, void *const bytecode)
+{
+    char path[SHADER_CACHE_MAX_PATH];
+    if (!shader_cache_path(path, directory, key, ".cso")) return 0;
+
+    static ShaderCacheFile file;
+    size_t size;
+    if (!shader_cache_read_file(path, &file, sizeof(ShaderCacheHeader) + sizeof(file.data), &size) ||
+        size < sizeof(ShaderCacheHeader))
+    {
+        return 0;
+    }
+
+    ShaderCacheHeader const *const header = &file.header;
+    if (header->magic != SHADER_CACHE_MAGIC || header->key != key || header->size == 0 ||
+        header->size != size - sizeof(ShaderCacheHeader) ||
+        header->checksum != shader_hash(SHADER_HASH_SEED, file.data, header->size))
+    {
+        return 0;
+    }
+
+    uint8_t *const out = bytecode;
+    for (size_t i = 0; i < header->size; ++i) out[i] = file.data[i];
+    return header->size;
+}
+
+// writes bytecode for the next shader_cache_load of key, creating directory if it is not there
+static bool shader_cache_store(char const *const directory, uint64_t const key,
+                               void const *const bytecode, size_t const size)
+{
+    if (size == 0 || size > SHADER_CACHE_MAX_SIZE) return false;
+
+    char path[SHADER_CACHE_MAX_PATH];
+    char temporary_path[SHADER_CACHE_MAX_PATH];
+    if (!shader_cache_path(path, directory, key, ".cso") ||
+        !shader_cache_path(temporary_path, directory, key, ".tmp"))
+    {
+        return false;
+    }
+
+    static ShaderCacheFile file;
+    file.header.magic = SHADER_CACHE_MAGIC;
+    file.header.size = (uint32_t) size;
+    file.header.key = key;
+    file.header.checksum = shader_hash(SHADER_HASH_SEED, bytecode, size);
+
+    uint8_t const *const in = bytecode;
+    for (size_t i = 0; i < size; ++i) file.data[i] = in[i];
+
+    return shader_cache_write_file(path, temporary_path, directory, &file, sizeof(ShaderCacheHeader) + size);
+}
@@ -0,0 +1,300 @@
+#pragma once
+
+// runs the game on its own thread at a fixed rate and hands snapshots to the renderer through a
+// TripleBuffer, so input reaches the game at the simulation rate instead of the display rate and a
+// slow present never stalls the game. the window thread only talks to it through the input ring and
+// the atomics below.
+// needs game.h, timing.h, thread.h, fixed_step.h, triple_buffer.h and input.h
+
+#define SIMULATION_HZ (1000)
+
+// the thread sleeps until this long before the next step and then yields until it is due,
+// sleeps are not precise enough to hit a 1 ms step on their own
+#define SIMULATION_SPIN_NS (250000u)
+
+// in the background the thread wakes up this often and runs the steps that came due in one go,
+// nobody watches closely enough to see steps that are late by this much
+#define SIMULATION_BACKGROUND_NS (8000000u)
+
+// while paused the thread waits for input, and looks again after this long in case a wake up was missed
+#define SIMULATION_PAUSED_WAIT_NS (250000000u)
+
+// how the thread waits between steps, the window thread picks one with Simulation_set_pacing
+typedef enum SimulationPacing
+{
+    // sleeps and then yields until each step, and waits for input while paused
+    SIMULATION_PACING_FOREGROUND,
+
+    // sleeps SIMULATION_BACKGROUND_NS at a time, and waits for input while paused
+    SIMULATION_PACING_BACKGROUND,
+
+    // like SIMULATION_PACING_FOREGROUND even while paused, to compare
+    SIMULATION_PACING_SPIN,
+
+    // while minimized nobody sees the game, so it does not step at all and the thread waits until the pacing
+    // changes. input waits in the ring until then
+    SIMULATION_PACING_PARKED,
+} SimulationPacing;
+
+typedef struct Simulation
+{
+    // only the simulation thread touches these once Simulation_start returned
+    Game game;
+    FixedStep clock;
+
+    // how many mouse moves the simulation popped, snapshots carry it as their input_count
+    uint32_t mouse_count_seen;
+
+    // the longest time a step ran after it was due
+    uint64_t max_late_ns;
+
+    TripleBuffer snapshots;
+
+    // the window thread pushes key and mouse events, the simulation thread pops them before each step
+    Input input;
+
+    _Alignas(64) _Atomic uint32_t aspect_ratio;
+    _Atomic bool is_paused;
+    _Atomic bool is_running;
+    _Atomic uint32_t pacing;
+
+    // set while the thread waits for input, see Simulation_wake
+    _Atomic bool is_parked;
+    ThreadEvent wake_event;
+    uint64_t park_count;
+
+    Thread thread;
+} Simulation;
+
+static inline void Simulation_set_aspect_ratio(Simulation *const this, float const aspect_ratio)
+{
+    atomic_store_explicit(&this->aspect_ratio, fbits(aspect_ratio), memory_order_relaxed);
+}
+
+static inline bool Simulation_is_paused(Simulation *const this)
+{
+    return atomic_load_explicit(&this->is_paused, memory_order_relaxed);
+}
+
+// wakes the thread up if it waits for input while paused, the producer calls it after pushing input
+static inline void Simulation_wake(Simulation *const this)
+{
+    // pairs with the fence in Simulation_park, either the thread sees the input or the pacing or this sees
+    // it parked
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&this->is_parked, memory_order_relaxed)) ThreadEvent_signal(&this->wake_event);
+}
+
+static inline void Simulation_set_pacing(Simulation *const this, SimulationPacing const pacing)
+{
+    // a thread that parked for the old pacing may have to run now
+    if (atomic_exchange_explicit(&this->pacing, (uint32_t) pacing, memory_order_relaxed) != (uint32_t) pacing)
+    {
+        Simulation_wake(this);
+    }
+}
+
+// whether the thread has nothing to do until the window thread wakes it up
+static inline bool Simulation_should_park(Simulation *const this, SimulationPacing const pacing)
+{
+    if (pacing == SIMULATION_PACING_PARKED) return true;
+    return pacing != SIMULATION_PACING_SPIN && Simulation_is_paused(this) && Input_depth(&this->input) == 0;
+}
+
+// waits until Simulation_wake or SIMULATION_PAUSED_WAIT_NS unless there is something to do already
+static void Simulation_park(Simulation *const this)
+{
+    atomic_store_explicit(&this->is_parked, true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (Simulation_should_park(this, atomic_load_explicit(&this->pacing, memory_order_relaxed)))
+    {
+        ThreadEvent_wait_ns(&this->wake_event, SIMULATION_PAUSED_WAIT_NS);
+        ++this->park_count;
+    }
+    atomic_store_explicit(&this->is_parked, false, memory_order_relaxed);
+}
+
+// applies the events that arrived by until_ns in the order they arrived, the ones after it are left
+// for a later step so steps that run late to catch up still see input at the step it arrived in
+static void Simulation_consume_input(Simulation *const this, uint64_t const until_ns)
+{
+    Input *const input = &this->input;
+    Game *const game = &this->game;
+
+    uint32_t const depth = Input_depth(input);
+    input->max_depth = depth > input->max_depth ? depth : input->max_depth;
+    input->depth_total += depth;
+    ++input->consume_count;
+
+    uint64_t const now = time_now_ns();
+    InputEvent const *event;
+    while ((event = Input_peek(input)) != NULL && event->time_ns <= until_ns)
+    {
+        LatencyStats_add(&input->queue_latency, now > event->time_ns ? now - event->time_ns : 0);
+
+        switch (event->type)
+        {
+            case INPUT_EVENT_KEY_DOWN:
+            case INPUT_EVENT_KEY_UP:
+            {
+                bool const is_down = event->type == INPUT_EVENT_KEY_DOWN;
+                if (is_down && event->key == KEY_PAUSE)
+                {
+                    atomic_store_explicit(&this->is_paused, !Simulation_is_paused(this), memory_order_relaxed);
+                }
+
+                if (event->key >= 0 && event->key < KEY_BITMAP_BIT_SIZE * 4)
+                {
+                    KeyBitmap_change(&game->keys, event->key, is_down);
+                }
+
+                break;
+            }
+
+            case INPUT_EVENT_MOUSE_MOVE:
+            {
+                // the mouse does not move the paddle while paused
+                if (!Simulation_is_paused(this))
+                {
+                    game->player1.pos.y = fclamp(event->mouse_height, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+                }
+
+                ++this->mouse_count_seen;
+                break;
+            }
+        }
+
+        Input_pop(input);
+    }
+}
+
+// the step that was due at due_ns
+static void Simulation_step(Simulation *const this, uint64_t const due_ns)
+{
+    Game *const game = &this->game;
+    game->aspect_ratio = ffrom_bits(atomic_load_explicit(&this->aspect_ratio, memory_order_relaxed));
+
+    Simulation_consume_input(this, due_ns);
+
+    if (Simulation_is_paused(this)) return;
+
+    Game_update_swept(game, this->clock.dt);
+}
+
+static void Simulation_publish(Simulation *const this)
+{
+    GameSnapshot *const snapshot = TripleBuffer_back(&this->snapshots);
+    *snapshot = Game_snapshot(&this->game);
+    snapshot->step = this->clock.step_count;
+    snapshot->input_count = this->mouse_count_seen;
+    TripleBuffer_publish(&this->snapshots);
+}
+
+// late latching: moves player1 in snapshot to the newest mouse height when the simulation has not
+// stepped with it yet, so the paddle under the mouse is drawn from input that arrived after the
+// snapshot was made. returns the input_count of what is drawn now
+static inline uint32_t Simulation_latch_mouse(Simulation *const this, GameSnapshot *const snapshot)
+{
+    uint32_t const mouse_count = atomic_load_explicit(&this->input.mouse_count, memory_order_acquire);
+    if (mouse_count == snapshot->input_count || Simulation_is_paused(this)) return snapshot->input_count;
+
+    float const height = ffrom_bits(atomic_load_explicit(&this->input.mouse_height, memory_order_relaxed));
+    snapshot->player1_position.y = fclamp(height, PLAYER_SIZE.y / 2.0f, 1.0f - PLAYER_SIZE.y / 2.0f);
+    snapshot->input_count = mouse_count;
+    return mouse_count;
+}
+
+static void Simulation_run(void *const argument)
+{
+    Simulation *const this = argument;
+
+    // the thread sleeps up to a thousand times a second
+    ThreadTimer timer;
+    ThreadTimer_init(&timer);
+
+    uint64_t time_last = time_now_ns();
+    while (atomic_load_explicit(&this->is_running, memory_order_relaxed))
+    {
+        uint64_t const time_now = time_now_ns();
+        uint32_t const step_count = FixedStep_advance(&this->clock, time_now - time_last);
+        time_last = time_now;
+
+        if (step_count != 0)
+        {
+            // the last step was due accumulator_ns ago
+            this->max_late_ns = this->clock.accumulator_ns > this->max_late_ns ?
+                this->clock.accumulator_ns : this->max_late_ns;
+
+            // the ones before the last step were due a step apart
+            uint64_t const last_due_ns = time_now - this->clock.accumulator_ns;
+            for (uint32_t i = 0; i < step_count; ++i)
+            {
+                Simulation_step(this, last_due_ns - (uint64_t) (step_count - 1 - i) * this->clock.step_ns);
+            }
+
+            Simulation_publish(this);
+        }
+
+        SimulationPacing const pacing = atomic_load_explicit(&this->pacing, memory_order_relaxed);
+        if (pacing == SIMULATION_PACING_PARKED || (pacing != SIMULATION_PACING_SPIN && Simulation_is_paused(this)))
+        {
+            // a paused game only changes with input and a minimized one not at all. the time spent waiting is
+            // not simulated, the step after it is due right away for the input or the pacing that woke the
+            // thread up, and not at all when it only looked again after SIMULATION_PAUSED_WAIT_NS
+            Simulation_park(this);
+            time_last = time_now_ns();
+            bool const is_woken = !Simulation_should_park(this, atomic_load_explicit(&this->pacing, memory_order_relaxed));
+            this->clock.accumulator_ns = is_woken ? this->clock.step_ns : 0;
+            continue;
+        }
+
+        uint64_t const wait_ns = this->clock.step_ns - this->clock.accumulator_ns;
+        if (pacing == SIMULATION_PACING_BACKGROUND)
+        {
+            ThreadTimer_sleep_ns(&timer, wait_ns + SIMULATION_BACKGROUND_NS - this->clock.step_ns);
+        }
+        else if (wait_ns > SIMULATION_SPIN_NS)
+        {
+            ThreadTimer_sleep_ns(&timer, wait_ns - SIMULATION_SPIN_NS);
+        }
+        else
+        {
+            thread_yield();
+        }
+    }
+
+    ThreadTimer_free(&timer);
+}
+
+// game has to be set up already, the simulation thread owns it from here on
+static bool Simulation_start(Simulation *const this, uint32_t const hz)
+{
+    FixedStep_init(&this->clock, hz);
+    this->max_late_ns = 0;
+    this->mouse_count_seen = 0;
+
+    atomic_store_explicit(&this->aspect_ratio, fbits(this->game.aspect_ratio), memory_order_relaxed);
+    atomic_store_explicit(&this->is_paused, false, memory_order_relaxed);
+    atomic_store_explicit(&this->is_running, true, memory_order_relaxed);
+    atomic_store_explicit(&this->is_parked, false, memory_order_relaxed);
+    this->park_count = 0;
+    if (!ThreadEvent_init(&this->wake_event)) return false;
+
+    GameSnapshot const initial = Game_snapshot(&this->game);
+    TripleBuffer_init(&this->snapshots, &initial);
+
+    if (!Thread_create(&this->thread, &Simulation_run, this))
+    {
+        ThreadEvent_free(&this->wake_event);
+        return false;
+    }
+    return true;
+}
+
+static void Simulation_stop(Simulation *const this)
+{
+    atomic_store_explicit(&this->is_running, false, memory_order_relaxed);
+    ThreadEvent_signal(&this->wake_event);
+    Thread_join(&this->thread);
+    ThreadEvent_free(&this->wake_event);
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+// just enough of a thread api for the headless tools, on windows it only needs kernel32
+
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+typedef void (*ThreadFunction)(void *argument);
+
+typedef struct Thread
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFunction function;
+    void *argument;
+} Thread;
+
+#ifdef _WIN32
+static DWORD __stdcall Thread_entry(void *const argument)
+{
+    Thread *const this = argument;
+    this->function(this->argument);
+    return 0;
+}
+#else
+static void *Thread_entry(void *const argument)
+{
+    Thread *const this = argument;
+    this->function(this->argument);
+    return NULL;
+}
+#endif
+
+// the thread keeps a pointer to this so it must stay alive until Thread_join
+static bool Thread_create(Thread *const this, ThreadFunction const function, void *const argument)
+{
+    this->function = function;
+    this->argument = argument;
+
+#ifdef _WIN32
+    this->handle = CreateThread(NULL, 0, &Thread_entry, this, 0, NULL);
+    return this->handle != NULL;
+#else
+    return pthread_create(&this->handle, NULL, &Thread_entry, this) == 0;
+#endif
+}
+
+static void Thread_join(Thread *const this)
+{
+#ifdef _WIN32
+    WaitForSingleObject(this->handle, INFINITE);
+    CloseHandle(this->handle);
+#else
+    pthread_join(this->handle, NULL);
+#endif
+}
+
+static inline void thread_yield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+static inline void thread_pause(void)
+{
+    _mm_pause();
+}
+
+static inline int thread_hardware_count(void)
+{
+#ifdef _WIN32
+    return (int) GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+#else
+    long const count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (int) count : 1;
+#endif
+}
+
+#ifdef _WIN32
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION (0x00000002)
+#endif
+#endif
+
+// what a thread sleeps on. Sleep only has the resolution of the system timer (15.6 ms by default),
+// a high resolution waitable timer gets close to the requested time without timeBeginPeriod. creating one
+// costs a couple of system calls, so a thread that sleeps often creates it once and keeps it
+typedef struct ThreadTimer
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    // nanosleep needs nothing
+    int unused;
+#endif
+} ThreadTimer;
+
+static void ThreadTimer_init(ThreadTimer *const this)
+{
+#ifdef _WIN32
+    this->handle = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#else
+    this->unused = 0;
+#endif
+}
+
+static void ThreadTimer_free(ThreadTimer *const this)
+{
+#ifdef _WIN32
+    if (this->handle != NULL) CloseHandle(this->handle);
+    this->handle = NULL;
+#else
+    (void) this;
+#endif
+}
+
+// sleeps for about ns, the os may wake the thread a little later. only the thread that owns the timer
+// may sleep on it
+static void ThreadTimer_sleep_ns(ThreadTimer *const this, uint64_t const ns)
+{
+#ifdef _WIN32
+    if (this->handle == NULL)
+    {
+        Sleep((DWORD) (ns / 1000000u));
+        return;
+    }
+
+    // negative means relative, in 100 ns units
+    LARGE_INTEGER const due = {.QuadPart = -(LONGLONG) (ns / 100u)};
+    SetWaitableTimer(this->handle, &due, 0, NULL, NULL, FALSE);
+    WaitForSingleObject(this->handle, INFINITE);
+#else
+    (void) this;
+    struct timespec const time = {
+        .tv_sec = (time_t) (ns / 1000000000u),
+        .tv_nsec = (long) (ns % 1000000000u),
+    };
+    nanosleep(&time, NULL);
+#endif
+}
+
+// sleeps for about ns on a timer of its own, for threads that only sleep now and then
+static void thread_sleep_ns(uint64_t const ns)
+{
+    ThreadTimer timer;
+    ThreadTimer_init(&timer);
+    ThreadTimer_sleep_ns(&timer, ns);
+    ThreadTimer_free(&timer);
+}
+
+// an auto reset event, one thread waits on it and others wake it up
+typedef struct ThreadEvent
+{
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    pthread_mutex_t mutex;
+    pthread_cond_t condition;
+    bool is_signaled;
+#endif
+} ThreadEvent;
+
+static bool ThreadEvent_init(ThreadEvent *const this)
+{
+#ifdef _WIN32
+    this->handle = CreateEventW(NULL, FALSE, FALSE, NULL);
+    return this->handle != NULL;
+#else
+    this->is_signaled = false;
+    if (pthread_mutex_init(&this->mutex, NULL) != 0) return false;
+    if (pthread_cond_init(&this->condition, NULL) != 0)
+    {
+        pthread_mutex_destroy(&this->mutex);
+        return false;
+    }
+    return true;
+#endif
+}
+
+static void ThreadEvent_free(ThreadEvent *const this)
+{
+#ifdef _WIN32
+    CloseHandle(this->handle);
+#else
+    pthread_cond_destroy(&this->condition);
+    pthread_mutex_destroy(&this->mutex);
+#endif
+}
+
+static void ThreadEvent_signal(ThreadEvent *const this)
+{
+#ifdef _WIN32
+    SetEvent(this->handle);
+#else
+    pthread_mutex_lock(&this->mutex);
+    this->is_signaled = true;
+    pthread_cond_signal(&this->condition);
+    pthread_mutex_unlock(&this->mutex);
+#endif
+}
+
+// waits until the event is signaled or about timeout_ns passed, returns true if it was signaled
+static bool ThreadEvent_wait_ns(ThreadEvent *const this, uint64_t const timeout_ns)
+{
+#ifdef _WIN32
+    return WaitForSingleObject(this->handle, (DWORD) (timeout_ns / 1000000u)) == WAIT_OBJECT_0;
+#else
+    // pthread_cond_timedwait takes a point in realtime
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    uint64_t const nanoseconds = (uint64_t) deadline.tv_nsec + timeout_ns % 1000000000u;
+    deadline.tv_sec += (time_t) (timeout_ns / 1000000000u + nanoseconds / 1000000000u);
+    deadline.tv_nsec = (long) (nanoseconds % 1000000000u);
+
+    pthread_mutex_lock(&this->mutex);
+    while (!this->is_signaled)
+    {
+        if (pthread_cond_timedwait(&this->condition, &this->mutex, &deadline) != 0) break;
+    }
+    bool const is_signaled = this->is_signaled;
+    this->is_signaled = false;
+    pthread_mutex_unlock(&this->mutex);
+    return is_signaled;
+#endif
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+// monotonic time in nanoseconds.
+// the os clock (QueryPerformanceCounter or CLOCK_MONOTONIC) is the reference. when the cpu has an
+// invariant tsc, time_init calibrates it against the os clock and time_now_ns reads the tsc instead,
+// which costs a few nanoseconds instead of a system call or a trip through the os clock code.
+// time_calibrate measures the tsc frequency again over everything since time_init and slews the
+// clock back onto the os clock, so it does not drift over a long session.
+
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <cpuid.h>
+#endif
+
+// how long time_init spins to measure the tsc frequency
+#define TIME_CALIBRATION_NS (10000000u)
+
+// time_calibrate does not move the clock back onto the os clock at once, it spreads the correction
+// over this much time so the clock does not jump. a thread that reads the clock right as it switches
+// calibrations may still see it a few ns behind a read of another thread
+#define TIME_SLEW_NS (1000000000u)
+
+#ifdef _WIN32
+static inline uint64_t time_os_ns(void)
+{
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+
+    // split the conversion so it does not overflow
+    uint64_t const seconds = (uint64_t) counter.QuadPart / (uint64_t) frequency.QuadPart;
+    uint64_t const remainder = (uint64_t) counter.QuadPart % (uint64_t) frequency.QuadPart;
+    return seconds * 1000000000u + remainder * 1000000000u / (uint64_t) frequency.QuadPart;
+}
+#else
+static inline uint64_t time_os_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t) time.tv_sec * 1000000000u + (uint64_t) time.tv_nsec;
+}
+#endif
+
+// see https://www.felixcloutier.com/x86/cpuid, leaf 0x80000007 edx bit 8
+static inline bool time_has_invariant_tsc(void)
+{
+#ifdef _WIN32
+    int registers[4];
+    __cpuid(registers, 0x80000000);
+    if ((uint32_t) registers[0] < 0x80000007u) return false;
+
+    __cpuid(registers, 0x80000007);
+    return ((uint32_t) registers[3] & (1u << 8)) != 0;
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx) == 0) return false;
+    return (edx & (1u << 8)) != 0;
+#endif
+}
+
+// the tsc reading at which the clock read ns, and how many ns a tick is worth from there. the first
+// slew_ticks run at the slewed rate and the ones after at the plain one, so a correction ends after
+// TIME_SLEW_NS even if no calibration follows
+typedef struct TimeCalibration
+{
+    uint64_t tsc;
+    uint64_t ns;
+    double ns_per_tick;
+
+    uint64_t slew_ticks;
+    uint64_t slew_end_ns;
+    double plain_ns_per_tick;
+} TimeCalibration;
+
+typedef struct TimeClock
+{
+    // time_calibrate fills the slot that is not current and then switches to it,
+    // so other threads reading the clock never see half of a calibration
+    TimeCalibration calibrations[2];
+    _Atomic uint32_t current;
+
+    bool is_tsc;
+
+    // the first measurement, later calibrations measure the frequency from here
+    uint64_t start_tsc;
+    uint64_t start_os_ns;
+
+    // ticks per second of the last calibration
+    double tsc_frequency;
+} TimeClock;
+
+static TimeClock time_clock;
+
+// what the clock of calibration reads at tsc. a tsc read before the calibration, by a thread that raced it, reads
+// as the calibration itself rather than wrapping around
+static inline uint64_t TimeCalibration_ns(TimeCalibration const *const this, uint64_t const tsc)
+{
+    if ((int64_t) (tsc - this->tsc) < 0) return this->ns;
+
+    uint64_t const ticks = tsc - this->tsc;
+    if (ticks <= this->slew_ticks) return this->ns + (uint64_t) ((double) ticks * this->ns_per_tick);
+    return this->slew_end_ns + (uint64_t) ((double) (ticks - this->slew_ticks) * this->plain_ns_per_tick);
+}
+
+static inline uint64_t time_now_ns(void)
+{
+    if (!time_clock.is_tsc) return time_os_ns();
+
+    TimeCalibration const *const calibration =
+        &time_clock.calibrations[atomic_load_explicit(&time_clock.current, memory_order_acquire)];
+    return TimeCalibration_ns(calibration, __rdtsc());
+}
+
+// both clocks read as close together as possible, the os clock read is the middle of the two tsc reads
+static inline void time_sample(uint64_t *const tsc, uint64_t *const os_ns)
+{
+    uint64_t best_window = UINT64_MAX;
+    *tsc = 0;
+    *os_ns = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        uint64_t const before = __rdtsc();
+        uint64_t const ns = time_os_ns();
+        uint64_t const after = __rdtsc();
+
+        if (after - before < best_window)
+        {
+            best_window = after - before;
+            *tsc = before + (after - before) / 2;
+            *os_ns = ns;
+        }
+    }
+}
+
+// calibrates the tsc against the os clock, without an invariant tsc time_now_ns stays on the os clock
+static void time_init(void)
+{
+    if (!time_has_invariant_tsc()) return;
+
+    uint64_t start_tsc;
+    uint64_t start_os_ns;
+    time_sample(&start_tsc, &start_os_ns);
+
+    uint64_t end_tsc;
+    uint64_t end_os_ns;
+    do
+    {
+        time_sample(&end_tsc, &end_os_ns);
+    } while (end_os_ns - start_os_ns < TIME_CALIBRATION_NS);
+
+    time_clock.start_tsc = start_tsc;
+    time_clock.start_os_ns = start_os_ns;
+    time_clock.tsc_frequency = (double) (end_tsc - start_tsc) * 1e9 / (double) (end_os_ns - start_os_ns);
+    time_clock.calibrations[0] = (TimeCalibration) {
+        .tsc = end_tsc,
+        .ns = end_os_ns,
+        .ns_per_tick = 1e9 / time_clock.tsc_frequency,
+        .slew_end_ns = end_os_ns,
+        .plain_ns_per_tick = 1e9 / time_clock.tsc_frequency,
+    };
+    atomic_store_explicit(&time_clock.current, 0, memory_order_release);
+    time_clock.is_tsc = true;
+}
+
+// measures the tsc frequency again over the whole time since time_init and slews time_now_ns onto
+// the os clock over the next TIME_SLEW_NS, returns how far the clock was off in ns.
+// only one thread may call this, every thread may keep reading the clock
+static int64_t time_calibrate(void)
+{
+    if (!time_clock.is_tsc) return 0;
+
+    uint64_t tsc;
+    uint64_t os_ns;
+    time_sample(&tsc, &os_ns);
+
+    uint32_t const current = atomic_load_explicit(&time_clock.current, memory_order_relaxed);
+    uint64_t const clock_ns = TimeCalibration_ns(&time_clock.calibrations[current], tsc);
+    int64_t const error_ns = (int64_t) (os_ns - clock_ns);
+
+    time_clock.tsc_frequency = (double) (tsc - time_clock.start_tsc) * 1e9 / (double) (os_ns - time_clock.start_os_ns);
+
+    // run slightly fast or slow until the error is gone, never by more than half
+    double slew = (double) error_ns / (double) TIME_SLEW_NS;
+    slew = slew > 0.5 ? 0.5 : slew < -0.5 ? -0.5 : slew;
+
+    double const plain_ns_per_tick = 1e9 / time_clock.tsc_frequency;
+    double const ns_per_tick = plain_ns_per_tick * (1.0 + slew);
+    uint64_t const slew_ticks = (uint64_t) ((double) TIME_SLEW_NS / plain_ns_per_tick);
+    time_clock.calibrations[current ^ 1] = (TimeCalibration) {
+        .tsc = tsc,
+        .ns = clock_ns,
+        .ns_per_tick = ns_per_tick,
+        .slew_ticks = slew_ticks,
+        .slew_end_ns = clock_ns + (uint64_t) ((double) slew_ticks * ns_per_tick),
+        .plain_ns_per_tick = plain_ns_per_tick,
+    };
+    atomic_store_explicit(&time_clock.current, current ^ 1, memory_order_release);
+
+    return error_ns;
+}
+
+// how often FrameClock calibrates the clock again
+#define FRAME_CLOCK_CALIBRATE_NS (1000000000u)
+
+// the time between frames, read once per frame so no time is lost between reading and storing it
+typedef struct FrameClock
+{
+    uint64_t last_ns;
+    uint64_t next_calibration_ns;
+} FrameClock;
+
+static inline void FrameClock_init(FrameClock *const this)
+{
+    this->last_ns = time_now_ns();
+    this->next_calibration_ns = this->last_ns + FRAME_CLOCK_CALIBRATE_NS;
+}
+
+static inline uint64_t FrameClock_delta_ns(FrameClock *const this)
+{
+    uint64_t const now = time_now_ns();
+    uint64_t const delta = now - this->last_ns;
+    this->last_ns = now;
+
+    if (now >= this->next_calibration_ns)
+    {
+        time_calibrate();
+        this->next_calibration_ns = now + FRAME_CLOCK_CALIBRATE_NS;
+    }
+
+    return delta;
+}
@@ -0,0 +1,308 @@
+#pragma once
+
+// runs a list of ai vs ai matches (see Game_setup_match) on a work stealing thread pool.
+// every worker starts with a contiguous range of matches, takes from the front of its own range
+// and steals the back half of another worker's range once it runs dry.
+// finished matches are appended to a completion log that the calling thread reads while the
+// workers are running, so nothing in here takes a lock.
+
+#define TOURNAMENT_MAX_THREADS (256)
+
+// how many ticks a match runs between checks of the time limit
+#define TOURNAMENT_CHECK_TICKS (4096)
+
+#define TOURNAMENT_NOT_FINISHED (SIZE_MAX)
+
+typedef struct MatchConfig
+{
+    uint32_t seed;
+    float player1_ai_gain;
+    float player2_ai_gain;
+    float aspect_ratio;
+    float dt;
+    uint64_t tick_limit;
+
+    // the match ends once either player has this many points, 0 means no limit
+    int unsigned score_limit;
+} MatchConfig;
+
+typedef enum MatchStatus
+{
+    MATCH_FINISHED,
+    MATCH_TIMED_OUT,
+    MATCH_SKIPPED,
+} MatchStatus;
+
+typedef struct MatchResult
+{
+    int unsigned player1_score;
+    int unsigned player2_score;
+    uint64_t tick_count;
+    uint64_t time_ns;
+    int worker;
+    MatchStatus status;
+} MatchResult;
+
+struct Tournament;
+
+typedef struct TournamentWorker
+{
+    // begin << 32 | end of the matches this worker still owns
+    _Alignas(64) _Atomic uint64_t range;
+
+    struct Tournament *tournament;
+    Thread thread;
+    int index;
+    uint32_t random;
+
+    uint64_t busy_ns;
+    uint64_t match_count;
+    uint64_t tick_count;
+    uint64_t steal_count;
+} TournamentWorker;
+
+typedef struct Tournament
+{
+    MatchConfig const *configs;
+    MatchResult *results;
+    size_t match_count;
+
+    // indices of finished matches in the order they finished,
+    // every entry starts out as TOURNAMENT_NOT_FINISHED
+    _Atomic size_t *completed;
+    _Alignas(64) _Atomic size_t completed_count;
+    _Alignas(64) size_t read_count;
+
+    // 0 means no limit
+    uint64_t deadline_ns;
+    _Atomic bool is_timed_out;
+
+    uint64_t start_ns;
+    uint64_t end_ns;
+
+    int worker_count;
+    TournamentWorker workers[TOURNAMENT_MAX_THREADS];
+} Tournament;
+
+static inline uint64_t tournament_range(uint64_t const begin, uint64_t const end)
+{
+    return begin << 32 | end;
+}
+
+static bool TournamentWorker_take(TournamentWorker *const this, size_t *const index)
+{
+    uint64_t range = atomic_load_explicit(&this->range, memory_order_relaxed);
+    for (;;)
+    {
+        uint64_t const begin = range >> 32;
+        uint64_t const end = range & 0xFFFFFFFFu;
+        if (begin >= end) return false;
+
+        if (atomic_compare_exchange_weak_explicit(&this->range, &range, tournament_range(begin + 1, end),
+                                                  memory_order_acquire, memory_order_relaxed))
+        {
+            *index = (size_t) begin;
+            return true;
+        }
+    }
+}
+
+static bool TournamentWorker_steal(TournamentWorker *const this, size_t *const index)
+{
+    Tournament *const tournament = this->tournament;
+
+    // see https://en.wikipedia.org/wiki/Xorshift
+    this->random ^= this->random << 13;
+    this->random ^= this->random >> 17;
+    this->random ^= this->random << 5;
+
+    int const first = (int) (this->random % (uint32_t) tournament->worker_count);
+    for (int i = 0; i < tournament->worker_count; ++i)
+    {
+        TournamentWorker *const victim = &tournament->workers[(first + i) % tournament->worker_count];
+        if (victim == this) continue;
+
+        uint64_t range = atomic_load_explicit(&victim->range, memory_order_relaxed);
+        for (;;)
+        {
+            uint64_t const begin = range >> 32;
+            uint64_t const end = range & 0xFFFFFFFFu;
+            if (begin >= end) break;
+
+            // take the back half, this rounds so the last match can be stolen too
+            uint64_t const middle = begin + (end - begin) / 2;
+            if (atomic_compare_exchange_weak_explicit(&victim->range, &range, tournament_range(begin, middle),
+                                                      memory_order_acquire, memory_order_relaxed))
+            {
+                // our own range is empty so no thief can be racing with this store
+                atomic_store_explicit(&this->range, tournament_range(middle + 1, end), memory_order_release);
+                ++this->steal_count;
+
+                *index = (size_t) middle;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void TournamentWorker_play(TournamentWorker *const this, size_t const index)
+{
+    Tournament *const tournament = this->tournament;
+    MatchConfig const *const config = &tournament->configs[index];
+    MatchResult *const result = &tournament->results[index];
+
+    *result = (MatchResult) {.worker = this->index, .status = MATCH_SKIPPED};
+
+    if (!atomic_load_explicit(&tournament->is_timed_out, memory_order_relaxed))
+    {
+        uint64_t const time_start = time_now_ns();
+
+        Game game;
+        Game_setup_match(&game, config->seed, config->aspect_ratio);
+        game.player1_ai_gain = config->player1_ai_gain;
+        game.player2_ai_gain = config->player2_ai_gain;
+
+        int unsigned const score_limit = config->score_limit != 0 ? config->score_limit : UINT_MAX;
+
+        result->status = MATCH_FINISHED;
+        uint64_t tick = 0;
+        while (tick < config->tick_limit)
+        {
+            uint64_t const chunk_end = tick + TOURNAMENT_CHECK_TICKS < config->tick_limit ?
+                tick + TOURNAMENT_CHECK_TICKS : config->tick_limit;
+
+            for (; tick < chunk_end; ++tick)
+            {
+                Game_step_match(&game, config->dt);
+                if (game.player1.score >= score_limit || game.player2.score >= score_limit) break;
+            }
+
+            if (tick < chunk_end)
+            {
+                ++tick;
+                break;
+            }
+
+            if (tournament->deadline_ns != 0 && time_now_ns() >= tournament->deadline_ns)
+            {
+                atomic_store_explicit(&tournament->is_timed_out, true, memory_order_relaxed);
+                result->status = MATCH_TIMED_OUT;
+                break;
+            }
+        }
+
+        result->player1_score = game.player1.score;
+        result->player2_score = game.player2.score;
+        result->tick_count = tick;
+        result->time_ns = time_now_ns() - time_start;
+
+        this->busy_ns += result->time_ns;
+        this->tick_count += tick;
+        ++this->match_count;
+    }
+
+    size_t const slot = atomic_fetch_add_explicit(&tournament->completed_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&tournament->completed[slot], index, memory_order_release);
+}
+
+static void TournamentWorker_run(void *const argument)
+{
+    TournamentWorker *const this = argument;
+
+    size_t index;
+    while (TournamentWorker_take(this, &index) || TournamentWorker_steal(this, &index))
+    {
+        TournamentWorker_play(this, index);
+    }
+}
+
+// configs, results and completed must stay alive until Tournament_finish,
+// a time limit of 0 lets every match run until its own limits
+static void Tournament_start(Tournament *const this, MatchConfig const *const configs,
+                             MatchResult *const results, _Atomic size_t *const completed,
+                             size_t const match_count, int worker_count, uint64_t const time_limit_ns)
+{
+    if (worker_count < 1) worker_count = 1;
+    if (worker_count > TOURNAMENT_MAX_THREADS) worker_count = TOURNAMENT_MAX_THREADS;
+
+    this->configs = configs;
+    this->results = results;
+    this->match_count = match_count;
+    this->completed = completed;
+    atomic_store_explicit(&this->completed_count, 0, memory_order_relaxed);
+    this->read_count = 0;
+    atomic_store_explicit(&this->is_timed_out, false, memory_order_relaxed);
+    this->worker_count = worker_count;
+
+    for (size_t i = 0; i < match_count; ++i)
+    {
+        atomic_store_explicit(&completed[i], TOURNAMENT_NOT_FINISHED, memory_order_relaxed);
+    }
+
+    for (int i = 0; i < worker_count; ++i)
+    {
+        TournamentWorker *const worker = &this->workers[i];
+        worker->tournament = this;
+        worker->index = i;
+        worker->random = (uint32_t) i * 0x9E3779B9u | 1;
+        worker->busy_ns = 0;
+        worker->match_count = 0;
+        worker->tick_count = 0;
+        worker->steal_count = 0;
+
+        uint64_t const begin = match_count * (uint64_t) i / (uint64_t) worker_count;
+        uint64_t const end = match_count * (uint64_t) (i + 1) / (uint64_t) worker_count;
+        atomic_store_explicit(&worker->range, tournament_range(begin, end), memory_order_relaxed);
+    }
+
+    this->start_ns = time_now_ns();
+    this->deadline_ns = time_limit_ns != 0 ? this->start_ns + time_limit_ns : 0;
+
+    for (int i = 0; i < worker_count; ++i)
+    {
+        Thread_create(&this->workers[i].thread, &TournamentWorker_run, &this->workers[i]);
+    }
+}
+
+// waits for the next finished match and returns false once every match has been read
+static bool Tournament_next(Tournament *const this, size_t *const index)
+{
+    if (this->read_count == this->match_count) return false;
+
+    _Atomic size_t *const slot = &this->completed[this->read_count];
+    size_t value;
+    for (int spin = 0; (value = atomic_load_explicit(slot, memory_order_acquire)) == TOURNAMENT_NOT_FINISHED; ++spin)
+    {
+        if (spin < 64)
+        {
+            thread_pause();
+        }
+        else
+        {
+            thread_yield();
+        }
+    }
+
+    ++this->read_count;
+    *index = value;
+    return true;
+}
+
+static void Tournament_finish(Tournament *const this)
+{
+    for (int i = 0; i < this->worker_count; ++i)
+    {
+        Thread_join(&this->workers[i].thread);
+    }
+
+    this->end_ns = time_now_ns();
+}
+
+// fraction of the tournament the worker spent playing matches
+static inline double TournamentWorker_utilization(TournamentWorker const *const this)
+{
+    uint64_t const duration = this->tournament->end_ns - this->tournament->start_ns;
+    return duration != 0 ? (double) this->busy_ns / (double) duration : 0.0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// lock free triple buffer for handing GameSnapshots from one writer thread to one reader thread.
+// the writer always has a slot to write into and the reader always has the newest complete snapshot,
+// neither ever waits for the other, snapshots the reader was too slow for are skipped.
+// see https://remis-thoughts.blogspot.com/2012/01/triple-buffering-as-concurrency_30.html
+
+// set in middle when the slot in it was published after the reader last took one
+#define TRIPLE_BUFFER_NEW (4u)
+
+typedef struct TripleBufferSlot
+{
+    _Alignas(64) GameSnapshot snapshot;
+} TripleBufferSlot;
+
+typedef struct TripleBuffer
+{
+    TripleBufferSlot slots[3];
+
+    // the slot that is passed between writer and reader
+    _Alignas(64) _Atomic uint32_t middle;
+
+    // only the writer touches back and only the reader touches front
+    _Alignas(64) uint32_t back;
+    _Alignas(64) uint32_t front;
+} TripleBuffer;
+
+static inline void TripleBuffer_init(TripleBuffer *const this, GameSnapshot const *const initial)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        this->slots[i].snapshot = *initial;
+    }
+
+    this->back = 0;
+    atomic_store_explicit(&this->middle, 1, memory_order_relaxed);
+    this->front = 2;
+}
+
+// where the writer puts the next snapshot
+static inline GameSnapshot *TripleBuffer_back(TripleBuffer *const this)
+{
+    return &this->slots[this->back].snapshot;
+}
+
+// hands the back slot to the reader and takes whichever slot it was not using as the new back
+static inline void TripleBuffer_publish(TripleBuffer *const this)
+{
+    uint32_t const old_middle = atomic_exchange_explicit(&this->middle, this->back | TRIPLE_BUFFER_NEW,
+                                                         memory_order_acq_rel);
+    this->back = old_middle & ~TRIPLE_BUFFER_NEW;
+}
+
+// takes the newest published snapshot if there is one, returns whether front changed
+static inline bool TripleBuffer_acquire(TripleBuffer *const this)
+{
+    if ((atomic_load_explicit(&this->middle, memory_order_relaxed) & TRIPLE_BUFFER_NEW) == 0) return false;
+
+    uint32_t const old_middle = atomic_exchange_explicit(&this->middle, this->front, memory_order_acq_rel);
+    this->front = old_middle & ~TRIPLE_BUFFER_NEW;
+    return true;
+}
+
+static inline GameSnapshot const *TripleBuffer_front(TripleBuffer const *const this)
+{
+    return &this->slots[this->front].snapshot;
+}
@@ -97,11 +97,93 @@ static inline float fclamp(float value, float min, float max)
     return fminf(fmaxf(value, min), max);
 }
 
+// only for values that fit in an int
+static inline float ffloor(float const value)
+{
+    float const truncated = (float) (int) value;
+    return truncated > value ? truncated - 1.0f : truncated;
+}
+
+// same as hlsl fmod, the result has the sign of a
+static inline float ffmod(float const a, float const b)
+{
+    return a - b * (float) (int) (a / b);
+}
+
+static inline float fsmoothstep(float const min, float const max, float const value)
+{
+    float const t = fclamp((value - min) / (max - min), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// the bits of a float, for passing floats through integer atomics
+static inline uint32_t fbits(float const value)
+{
+    union { float value; uint32_t bits; } const pun = {.value = value};
+    return pun.bits;
+}
+
+static inline float ffrom_bits(uint32_t const bits)
+{
+    union { uint32_t bits; float value; } const pun = {.bits = bits};
+    return pun.value;
+}
+
+// see https://en.wikipedia.org/wiki/Exponential_function#Computation
+static inline float fexp(float const value)
+{
+    // e^x = 2^n * e^r with n = round(x / ln(2)) and |r| <= ln(2) / 2
+    float const clamped = fclamp(value, -87.0f, 88.0f);
+    float const scaled = clamped * 1.44269504f;
+    int const n = (int) (scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+    float const r = clamped - (float) n * 0.693147181f;
+
+    float const e_r = 1.0f + r * (1.0f + r * (1.0f / 2.0f + r * (1.0f / 6.0f + r * (1.0f / 24.0f +
+                      r * (1.0f / 120.0f + r * (1.0f / 720.0f))))));
+
+    union { uint32_t bits; float value; } power = {.bits = (uint32_t) (n + 127) << 23};
+    return e_r * power.value;
+}
+
+static inline float flog(float const value)
+{
+    // ln(x) = e * ln(2) + ln(m) with x = m * 2^e and m in [sqrt(0.5), sqrt(2)),
+    // then ln(m) = 2 * atanh(s) with s = (m - 1) / (m + 1)
+    union { uint32_t bits; float value; } mantissa = {.value = value};
+    int exponent = (int) (mantissa.bits >> 23) - 127;
+    mantissa.bits = (mantissa.bits & 0x007FFFFFu) | 0x3F800000u;
+    if (mantissa.value > 1.41421356f)
+    {
+        mantissa.value *= 0.5f;
+        ++exponent;
+    }
+
+    float const s = (mantissa.value - 1.0f) / (mantissa.value + 1.0f);
+    float const s2 = s * s;
+    float const atanh_s = s * (1.0f + s2 * (1.0f / 3.0f + s2 * (1.0f / 5.0f + s2 * (1.0f / 7.0f + s2 * (1.0f / 9.0f)))));
+    return (float) exponent * 0.693147181f + 2.0f * atanh_s;
+}
+
 static inline float2 fclamp2(float2 const value, float2 const min, float2 const max)
 {
     return (float2){fclamp(value.x, min.x, max.x), fclamp(value.y, min.y, max.y)};
 }
 
+static inline float2 flerp2(float2 const a, float2 const b, float const c)
+{
+    return (float2){flerp(a.x, b.x, c), flerp(a.y, b.y, c)};
+}
+
+typedef struct float3
+{
+    float x, y, z;
+} float3;
+
+static inline float3 flerp3(float3 const a, float3 const b, float const c)
+{
+    return (float3){flerp(a.x, b.x, c), flerp(a.y, b.y, c), flerp(a.z, b.z, c)};
+}
+
 static inline float2 fneg2(float2 const value)
 {
     return (float2){-value.x, -value.y};